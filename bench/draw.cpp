@@ -1,7 +1,10 @@
+#define _USE_MATH_DEFINES
+#include <cmath>
 #include <benchmark/benchmark.h>
 #include <font.h>
 #include <rect.h>
 #include <bitmap.h>
+#include <pixel_format.h>
 #include <sprite.h>
 #include <graphics.h>
 #include <drawable_list.h>
@@ -45,4 +48,47 @@ static void BM_DrawSortLocality(benchmark::State& state) {
 
 BENCHMARK(BM_DrawSortLocality);
 
+constexpr int num_effect_sprites = 32;
+
+enum EffectMode {
+	eZoom,
+	eRotate,
+	eWaver,
+	eRotateSplit
+};
+
+// Draws many animated picture-sized sprites, like a picture heavy game does every frame
+static void BM_DrawEffects(benchmark::State& state) {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	auto dest = Bitmap::Create(320, 240);
+	auto src = Bitmap::Create(64, 64, Color(255, 0, 0, 128));
+	auto rect = src->GetRect();
+	const auto mode = static_cast<EffectMode>(state.range(0));
+	const auto opacity = (mode == eRotateSplit) ? Opacity(255, 128, 16) : Opacity(192);
+
+	int frame = 0;
+	for (auto _: state) {
+		for (int i = 0; i < num_effect_sprites; ++i) {
+			const int x = (i * 37) % 320;
+			const int y = (i * 53) % 240;
+			const double phase = (frame + i) * M_PI / 30.0;
+			switch (mode) {
+				case eZoom:
+					dest->EffectsBlit(x, y, 32, 32, *src, rect, opacity, 1.5, 1.5, 0.0, 0, 0.0);
+					break;
+				case eRotate:
+				case eRotateSplit:
+					dest->EffectsBlit(x, y, 32, 32, *src, rect, opacity, 1.5, 1.5, phase, 0, 0.0);
+					break;
+				case eWaver:
+					dest->EffectsBlit(x, y, 32, 32, *src, rect, opacity, 1.0, 1.0, 0.0, 4, phase);
+					break;
+			}
+		}
+		++frame;
+	}
+}
+
+BENCHMARK(BM_DrawEffects)->Arg(eZoom)->Arg(eRotate)->Arg(eWaver)->Arg(eRotateSplit);
+
 BENCHMARK_MAIN();
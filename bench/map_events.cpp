@@ -0,0 +1,96 @@
+#include <benchmark/benchmark.h>
+#include "game_actors.h"
+#include "game_event.h"
+#include "game_map.h"
+#include "game_party.h"
+#include "game_pictures.h"
+#include "game_player.h"
+#include "game_screen.h"
+#include "game_switches.h"
+#include "game_system.h"
+#include "game_variables.h"
+#include "main_data.h"
+#include "map_data.h"
+#include "output.h"
+#include <lcf/data.h>
+
+constexpr int map_size = 100;
+
+static std::unique_ptr<lcf::rpg::Map> makeMap(int num_events) {
+	auto map = std::make_unique<lcf::rpg::Map>();
+	map->width = map_size;
+	map->height = map_size;
+	map->upper_layer.resize(map_size * map_size, BLOCK_F);
+	map->lower_layer.resize(map_size * map_size, BLOCK_E);
+
+	for (int i = 0; i < num_events; ++i) {
+		map->events.push_back({});
+		auto& ev = map->events.back();
+		ev.ID = i + 1;
+		ev.x = (i * 7) % map_size;
+		ev.y = (i * 13) % map_size;
+		ev.pages.push_back({});
+		ev.pages.back().ID = 1;
+		ev.pages.back().move_type = lcf::rpg::EventPage::MoveType_random;
+		ev.pages.back().move_frequency = 8;
+		ev.pages.back().character_pattern = 1;
+	}
+	return map;
+}
+
+static void setup(int num_events) {
+	Output::SetLogLevel(LogLevel::Error);
+
+	lcf::Data::terrains.resize(1);
+	lcf::Data::chipsets.resize(1);
+	auto& chipset = lcf::Data::chipsets.back();
+	chipset.passable_data_lower.resize(162, 0xF);
+	chipset.passable_data_upper.resize(162, 0xF);
+	chipset.terrain_data.resize(144, 1);
+
+	lcf::Data::treemap = {};
+	lcf::Data::treemap.maps.resize(2);
+	lcf::Data::treemap.maps[0].type = lcf::rpg::TreeMap::MapType_root;
+	lcf::Data::treemap.maps[1].ID = 1;
+	lcf::Data::treemap.maps[1].type = lcf::rpg::TreeMap::MapType_map;
+
+	Main_Data::game_actors = std::make_unique<Game_Actors>();
+	Main_Data::game_party = std::make_unique<Game_Party>();
+	Game_Map::Init();
+	Main_Data::game_system = std::make_unique<Game_System>();
+	Main_Data::game_switches = std::make_unique<Game_Switches>();
+	Main_Data::game_variables = std::make_unique<Game_Variables>(Game_Variables::min_2k3, Game_Variables::max_2k3);
+	Main_Data::game_pictures = std::make_unique<Game_Pictures>();
+	Main_Data::game_screen = std::make_unique<Game_Screen>();
+	Main_Data::game_player = std::make_unique<Game_Player>();
+	Main_Data::game_player->SetMapId(1);
+
+	Game_Map::Setup(makeMap(num_events));
+}
+
+static void BM_UpdateMapEvents(benchmark::State& state) {
+	setup(state.range(0));
+	MapUpdateAsyncContext actx;
+	for (auto _: state) {
+		Game_Map::UpdateProcessedFlags(false);
+		Game_Map::UpdateMapEvents(actx);
+	}
+	Game_Map::Quit();
+}
+
+BENCHMARK(BM_UpdateMapEvents)->Arg(100)->Arg(1000);
+
+static void BM_CheckEvent(benchmark::State& state) {
+	setup(state.range(0));
+	volatile int x = 0;
+	int i = 0;
+	for (auto _: state) {
+		x = Game_Map::CheckEvent(i % map_size, i / map_size);
+		i = (i + 1) % (map_size * map_size);
+	}
+	Game_Map::Quit();
+}
+
+BENCHMARK(BM_CheckEvent)->Arg(100)->Arg(1000);
+
+BENCHMARK_MAIN();
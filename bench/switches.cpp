@@ -64,5 +64,40 @@ static void BM_SwitchFlipRange(benchmark::State& state) {
 
 BENCHMARK(BM_SwitchFlipRange);
 
+static void BM_SwitchSetRangeBank(benchmark::State& state) {
+	const int size = state.range(0);
+	auto s = make(size);
+	bool val = false;
+	for (auto _: state) {
+		// Unaligned bounds to include the partial words
+		s.SetRange(3, size - 5, val);
+		val = !val;
+	}
+}
+
+BENCHMARK(BM_SwitchSetRangeBank)->Arg(1024)->Arg(16384);
+
+static void BM_SwitchFlipRangeBank(benchmark::State& state) {
+	const int size = state.range(0);
+	auto s = make(size);
+	for (auto _: state) {
+		s.FlipRange(3, size - 5);
+	}
+}
+
+BENCHMARK(BM_SwitchFlipRangeBank)->Arg(1024)->Arg(16384);
+
+static void BM_SwitchCountOn(benchmark::State& state) {
+	const int size = state.range(0);
+	auto s = make(size);
+	s.SetRange(size / 4, size / 2, true);
+	volatile int x = 0;
+	for (auto _: state) {
+		x = s.CountOn(1, size);
+	}
+}
+
+BENCHMARK(BM_SwitchCountOn)->Arg(1024)->Arg(16384);
+
 
 BENCHMARK_MAIN();
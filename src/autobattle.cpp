@@ -62,6 +62,8 @@ std::unique_ptr<AlgorithmBase> CreateAlgorithm(StringView name) {
 }
 
 void AlgorithmBase::SetAutoBattleAction(Game_Actor& source) {
+	// Target ranking evaluates the same stats for every skill and target
+	Game_Battler::StatCacheScope stat_cache;
 	vSetAutoBattleAction(source);
 	if (source.GetBattleAlgorithm() == nullptr) {
 		source.SetBattleAlgorithm(std::make_shared<Game_BattleAlgorithm::None>(&source));
@@ -0,0 +1,579 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <ostream>
+#include <fmt/format.h>
+#include <lcf/data.h>
+#include <lcf/reader_util.h>
+#include "system.h"
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(EMSCRIPTEN) && !defined(__ANDROID__) \
+		&& !defined(__SWITCH__) && !defined(_3DS) && !defined(PSP2)
+#  define EP_BATTLE_SIM_FORK
+#  include <cerrno>
+#  include <poll.h>
+#  include <sys/wait.h>
+#  include <unistd.h>
+#endif
+#include "battle_simulator.h"
+#include "autobattle.h"
+#include "enemyai.h"
+#include "game_actor.h"
+#include "game_actors.h"
+#include "game_battle.h"
+#include "game_battlealgorithm.h"
+#include "game_enemy.h"
+#include "game_enemyparty.h"
+#include "game_ineluki.h"
+#include "game_party.h"
+#include "game_pictures.h"
+#include "game_player.h"
+#include "game_quit.h"
+#include "game_screen.h"
+#include "game_switches.h"
+#include "game_system.h"
+#include "game_targets.h"
+#include "game_variables.h"
+#include "main_data.h"
+#include "output.h"
+#include "player.h"
+#include "rand.h"
+
+namespace BattleSimulator {
+	Config config;
+}
+
+namespace {
+
+using BattleSimulator::BattleResult;
+using BattleSimulator::Outcome;
+
+/** Creates the game objects like a new game does */
+void CreateGameObjects() {
+	// Same order as Player::ResetGameObjects
+	Main_Data::game_switches = std::make_unique<Game_Switches>();
+
+	auto min_var = Player::IsRPG2k3() ? Game_Variables::min_2k3 : Game_Variables::min_2k;
+	auto max_var = Player::IsRPG2k3() ? Game_Variables::max_2k3 : Game_Variables::max_2k;
+	Main_Data::game_variables = std::make_unique<Game_Variables>(min_var, max_var);
+
+	Main_Data::game_actors = std::make_unique<Game_Actors>();
+	Main_Data::game_system = std::make_unique<Game_System>();
+	Main_Data::game_enemyparty = std::make_unique<Game_EnemyParty>();
+	Main_Data::game_party = std::make_unique<Game_Party>();
+	Main_Data::game_player = std::make_unique<Game_Player>();
+}
+
+void DestroyGameObjects() {
+	Main_Data::game_player.reset();
+	Main_Data::game_party.reset();
+	Main_Data::game_enemyparty.reset();
+	Main_Data::game_system.reset();
+	Main_Data::game_actors.reset();
+	Main_Data::game_variables.reset();
+	Main_Data::game_switches.reset();
+}
+
+/** Same as Scene_Battle::PrepareBattleAction */
+void PrepareBattleAction(Game_Battler& battler) {
+	if (battler.GetBattleAlgorithm() == nullptr) {
+		return;
+	}
+
+	if (!battler.CanAct()) {
+		if (battler.GetBattleAlgorithm()->GetType() != Game_BattleAlgorithm::Type::None) {
+			battler.SetBattleAlgorithm(std::make_shared<Game_BattleAlgorithm::None>(&battler));
+		}
+		return;
+	}
+
+	const auto restriction = battler.GetSignificantRestriction();
+	if (restriction == lcf::rpg::State::Restriction_attack_ally || restriction == lcf::rpg::State::Restriction_attack_enemy) {
+		const bool own_party = (restriction == lcf::rpg::State::Restriction_attack_ally) == (battler.GetType() == Game_Battler::Type_Ally);
+		Game_Battler* target = own_party
+			? Main_Data::game_party->GetRandomActiveBattler()
+			: Main_Data::game_enemyparty->GetRandomActiveBattler();
+
+		battler.SetBattleAlgorithm(std::make_shared<Game_BattleAlgorithm::Normal>(&battler, target));
+		return;
+	}
+
+	if (!battler.GetBattleAlgorithm()->ActionIsPossible()) {
+		battler.SetBattleAlgorithm(std::make_shared<Game_BattleAlgorithm::None>(&battler));
+	}
+}
+
+/** Actor and enemy action selection of Scene_Battle_Rpg2k with auto battle for every actor */
+void SelectActions(std::vector<Game_Battler*>& actions, AutoBattle::AlgorithmBase& autobattle, EnemyAi::AlgorithmBase& enemyai) {
+	for (auto* actor: Main_Data::game_party->GetActors()) {
+		if (!actor->CanAct()) {
+			actor->SetBattleAlgorithm(std::make_shared<Game_BattleAlgorithm::None>(actor));
+			actions.push_back(actor);
+			continue;
+		}
+
+		Game_Battler* random_target = nullptr;
+		switch (actor->GetSignificantRestriction()) {
+			case lcf::rpg::State::Restriction_attack_ally:
+				random_target = Main_Data::game_party->GetRandomActiveBattler();
+				break;
+			case lcf::rpg::State::Restriction_attack_enemy:
+				random_target = Main_Data::game_enemyparty->GetRandomActiveBattler();
+				break;
+			default:
+				break;
+		}
+
+		if (random_target) {
+			actor->SetBattleAlgorithm(std::make_shared<Game_BattleAlgorithm::Normal>(actor, random_target));
+		} else {
+			autobattle.SetAutoBattleAction(*actor);
+		}
+		actions.push_back(actor);
+	}
+
+	for (auto* enemy: Main_Data::game_enemyparty->GetEnemies()) {
+		if (!EnemyAi::SetStateRestrictedAction(*enemy)) {
+			enemyai.SetEnemyAiAction(*enemy);
+		}
+		actions.push_back(enemy);
+	}
+}
+
+/** Same as Scene_Battle_Rpg2k::CreateExecutionOrder */
+void SortActions(std::vector<Game_Battler*>& actions) {
+	for (auto* battler: actions) {
+		int battle_order = battler->GetAgi() + Rand::GetRandomNumber(0, battler->GetAgi() / 4 + 3);
+		if (battler->GetBattleAlgorithm()->GetType() == Game_BattleAlgorithm::Type::Normal && battler->HasPreemptiveAttack()) {
+			battle_order += 9999;
+		}
+		battler->SetBattleOrderAgi(battle_order);
+	}
+	std::sort(actions.begin(), actions.end(), [](Game_Battler* l, Game_Battler* r) {
+		return l->GetBattleOrderAgi() > r->GetBattleOrderAgi();
+	});
+}
+
+void RecordDamage(BattleResult& result, const Game_Battler& target, int damage) {
+	if (damage <= 0) {
+		return;
+	}
+
+	if (target.GetType() == Game_Battler::Type_Enemy) {
+		result.damage_dealt += damage;
+		++result.hits_dealt;
+		result.max_hit_dealt = std::max(result.max_hit_dealt, damage);
+	} else {
+		result.damage_taken += damage;
+		++result.hits_taken;
+		result.max_hit_taken = std::max(result.max_hit_taken, damage);
+	}
+}
+
+/** The battle action states of Scene_Battle_Rpg2k without messages, waits and animations */
+void ExecuteAction(Game_Battler& battler, BattleResult& result) {
+	PrepareBattleAction(battler);
+	auto action = battler.GetBattleAlgorithm();
+
+	battler.NextBattleTurn();
+	battler.BattleStateHeal();
+	battler.ApplyConditions();
+
+	if (!action || action->GetType() == Game_BattleAlgorithm::Type::None) {
+		return;
+	}
+
+	action->Start();
+	do {
+		action->Execute();
+
+		action->ApplyCustomEffect();
+		action->ApplySwitchEffect();
+
+		auto* target = action->GetTarget();
+		if (action->IsSuccess() && target) {
+			const int hp = target->GetHp();
+			action->ApplyHpEffect();
+			action->ApplySpEffect();
+			action->ApplyAtkEffect();
+			action->ApplyDefEffect();
+			action->ApplySpiEffect();
+			action->ApplyAgiEffect();
+			action->ApplyStateEffects();
+			action->ApplyAttributeShiftEffects();
+			RecordDamage(result, *target, hp - target->GetHp());
+		}
+	} while (action->RepeatNext(true) || action->TargetNext());
+
+	action->ProcessPostActionSwitches();
+}
+
+int Percent(int n, int total) {
+	return total > 0 ? (n * 100 + total / 2) / total : 0;
+}
+
+#ifdef EP_BATTLE_SIM_FORK
+/** Message sent by a worker process for every finished battle */
+struct WorkerMessage {
+	int index;
+	BattleResult result;
+};
+
+bool WriteAll(int fd, const char* data, size_t size) {
+	while (size > 0) {
+		auto n = write(fd, data, size);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		data += n;
+		size -= n;
+	}
+	return true;
+}
+#endif
+
+} // namespace
+
+BattleSimulator::Context::Context() = default;
+
+BattleSimulator::Context::~Context() {
+	if (installed) {
+		Uninstall();
+	}
+}
+
+void BattleSimulator::Context::Install() {
+	assert(!installed);
+	Swap();
+	installed = true;
+}
+
+void BattleSimulator::Context::Uninstall() {
+	assert(installed);
+	Swap();
+	installed = false;
+}
+
+bool BattleSimulator::Context::IsInstalled() const {
+	return installed;
+}
+
+void BattleSimulator::Context::Swap() {
+	using std::swap;
+	swap(game_system, Main_Data::game_system);
+	swap(game_switches, Main_Data::game_switches);
+	swap(game_variables, Main_Data::game_variables);
+	swap(game_screen, Main_Data::game_screen);
+	swap(game_pictures, Main_Data::game_pictures);
+	swap(game_player, Main_Data::game_player);
+	swap(game_actors, Main_Data::game_actors);
+	swap(game_party, Main_Data::game_party);
+	swap(game_enemyparty, Main_Data::game_enemyparty);
+	swap(game_targets, Main_Data::game_targets);
+	swap(game_quit, Main_Data::game_quit);
+	swap(game_ineluki, Main_Data::game_ineluki);
+	swap(battle_running, Game_Battle::battle_running);
+	swap(rng, Rand::GetRNG());
+
+	const auto lock = Rand::GetRandomLocked();
+	if (rng_locked) {
+		Rand::LockRandom(rng_lock_value);
+	} else {
+		Rand::UnlockRandom();
+	}
+	rng_locked = lock.first;
+	rng_lock_value = lock.second;
+}
+
+BattleResult BattleSimulator::RunBattle(int troop_id, uint32_t seed, int max_turns, StringView autobattle_algo, StringView enemyai_algo) {
+	Context context;
+	context.Install();
+
+	// Not SeedRandomNumberGenerator, which logs every seed
+	Rand::GetRNG().seed(seed);
+
+	CreateGameObjects();
+	Main_Data::game_party->SetupBattleTest();
+
+	auto autobattle = AutoBattle::CreateAlgorithm(autobattle_algo);
+	auto enemyai = EnemyAi::CreateAlgorithm(enemyai_algo);
+
+	// Game_Battle::Init without the interpreter and the spriteset
+	Game_Battle::battle_running = true;
+	Main_Data::game_party->ResetTurns();
+	Main_Data::game_enemyparty->ResetBattle(troop_id);
+	Main_Data::game_actors->ResetBattle();
+	for (auto* actor: Main_Data::game_party->GetActors()) {
+		actor->ResetEquipmentStates(true);
+	}
+
+	BattleResult result;
+	std::vector<Game_Battler*> actions;
+	while (true) {
+		if (Game_Battle::CheckLose()) {
+			result.outcome = Outcome::Defeat;
+			break;
+		}
+		if (Game_Battle::CheckWin()) {
+			result.outcome = Outcome::Victory;
+			break;
+		}
+		if (result.turns >= max_turns) {
+			result.outcome = Outcome::Timeout;
+			break;
+		}
+
+		++result.turns;
+		Main_Data::game_party->IncTurns();
+
+		SelectActions(actions, *autobattle, *enemyai);
+		SortActions(actions);
+
+		for (auto* battler: actions) {
+			if (Game_Battle::CheckLose() || Game_Battle::CheckWin()) {
+				break;
+			}
+			if (battler->Exists()) {
+				ExecuteAction(*battler, result);
+			}
+		}
+
+		for (auto* battler: actions) {
+			battler->SetBattleAlgorithm(nullptr);
+		}
+		actions.clear();
+	}
+
+	for (auto* actor: Main_Data::game_party->GetActors()) {
+		result.survivors += !actor->IsDead();
+	}
+
+	Game_Battle::battle_running = false;
+	DestroyGameObjects();
+	context.Uninstall();
+
+	return result;
+}
+
+BattleSimulator::Report BattleSimulator::Run(const Config& cfg, uint32_t seed) {
+	Report report;
+	report.troop_id = cfg.troop_id;
+	report.seed = seed;
+	report.results.resize(std::max(cfg.battles, 0));
+
+	const int battles = static_cast<int>(report.results.size());
+	const auto& autobattle_algo = Player::player_config.autobattle_algo.Get();
+	const auto& enemyai_algo = Player::player_config.enemyai_algo.Get();
+
+	// Created once here so that unknown algorithm names are reported by the main thread
+	AutoBattle::CreateAlgorithm(autobattle_algo);
+	EnemyAi::CreateAlgorithm(enemyai_algo);
+
+	// Only errors are reported while the battles run
+	const auto log_level = Output::GetLogLevel();
+	Output::SetLogLevel(LogLevel::Error);
+
+	auto run = [&](int i) {
+		report.results[i] = RunBattle(cfg.troop_id, seed + static_cast<uint32_t>(i), cfg.max_turns, autobattle_algo, enemyai_algo);
+	};
+
+	std::vector<bool> done(battles, false);
+	int jobs = 1;
+
+#ifdef EP_BATTLE_SIM_FORK
+	jobs = cfg.jobs > 0 ? cfg.jobs : static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+	jobs = std::max(1, std::min(jobs, battles));
+
+	std::vector<pid_t> workers;
+	std::vector<pollfd> pipes;
+	if (jobs > 1) {
+		std::cout.flush();
+		for (int j = 0; j < jobs; ++j) {
+			int fds[2];
+			if (pipe(fds) != 0) {
+				break;
+			}
+			const pid_t pid = fork();
+			if (pid < 0) {
+				close(fds[0]);
+				close(fds[1]);
+				break;
+			}
+			if (pid == 0) {
+				// Worker process: battle j, j + jobs, ... and leave without running exit handlers
+				close(fds[0]);
+				for (int i = j; i < battles; i += jobs) {
+					run(i);
+					const WorkerMessage msg = { i, report.results[i] };
+					if (!WriteAll(fds[1], reinterpret_cast<const char*>(&msg), sizeof(msg))) {
+						_exit(1);
+					}
+				}
+				_exit(0);
+			}
+			close(fds[1]);
+			workers.push_back(pid);
+			pipes.push_back({ fds[0], POLLIN, 0 });
+		}
+	}
+
+	// Collected as they arrive, a full pipe would block its worker
+	std::vector<std::vector<char>> buffers(pipes.size());
+	int open_pipes = static_cast<int>(pipes.size());
+	while (open_pipes > 0) {
+		if (poll(pipes.data(), pipes.size(), -1) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			break;
+		}
+		for (size_t p = 0; p < pipes.size(); ++p) {
+			if (pipes[p].fd < 0 || pipes[p].revents == 0) {
+				continue;
+			}
+			char data[4096];
+			const auto n = read(pipes[p].fd, data, sizeof(data));
+			if (n < 0 && errno == EINTR) {
+				continue;
+			}
+			if (n <= 0) {
+				close(pipes[p].fd);
+				pipes[p].fd = -1;
+				--open_pipes;
+				continue;
+			}
+
+			auto& buf = buffers[p];
+			buf.insert(buf.end(), data, data + n);
+			size_t pos = 0;
+			for (; buf.size() - pos >= sizeof(WorkerMessage); pos += sizeof(WorkerMessage)) {
+				WorkerMessage msg;
+				std::memcpy(&msg, buf.data() + pos, sizeof(msg));
+				if (msg.index >= 0 && msg.index < battles) {
+					report.results[msg.index] = msg.result;
+					done[msg.index] = true;
+				}
+			}
+			buf.erase(buf.begin(), buf.begin() + pos);
+		}
+	}
+	if (open_pipes > 0) {
+		for (auto& p: pipes) {
+			if (p.fd >= 0) {
+				close(p.fd);
+			}
+		}
+	}
+
+	for (auto pid: workers) {
+		while (waitpid(pid, nullptr, 0) < 0 && errno == EINTR) {
+		}
+	}
+
+	jobs = std::max(1, static_cast<int>(workers.size()));
+#endif
+
+	// Battles of workers which could not be started or failed
+	for (int i = 0; i < battles; ++i) {
+		if (!done[i]) {
+			run(i);
+		}
+	}
+	report.jobs = jobs;
+
+	Output::SetLogLevel(log_level);
+
+	return report;
+}
+
+void BattleSimulator::PrintReport(std::ostream& os, const Report& report) {
+	const auto& results = report.results;
+	const int battles = static_cast<int>(results.size());
+
+	const auto* troop = lcf::ReaderUtil::GetElement(lcf::Data::troops, report.troop_id);
+	os << fmt::format("Battle simulation: troop {} ({}), {} battles, seed {}, {} jobs\n",
+			report.troop_id, troop ? StringView(troop->name) : StringView(), battles, report.seed, report.jobs);
+
+	if (battles == 0) {
+		return;
+	}
+
+	int outcomes[3] = {};
+	std::vector<int> turns;
+	int64_t damage_dealt = 0;
+	int64_t damage_taken = 0;
+	int64_t hits_dealt = 0;
+	int64_t hits_taken = 0;
+	int max_hit_dealt = 0;
+	int max_hit_taken = 0;
+	int survivors = 0;
+
+	for (const auto& r: results) {
+		++outcomes[static_cast<int>(r.outcome)];
+		turns.push_back(r.turns);
+		damage_dealt += r.damage_dealt;
+		damage_taken += r.damage_taken;
+		hits_dealt += r.hits_dealt;
+		hits_taken += r.hits_taken;
+		max_hit_dealt = std::max(max_hit_dealt, r.max_hit_dealt);
+		max_hit_taken = std::max(max_hit_taken, r.max_hit_taken);
+		survivors += r.survivors;
+	}
+	std::sort(turns.begin(), turns.end());
+
+	const char* outcome_names[3] = { "Victory", "Defeat", "Timeout" };
+	for (int i = 0; i < 3; ++i) {
+		os << fmt::format("{:<8} {:>7} ({:>3}%)\n", outcome_names[i], outcomes[i], Percent(outcomes[i], battles));
+	}
+
+	int64_t turn_sum = 0;
+	for (auto t: turns) {
+		turn_sum += t;
+	}
+	os << fmt::format("Turns    min {} / avg {:.2f} / median {} / max {}\n",
+			turns.front(), static_cast<double>(turn_sum) / battles, turns[turns.size() / 2], turns.back());
+
+	// Histogram, one line per turn count
+	int most_common = 0;
+	for (auto it = turns.begin(); it != turns.end();) {
+		auto end = std::upper_bound(it, turns.end(), *it);
+		most_common = std::max(most_common, static_cast<int>(end - it));
+		it = end;
+	}
+	for (auto it = turns.begin(); it != turns.end();) {
+		auto end = std::upper_bound(it, turns.end(), *it);
+		const int count = static_cast<int>(end - it);
+		os << fmt::format("  {:>4} {:>7} {}\n", *it, count, std::string((count * 40 + most_common - 1) / most_common, '#'));
+		it = end;
+	}
+
+	auto per = [](int64_t n, int64_t d) {
+		return d > 0 ? static_cast<double>(n) / d : 0.0;
+	};
+	os << fmt::format("Damage dealt  avg {:.1f} per battle / avg {:.1f} per hit / max hit {}\n",
+			per(damage_dealt, battles), per(damage_dealt, hits_dealt), max_hit_dealt);
+	os << fmt::format("Damage taken  avg {:.1f} per battle / avg {:.1f} per hit / max hit {}\n",
+			per(damage_taken, battles), per(damage_taken, hits_taken), max_hit_taken);
+	os << fmt::format("Survivors     avg {:.2f}\n", per(survivors, battles));
+}
@@ -0,0 +1,167 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_BATTLE_SIMULATOR_H
+#define EP_BATTLE_SIMULATOR_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+#include "main_data.h"
+#include "rand.h"
+#include "string_view.h"
+
+/**
+ * Headless battle simulator for balance testing.
+ *
+ * Fights a troop against the battle test party of the database many times,
+ * using the auto battle and enemy AI algorithms for all decisions. No scene,
+ * sprite, animation, message or battle event is involved.
+ *
+ * Every battle runs in its own Context, the game state stays untouched.
+ * Where the platform can fork, battles run in parallel in worker processes,
+ * every process has its own copy of the global game state. Battle i is always
+ * seeded with seed + i, the results do not depend on the number of jobs.
+ */
+namespace BattleSimulator {
+
+struct Config {
+	/** Set by --battle-sim */
+	bool enabled = false;
+	/** Database ID of the troop to fight */
+	int troop_id = 0;
+	/** Number of battles */
+	int battles = 100;
+	/** Number of worker processes, 0 uses one per core */
+	int jobs = 0;
+	/** Battles still running after this many turns are aborted */
+	int max_turns = 100;
+};
+
+extern Config config;
+
+enum class Outcome {
+	Victory,
+	Defeat,
+	/** Aborted after Config::max_turns */
+	Timeout
+};
+
+/** Result of a single battle */
+struct BattleResult {
+	Outcome outcome = Outcome::Timeout;
+	int turns = 0;
+	/** Hp damage dealt by the party */
+	int64_t damage_dealt = 0;
+	/** Hp damage taken by the party */
+	int64_t damage_taken = 0;
+	int hits_dealt = 0;
+	int hits_taken = 0;
+	int max_hit_dealt = 0;
+	int max_hit_taken = 0;
+	/** Party members alive when the battle ended */
+	int survivors = 0;
+};
+
+struct Report {
+	int troop_id = 0;
+	uint32_t seed = 0;
+	int jobs = 0;
+	/** One entry per battle, in battle order */
+	std::vector<BattleResult> results;
+};
+
+/**
+ * Game state of a simulated battle.
+ *
+ * Installing the context swaps the Main_Data game objects, the battle running
+ * flag and the RNG with the ones held by the context, uninstalling swaps them
+ * back. A new context is empty, so while it is installed the battle creates
+ * its own game objects and the state of the running game is kept aside.
+ */
+class Context {
+public:
+	Context();
+	~Context();
+
+	Context(const Context&) = delete;
+	Context& operator=(const Context&) = delete;
+
+	/** Swaps the held state into the globals */
+	void Install();
+
+	/** Swaps the globals back into the context */
+	void Uninstall();
+
+	/** @return whether the context is installed */
+	bool IsInstalled() const;
+
+private:
+	void Swap();
+
+	std::unique_ptr<Game_System> game_system;
+	std::unique_ptr<Game_Switches> game_switches;
+	std::unique_ptr<Game_Variables> game_variables;
+	std::unique_ptr<Game_Screen> game_screen;
+	std::unique_ptr<Game_Pictures> game_pictures;
+	std::unique_ptr<Game_Player> game_player;
+	std::unique_ptr<Game_Actors> game_actors;
+	std::unique_ptr<Game_Party> game_party;
+	std::unique_ptr<Game_EnemyParty> game_enemyparty;
+	std::unique_ptr<Game_Targets> game_targets;
+	std::unique_ptr<Game_Quit> game_quit;
+	std::unique_ptr<Game_Ineluki> game_ineluki;
+	bool battle_running = false;
+	Rand::RNG rng;
+	bool rng_locked = false;
+	int32_t rng_lock_value = 0;
+	bool installed = false;
+};
+
+/**
+ * Simulates a single battle in a new Context.
+ *
+ * @param troop_id database ID of the troop
+ * @param seed RNG seed for this battle
+ * @param max_turns turn limit
+ * @param autobattle_algo name of the auto battle algorithm for the party
+ * @param enemyai_algo name of the enemy AI algorithm
+ * @return battle result
+ */
+BattleResult RunBattle(int troop_id, uint32_t seed, int max_turns, StringView autobattle_algo, StringView enemyai_algo);
+
+/**
+ * Runs all battles of the configuration across worker processes.
+ *
+ * @param cfg simulation parameters
+ * @param seed seed of the first battle
+ * @return all battle results
+ */
+Report Run(const Config& cfg, uint32_t seed);
+
+/**
+ * Writes win rate, turn count distribution and damage statistics.
+ *
+ * @param os stream to write to
+ * @param report simulation results
+ */
+void PrintReport(std::ostream& os, const Report& report);
+
+} // namespace BattleSimulator
+
+#endif
@@ -22,6 +22,7 @@
 #include <cstring>
 #include <algorithm>
 #include <iostream>
+#include <limits>
 #include <unordered_map>
 
 #include "utils.h"
@@ -39,8 +40,82 @@
 #include "output.h"
 #include "util_macro.h"
 #include "bitmap_hslrgb.h"
+#include "pixel_ops.h"
 #include <iostream>
 
+class Bitmap::PNGConverter final : public ImagePNG::RowWriter {
+public:
+	PNGConverter(Bitmap& bmp, bool transparent, bool indexed) :
+		bmp(bmp), transparent(transparent), indexed(indexed) {}
+
+	bool Begin(int w, int h, const uint32_t* palette) override {
+		width = w;
+
+		if (palette && indexed) {
+			// Keep the indices, pixman expands them through the palette when blitting
+			bmp.pixman_format = PIXMAN_c8;
+			bmp.bitmap.reset(pixman_image_create_bits(PIXMAN_c8, w, h, nullptr, 0));
+			if (!bmp.bitmap) {
+				Output::Error("Couldn't create {}x{} image.", w, h);
+			}
+
+			bmp.indexed_palette.reset(new pixman_indexed_t());
+			bmp.indexed_palette->color = true;
+			for (int i = 0; i < 256; ++i) {
+				auto* rgba = reinterpret_cast<const uint8_t*>(&palette[i]);
+				uint8_t r = rgba[0], g = rgba[1], b = rgba[2], a = transparent ? rgba[3] : 0xFF;
+				MultiplyAlpha(r, g, b, a);
+				bmp.indexed_palette->rgba[i] = ((uint32_t)a << 24) | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+			}
+			pixman_image_set_indexed(bmp.bitmap.get(), bmp.indexed_palette.get());
+			return true;
+		}
+
+		bmp.Init(w, h, nullptr);
+
+		if (palette) {
+			// Paletted rows only need one lookup per pixel
+			for (int i = 0; i < 256; ++i) {
+				auto* rgba = reinterpret_cast<const uint8_t*>(&palette[i]);
+				target_palette[i] = Convert(rgba[0], rgba[1], rgba[2], rgba[3]);
+			}
+		}
+		return true;
+	}
+
+	void WriteRow(int y, const uint8_t* rgba) override {
+		uint32_t* dst = PixelOps::Row(bmp, y);
+		for (int x = 0; x < width; ++x, rgba += 4) {
+			dst[x] = Convert(rgba[0], rgba[1], rgba[2], rgba[3]);
+		}
+	}
+
+	void WriteIndexedRow(int y, const uint8_t* indices) override {
+		if (bmp.indexed_palette) {
+			memcpy(static_cast<uint8_t*>(bmp.pixels()) + y * bmp.pitch(), indices, width);
+			return;
+		}
+
+		uint32_t* dst = PixelOps::Row(bmp, y);
+		for (int x = 0; x < width; ++x) {
+			dst[x] = target_palette[indices[x]];
+		}
+	}
+
+private:
+	uint32_t Convert(uint8_t r, uint8_t g, uint8_t b, uint8_t a) const {
+		// Same result as ConvertImage: premultiplied, alpha ignored for opaque bitmaps
+		MultiplyAlpha(r, g, b, a);
+		return bmp.format.rgba_to_uint32_t(r, g, b, transparent ? a : 0xFF);
+	}
+
+	Bitmap& bmp;
+	bool transparent;
+	bool indexed;
+	int width = 0;
+	uint32_t target_palette[256];
+};
+
 BitmapRef Bitmap::Create(int width, int height, const Color& color) {
 	BitmapRef surface = Bitmap::Create(width, height, true);
 	surface->Fill(color);
@@ -115,9 +190,19 @@ Bitmap::Bitmap(const std::string& filename, bool transparent, uint32_t flags) {
 		img_okay = ImageXYZ::ReadXYZ(stream, transparent, w, h, pixels);
 	else if (bytes > 2 && strncmp((char*)data, "BM", 2) == 0)
 		img_okay = ImageBMP::ReadBMP(stream, transparent, w, h, pixels);
-	else if (bytes >= 4 && strncmp((char*)(data + 1), "PNG", 3) == 0)
+	else if (bytes >= 4 && strncmp((char*)(data + 1), "PNG", 3) == 0) {
+		if (format.bytes == 4) {
+			// Decode directly into the bitmap, no intermediate RGBA buffer
+			PNGConverter converter(*this, transparent, (flags & Flag_Indexed) && (flags & Flag_ReadOnly));
+			if (ImagePNG::ReadPNG(stream, transparent, converter)) {
+				CheckPixels(flags);
+			} else {
+				bitmap.reset();
+			}
+			return;
+		}
 		img_okay = ImagePNG::ReadPNG(stream, transparent, w, h, pixels);
-	else
+	} else
 		Output::Warning("Unsupported image file {} (Magic: {:02X})", filename, *reinterpret_cast<uint32_t*>(data));
 
 	if (!img_okay) {
@@ -146,9 +231,19 @@ Bitmap::Bitmap(const uint8_t* data, unsigned bytes, bool transparent, uint32_t f
 		img_okay = ImageXYZ::ReadXYZ(data, bytes, transparent, w, h, pixels);
 	else if (bytes > 2 && strncmp((char*) data, "BM", 2) == 0)
 		img_okay = ImageBMP::ReadBMP(data, bytes, transparent, w, h, pixels);
-	else if (bytes > 4 && strncmp((char*)(data + 1), "PNG", 3) == 0)
+	else if (bytes > 4 && strncmp((char*)(data + 1), "PNG", 3) == 0) {
+		if (format.bytes == 4) {
+			// Decode directly into the bitmap, no intermediate RGBA buffer
+			PNGConverter converter(*this, transparent, (flags & Flag_Indexed) && (flags & Flag_ReadOnly));
+			if (ImagePNG::ReadPNG((const void*) data, transparent, converter)) {
+				CheckPixels(flags);
+			} else {
+				bitmap.reset();
+			}
+			return;
+		}
 		img_okay = ImagePNG::ReadPNG((const void*) data, transparent, w, h, pixels);
-	else
+	} else
 		Output::Warning("Unsupported image (Magic: {:02X})", bytes >= 4 ? *reinterpret_cast<const uint32_t*>(data) : 0);
 
 	if (!img_okay) {
@@ -191,10 +286,18 @@ size_t Bitmap::GetSize() const {
 		return 0;
 	}
 
-	return pitch() * height();
+	size_t size = pitch() * height();
+	if (indexed_palette) {
+		size += sizeof(pixman_indexed_t);
+	}
+	return size;
 }
 
 ImageOpacity Bitmap::ComputeImageOpacity() const {
+	if (indexed_palette) {
+		return ComputeIndexedImageOpacity(GetRect());
+	}
+
 	bool all_opaque = true;
 	bool all_transp = true;
 
@@ -221,6 +324,10 @@ ImageOpacity Bitmap::ComputeImageOpacity(Rect rect) const {
 	const auto full_rect = GetRect();
 	rect = full_rect.GetSubRect(rect);
 
+	if (indexed_palette) {
+		return ComputeIndexedImageOpacity(rect);
+	}
+
 	auto* p = reinterpret_cast<const uint32_t*>(pixels());
 	const int stride = pitch() / sizeof(uint32_t);
 	const auto mask = pixel_format.rgba_to_uint32_t(0, 0, 0, 0xFF);
@@ -241,6 +348,38 @@ ImageOpacity Bitmap::ComputeImageOpacity(Rect rect) const {
 		ImageOpacity::Partial;
 }
 
+ImageOpacity Bitmap::ComputeIndexedImageOpacity(Rect rect) const {
+	bool all_opaque = true;
+	bool all_transp = true;
+
+	// Classify the palette once, then every pixel is a single lookup
+	bool opaque[256];
+	bool transp[256];
+	for (int i = 0; i < 256; ++i) {
+		const uint32_t a = indexed_palette->rgba[i] >> 24;
+		opaque[i] = (a == 0xFF);
+		transp[i] = (a == 0);
+	}
+
+	auto* p = reinterpret_cast<const uint8_t*>(pixels());
+	const int stride = pitch();
+
+	int xend = (rect.x + rect.width);
+	int yend = (rect.y + rect.height);
+	for (int y = rect.y * stride; y < yend * stride; y += stride) {
+		for (int x = rect.x; x < xend; ++x) {
+			auto idx = p[x + y];
+			all_transp &= transp[idx];
+			all_opaque &= opaque[idx];
+		}
+	}
+
+	return
+		all_transp ? ImageOpacity::Transparent :
+		all_opaque ? ImageOpacity::Opaque :
+		ImageOpacity::Partial;
+}
+
 void Bitmap::CheckPixels(uint32_t flags) {
 	if (flags & Flag_System) {
 		DynamicFormat format(32,8,24,8,16,8,8,8,0,PF::Alpha);
@@ -602,8 +741,12 @@ void Bitmap::BlitFast(int x, int y, Bitmap const & src, Rect const & src_rect, O
 
 PixmanImagePtr Bitmap::GetSubimage(Bitmap const& src, const Rect& src_rect) {
 	uint8_t* pixels = (uint8_t*) src.pixels() + src_rect.x * src.bpp() + src_rect.y * src.pitch();
-	return PixmanImagePtr{ pixman_image_create_bits(src.pixman_format, src_rect.width, src_rect.height,
+	auto img = PixmanImagePtr{ pixman_image_create_bits(src.pixman_format, src_rect.width, src_rect.height,
 									(uint32_t*) pixels, src.pitch()) };
+	if (src.indexed_palette) {
+		pixman_image_set_indexed(img.get(), src.indexed_palette.get());
+	}
+	return img;
 }
 
 void Bitmap::TiledBlit(Rect const& src_rect, Bitmap const& src, Rect const& dst_rect, Opacity const& opacity) {
@@ -634,6 +777,112 @@ void Bitmap::TiledBlit(int ox, int oy, Rect const& src_rect, Bitmap const& src,
 							 dst_rect.width, dst_rect.height);
 }
 
+namespace {
+	/**
+	 * Nearest neighbour affine blitter for premultiplied 32 bit bitmaps.
+	 * Samples like pixman with PIXMAN_FILTER_NEAREST and PIXMAN_REPEAT_NONE and
+	 * blends with PIXMAN_OP_OVER, but without creating images, transforms and
+	 * masks on every call.
+	 */
+	class AffineBlitter {
+	public:
+		/**
+		 * @param src source bitmap
+		 * @param bounds readable area, in sample coordinates
+		 * @param origin_x added to sample x to get the bitmap x
+		 * @param origin_y added to sample y to get the bitmap y
+		 * @param inv transform from destination to sample coordinates
+		 * @param opacity opacity, split is relative to the source rect
+		 * @param mask_y sample y of the first source rect row
+		 * @param mask_height height of the source rect
+		 * @param alpha_or forced alpha bits for opaque sources
+		 * @param alpha_shift alpha shift of the pixel format
+		 */
+		AffineBlitter(Bitmap const& src, Rect bounds, int origin_x, int origin_y,
+				pixman_transform_t const& inv, Opacity const& opacity,
+				int mask_y, int mask_height, uint32_t alpha_or, int alpha_shift) :
+			pixels(static_cast<const uint8_t*>(src.pixels())), pitch(src.pitch()),
+			bounds(bounds), origin_x(origin_x), origin_y(origin_y),
+			top(Utils::Clamp(opacity.top, 0, 255)),
+			bottom(Utils::Clamp(opacity.IsSplit() ? opacity.bottom : opacity.top, 0, 255)),
+			split_row(opacity.IsSplit() ? mask_height - opacity.split : std::numeric_limits<int>::max()),
+			mask_y(mask_y), alpha_or(alpha_or), as(alpha_shift)
+		{
+			for (int i = 0; i < 2; ++i) {
+				for (int j = 0; j < 3; ++j) {
+					m[i][j] = inv.matrix[i][j];
+				}
+			}
+		}
+
+		/**
+		 * Draws count pixels into a destination row.
+		 *
+		 * @param dst first destination pixel
+		 * @param count number of pixels
+		 * @param sx untransformed source x of the first pixel
+		 * @param sy untransformed source y of the row
+		 */
+		void DrawRow(uint32_t* dst, int count, int sx, int sy) const {
+			// Sample at the pixel center, 16.16 fixed point like pixman
+			const int64_t cx = (static_cast<int64_t>(sx) << 16) + 0x8000;
+			const int64_t cy = (static_cast<int64_t>(sy) << 16) + 0x8000;
+			int32_t fx = static_cast<int32_t>((m[0][0] * cx + m[0][1] * cy + 0x8000) >> 16) + m[0][2];
+			int32_t fy = static_cast<int32_t>((m[1][0] * cx + m[1][1] * cy + 0x8000) >> 16) + m[1][2];
+			const int32_t ux = m[0][0];
+			const int32_t uy = m[1][0];
+
+			const int x1 = bounds.x + bounds.width;
+			const int y1 = bounds.y + bounds.height;
+
+			for (int i = 0; i < count; ++i, fx += ux, fy += uy) {
+				// Subtracting pixman_fixed_e rounds pixel borders down like pixman
+				const int px = (fx - 1) >> 16;
+				const int py = (fy - 1) >> 16;
+				if (px < bounds.x || px >= x1 || py < bounds.y || py >= y1) {
+					continue;
+				}
+
+				uint32_t pixel = reinterpret_cast<const uint32_t*>(pixels + (py + origin_y) * pitch)[px + origin_x] | alpha_or;
+
+				const uint32_t opacity = (py - mask_y < split_row) ? top : bottom;
+				if (opacity != 255) {
+					pixel = PixelOps::MulPixel(pixel, opacity);
+				}
+
+				PixelOps::BlendPixel(dst[i], pixel, as);
+			}
+		}
+
+	private:
+		const uint8_t* pixels;
+		int pitch;
+		Rect bounds;
+		int origin_x;
+		int origin_y;
+		int64_t m[2][3];
+		uint32_t top;
+		uint32_t bottom;
+		int split_row;
+		int mask_y;
+		uint32_t alpha_or;
+		int as;
+	};
+} // anonymous namespace
+
+bool Bitmap::HasPixelFormatLayout() const {
+	return format.bits == 32
+		&& format.r.bits == 8 && format.g.bits == 8 && format.b.bits == 8
+		&& format.r.shift == pixel_format.r.shift
+		&& format.g.shift == pixel_format.g.shift
+		&& format.b.shift == pixel_format.b.shift
+		&& !IsIndexed();
+}
+
+bool Bitmap::CanAffineBlit(Bitmap const& src) const {
+	return HasPixelFormatLayout() && src.HasPixelFormatLayout();
+}
+
 void Bitmap::StretchBlit(Bitmap const&  src, Rect const& src_rect, Opacity const& opacity) {
 	StretchBlit(GetRect(), src, src_rect, opacity);
 }
@@ -648,6 +897,25 @@ void Bitmap::StretchBlit(Rect const& dst_rect, Bitmap const& src, Rect const& sr
 
 	Transform xform = Transform::Scale(zoom_x, zoom_y);
 
+	if (CanAffineBlit(src)) {
+		Rect clip = dst_rect;
+		clip.Adjust(GetRect());
+		if (clip.IsEmpty()) {
+			return;
+		}
+
+		const int sx = static_cast<int>(src_rect.x / zoom_x) + clip.x - dst_rect.x;
+		const int sy = static_cast<int>(src_rect.y / zoom_y) + clip.y - dst_rect.y;
+		const uint32_t alpha_or = src.GetTransparent() ? 0 : (0xFFu << pixel_format.a.shift);
+		AffineBlitter blitter(src, src.GetRect(), 0, 0, xform.matrix, opacity,
+				src_rect.y, src_rect.height, alpha_or, pixel_format.a.shift);
+
+		for (int y = 0; y < clip.height; ++y) {
+			blitter.DrawRow(PixelOps::Row(*this, clip.y + y) + clip.x, clip.width, sx, sy + y);
+		}
+		return;
+	}
+
 	pixman_image_set_transform(src.bitmap.get(), &xform.matrix);
 
 	auto mask = CreateMask(opacity, src_rect, &xform);
@@ -669,16 +937,39 @@ void Bitmap::WaverBlit(int x, int y, double zoom_x, double zoom_y, Bitmap const&
 
 	Transform xform = Transform::Scale(1.0 / zoom_x, 1.0 / zoom_y);
 
-	pixman_image_set_transform(src.bitmap.get(), &xform.matrix);
-
-	auto mask = CreateMask(opacity, src_rect, &xform);
-
 	int height = static_cast<int>(std::floor(src_rect.height * zoom_y));
 	int width  = static_cast<int>(std::floor(src_rect.width * zoom_x));
 	const auto xoff = src_rect.x * zoom_x;
 	const auto yoff = src_rect.y * zoom_y;
 	const auto yclip = y < 0 ? -y : 0;
 	const auto yend = std::min(height, this->height() - y);
+
+	if (CanAffineBlit(src)) {
+		const uint32_t alpha_or = src.GetTransparent() ? 0 : (0xFFu << pixel_format.a.shift);
+		AffineBlitter blitter(src, src.GetRect(), 0, 0, xform.matrix, opacity,
+				src_rect.y, src_rect.height, alpha_or, pixel_format.a.shift);
+
+		for (int i = yclip; i < yend; i++) {
+			// Same RPG_RT compatible offset as the pixman path below
+			const double sy = (i - yclip) * (2 * M_PI) / (32.0 * zoom_y);
+			const int offset = 2 * zoom_x * depth * std::sin(phase + sy);
+
+			const int dx = x + offset;
+			const int x0 = std::max(dx, 0);
+			const int x1 = std::min(dx + width, this->width());
+			if (x0 >= x1) {
+				continue;
+			}
+
+			blitter.DrawRow(PixelOps::Row(*this, y + i) + x0, x1 - x0,
+					static_cast<int>(xoff) + x0 - dx, static_cast<int>(yoff) + i);
+		}
+		return;
+	}
+
+	pixman_image_set_transform(src.bitmap.get(), &xform.matrix);
+
+	auto mask = CreateMask(opacity, src_rect, &xform);
 	for (int i = yclip; i < yend; i++) {
 		int dy = y + i;
 		// RPG_RT starts the effect from the top of the screen even if the image is clipped. The result
@@ -820,6 +1111,42 @@ void Bitmap::ToneBlit(int x, int y, Bitmap const& src, Rect const& src_rect, con
 		return;
 	}
 
+	if (src.indexed_palette && &src != this) {
+		// Tone the 256 palette colors instead of every pixel
+		if (!src.toned_palette || src.toned_palette_tone != tone) {
+			if (!src.toned_palette) {
+				src.toned_palette.reset(new pixman_indexed_t());
+			}
+			*src.toned_palette = *src.indexed_palette;
+			src.toned_palette_tone = tone;
+
+			int sat = tone.gray > 128 ? 1024 + (tone.gray - 128) * 16 : tone.gray * 8;
+			bool has_color = (tone.red != 128 || tone.green != 128 || tone.blue != 128);
+			for (auto& px: src.toned_palette->rgba) {
+				if ((px >> 24) == 0)
+					continue;
+
+				// Palette entries are premultiplied a8r8g8b8
+				if (tone.gray != 128)
+					saturation_tone(px, sat, 16, 8, 0, 24);
+				if (has_color)
+					color_tone(px, tone, 16, 8, 0, 24);
+			}
+		}
+
+		auto toned = PixmanImagePtr{ pixman_image_create_bits(PIXMAN_c8, src.width(), src.height(),
+									(uint32_t*) src.pixels(), src.pitch()) };
+		pixman_image_set_indexed(toned.get(), src.toned_palette.get());
+
+		pixman_image_composite32(src.GetOperator(),
+								 toned.get(), nullptr, bitmap.get(),
+								 src_rect.x, src_rect.y,
+								 0, 0,
+								 x, y,
+								 src_rect.width, src_rect.height);
+		return;
+	}
+
 	if (&src != this)
 		pixman_image_composite32(src.GetOperator(),
 		src.bitmap.get(), nullptr, bitmap.get(),
@@ -1092,6 +1419,23 @@ void Bitmap::RotateZoomOpacityBlit(int x, int y, int ox, int oy,
 
 	auto inv = fwd.Inverse();
 
+	if (CanAffineBlit(src)) {
+		// Sample coordinates are relative to src_rect, like the subimage below
+		Rect bounds = src_rect;
+		bounds.Adjust(src.GetRect());
+		bounds.x -= src_rect.x;
+		bounds.y -= src_rect.y;
+
+		const uint32_t alpha_or = src.GetTransparent() ? 0 : (0xFFu << pixel_format.a.shift);
+		AffineBlitter blitter(src, bounds, src_rect.x, src_rect.y, inv.matrix, opacity,
+				0, src_rect.height, alpha_or, pixel_format.a.shift);
+
+		for (int y = dst_rect.y; y < dst_rect.y + dst_rect.height; ++y) {
+			blitter.DrawRow(PixelOps::Row(*this, y) + dst_rect.x, dst_rect.width, dst_rect.x, y);
+		}
+		return;
+	}
+
 	PixmanImagePtr temp;
 	if (src_rect != src.GetRect()) {
 		temp = GetSubimage(src, src_rect);
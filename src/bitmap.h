@@ -21,6 +21,7 @@
 // Headers
 #include <string>
 #include <map>
+#include <memory>
 #include <vector>
 #include <cassert>
 #include <pixman.h>
@@ -148,6 +149,9 @@ public:
 		// Special handling for chipset graphic.
 		// Generates a tile opacity list.
 		Flag_Chipset = 1 << 2,
+		// Paletted images keep their 8 bit indices plus a palette instead of
+		// being expanded to 32 bit. Requires Flag_ReadOnly.
+		Flag_Indexed = 1 << 3,
 		// Bitmap will not be written to. This allows blit optimisations because the
 		// opacity information will not change.
 		Flag_ReadOnly = 1 << 16
@@ -173,6 +177,22 @@ public:
 	 */
 	ImageOpacity GetTileOpacity(int x, int y) const;
 
+	/**
+	 * Gets if the bitmap stores 8 bit palette indices.
+	 * Such a bitmap can only be used as a blit source.
+	 *
+	 * @return whether the bitmap is indexed
+	 */
+	bool IsIndexed() const;
+
+	/**
+	 * Gets if the pixels are 32 bit with the channel layout of pixel_format.
+	 * Only then pixel_format values can be written to pixels() directly.
+	 *
+	 * @return whether the bitmap uses the pixel_format layout
+	 */
+	bool HasPixelFormatLayout() const;
+
 	/**
 	 * Writes PNG converted bitmap to output stream.
 	 *
@@ -535,6 +555,8 @@ public:
 	ImageOpacity ComputeImageOpacity(Rect rect) const;
 
 protected:
+	ImageOpacity ComputeIndexedImageOpacity(Rect rect) const;
+
 	DynamicFormat format;
 
 	ImageOpacity image_opacity = ImageOpacity::Partial;
@@ -545,9 +567,18 @@ protected:
 	PixmanImagePtr bitmap;
 	pixman_format_code_t pixman_format;
 
+	/** Premultiplied palette of an indexed bitmap, index 0 is transparent */
+	std::unique_ptr<pixman_indexed_t> indexed_palette;
+	/** Palette of the last ToneBlit from this indexed bitmap */
+	mutable std::unique_ptr<pixman_indexed_t> toned_palette;
+	mutable Tone toned_palette_tone;
+
 	void Init(int width, int height, void* data, int pitch = 0, bool destroy = true);
 	void ConvertImage(int& width, int& height, void*& pixels, bool transparent);
 
+	/** Converts streamed PNG rows directly into the bitmap memory */
+	class PNGConverter;
+
 	static PixmanImagePtr GetSubimage(Bitmap const& src, const Rect& src_rect);
 	static inline void MultiplyAlpha(uint8_t &r, uint8_t &g, uint8_t &b, const uint8_t &a) {
 		r = (uint8_t)((int)r * a / 0xFF);
@@ -567,6 +598,10 @@ protected:
 	static pixman_format_code_t find_format(const DynamicFormat& format);
 
 	pixman_op_t GetOperator(pixman_image_t* mask = nullptr) const;
+
+	/** @return whether the affine blits can skip pixman for this source */
+	bool CanAffineBlit(Bitmap const& src) const;
+
 	bool read_only = false;
 };
 
@@ -574,6 +609,10 @@ inline ImageOpacity Bitmap::GetImageOpacity() const {
 	return image_opacity;
 }
 
+inline bool Bitmap::IsIndexed() const {
+	return indexed_palette != nullptr;
+}
+
 inline ImageOpacity Bitmap::GetTileOpacity(int x, int y) const {
 	return tile_opacity.Get(x, y);
 }
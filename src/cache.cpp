@@ -20,7 +20,8 @@
 #  pragma warning(disable: 4003)
 #endif
 
-#include <map>
+#include <algorithm>
+#include <unordered_map>
 #include <tuple>
 #include <chrono>
 #include <cassert>
@@ -39,8 +40,17 @@
 using namespace std::chrono_literals;
 
 namespace {
-	std::string MakeHashKey(StringView folder_name, StringView filename, bool transparent) {
-		return ToString(folder_name) + ":" + ToString(filename) + ":" + (transparent ? "T" : " ");
+	/**
+	 * Builds the key in a buffer owned by the caller, allocating at most once.
+	 */
+	void MakeHashKey(std::string& key, StringView folder_name, StringView filename, bool transparent) {
+		key.clear();
+		key.reserve(folder_name.size() + filename.size() + 3);
+		key.append(folder_name.data(), folder_name.size());
+		key.append(1, ':');
+		key.append(filename.data(), filename.size());
+		key.append(1, ':');
+		key.append(1, transparent ? 'T' : ' ');
 	}
 
 	std::string MakeTileHashKey(StringView chipset_name, int id) {
@@ -80,9 +90,196 @@ namespace {
 	using tile_key_type = std::string;
 	std::unordered_map<tile_key_type, std::weak_ptr<Bitmap>> cache_tiles;
 
-	// rect, flip_x, flip_y, tone, blend
-	using effect_key_type = std::tuple<BitmapRef, Rect, bool, bool, Tone, Color>;
-	std::map<effect_key_type, std::weak_ptr<Bitmap>> cache_effects;
+	// src, rect, flip_x, flip_y, tone, blend
+	struct EffectKey {
+		const Bitmap* src;
+		Rect rect;
+		bool flip_x;
+		bool flip_y;
+		Tone tone;
+		Color blend;
+	};
+
+	bool operator==(const EffectKey& l, const EffectKey& r) {
+		return l.src == r.src
+			&& l.rect == r.rect
+			&& l.flip_x == r.flip_x
+			&& l.flip_y == r.flip_y
+			&& l.tone == r.tone
+			&& l.blend == r.blend;
+	}
+
+	struct EffectKeyHash {
+		size_t operator()(const EffectKey& key) const {
+			// FNV-1a over the members
+			uint64_t h = 14695981039346656037ULL;
+			auto mix = [&h](uint64_t v) {
+				h ^= v;
+				h *= 1099511628211ULL;
+			};
+			mix(reinterpret_cast<uintptr_t>(key.src));
+			mix((static_cast<uint64_t>(static_cast<uint16_t>(key.rect.x)) << 48)
+					| (static_cast<uint64_t>(static_cast<uint16_t>(key.rect.y)) << 32)
+					| (static_cast<uint64_t>(static_cast<uint16_t>(key.rect.width)) << 16)
+					| static_cast<uint64_t>(static_cast<uint16_t>(key.rect.height)));
+			mix((static_cast<uint64_t>(static_cast<uint32_t>(key.tone.red)) << 32)
+					| static_cast<uint64_t>(static_cast<uint32_t>(key.tone.green)));
+			mix((static_cast<uint64_t>(static_cast<uint32_t>(key.tone.blue)) << 32)
+					| static_cast<uint64_t>(static_cast<uint32_t>(key.tone.gray)));
+			mix((static_cast<uint64_t>(key.blend.red) << 24)
+					| (static_cast<uint64_t>(key.blend.green) << 16)
+					| (static_cast<uint64_t>(key.blend.blue) << 8)
+					| static_cast<uint64_t>(key.blend.alpha));
+			mix((key.flip_x ? 1 : 0) | (key.flip_y ? 2 : 0));
+			return static_cast<size_t>(h);
+		}
+	};
+
+	/** Bitmap generated from another bitmap */
+	struct DerivedItem {
+		/** Detects reuse of the address of a destroyed source bitmap */
+		std::weak_ptr<Bitmap> source;
+		BitmapRef bitmap;
+		Game_Clock::time_point last_access;
+	};
+
+	/** Memory accounting of a cache of derived bitmaps */
+	struct DerivedCacheInfo {
+		/** Unused items are freed immediately above this size */
+		size_t limit;
+		/** Below the limit unused items are kept this long */
+		Game_Clock::duration keep_time;
+		size_t size = 0;
+		Game_Clock::time_point last_sweep = {};
+	};
+
+	/**
+	 * Frees unused items of a derived bitmap cache.
+	 *
+	 * A sweep walks the whole cache, so it only runs before an insert and at
+	 * most once per frame. Otherwise a cache above its limit where every
+	 * item is in use would be walked on every lookup.
+	 */
+	template <typename Map>
+	void SweepDerivedCache(Map& map, DerivedCacheInfo& info) {
+		auto cur_ticks = Game_Clock::GetFrameTime();
+
+		if (cur_ticks == info.last_sweep) {
+			return;
+		}
+		if (info.size <= info.limit && cur_ticks - info.last_sweep < 1s) {
+			return;
+		}
+
+		for (auto it = map.begin(); it != map.end();) {
+			auto& item = it->second;
+
+			if (!item.source.expired() && item.bitmap.use_count() != 1) {
+				// Bitmap is used by a sprite or window
+				++it;
+				continue;
+			}
+
+			if (!item.source.expired() && info.size <= info.limit && cur_ticks - item.last_access < info.keep_time) {
+				// Below memory limit and accessed recently, likely needed again soon
+				++it;
+				continue;
+			}
+
+			info.size -= item.bitmap->GetSize();
+
+			it = map.erase(it);
+		}
+
+		info.last_sweep = cur_ticks;
+	}
+
+	std::unordered_map<EffectKey, DerivedItem, EffectKeyHash> cache_effects;
+
+	// Flash and tone animations create a variant per frame. 8 MiB hold about
+	// a second of flashing for a battle with several large monsters.
+	DerivedCacheInfo effect_cache_info { 8 * 1024 * 1024, 1s };
+	Cache::EffectCacheStats effect_cache_stats;
+
+	struct WindowKey {
+		const Bitmap* skin;
+		Cache::WindowPart part;
+		int width;
+		int height;
+
+		bool operator==(const WindowKey& o) const {
+			return skin == o.skin && part == o.part && width == o.width && height == o.height;
+		}
+	};
+
+	struct WindowKeyHash {
+		size_t operator()(const WindowKey& key) const {
+			size_t h = std::hash<const Bitmap*>()(key.skin);
+			h = h * 31 + static_cast<size_t>(key.part);
+			h = h * 31 + static_cast<size_t>(key.width);
+			h = h * 31 + static_cast<size_t>(key.height);
+			return h;
+		}
+	};
+
+	std::unordered_map<WindowKey, DerivedItem, WindowKeyHash> cache_windows;
+
+	// A full screen window background is 300 KiB, 4 MiB cover the windows of
+	// the busiest menu scenes. Parts are kept 3s for windows opened again soon.
+	DerivedCacheInfo window_cache_info { 4 * 1024 * 1024, 3s };
+
+	BitmapRef RenderWindowPart(const Bitmap& skin, Cache::WindowPart part, int width, int height) {
+		using Part = Cache::WindowPart;
+
+		BitmapRef bitmap;
+		Rect src_rect, dst_rect;
+
+		switch (part) {
+			case Part::BackgroundStretch:
+				bitmap = Bitmap::Create(width, height, false);
+				bitmap->StretchBlit(skin, Rect(0, 0, 32, 32), 255);
+				break;
+			case Part::BackgroundTiled:
+				bitmap = Bitmap::Create(width, height, false);
+				bitmap->TiledBlit(Rect(0, 0, 32, 32), skin, bitmap->GetRect(), 255);
+				break;
+			case Part::FrameUp:
+			case Part::FrameDown:
+				{
+					const int sy = (part == Part::FrameUp) ? 0 : 32 - 8;
+
+					bitmap = Bitmap::Create(width, 8);
+					bitmap->Clear();
+
+					// Border
+					src_rect = { 32 + 8, sy, 16, 8 };
+					dst_rect = { 8, 0, std::max(width - 16, 1), 8 };
+					bitmap->TiledBlit(8, 0, src_rect, skin, dst_rect, 255);
+
+					// Left corner
+					bitmap->Blit(0, 0, skin, Rect(32, sy, 8, 8), 255);
+
+					// Right corner
+					bitmap->Blit(width - 8, 0, skin, Rect(64 - 8, sy, 8, 8), 255);
+				}
+				break;
+			case Part::FrameLeft:
+			case Part::FrameRight:
+				{
+					const int sx = (part == Part::FrameLeft) ? 32 : 64 - 8;
+
+					bitmap = Bitmap::Create(8, height - 16);
+					bitmap->Clear();
+
+					src_rect = { sx, 8, 8, 16 };
+					dst_rect = { 0, 0, 8, height - 16 };
+					bitmap->TiledBlit(0, 8, src_rect, skin, dst_rect, 255);
+				}
+				break;
+		}
+
+		return bitmap;
+	}
 
 	std::string system_name;
 
@@ -134,7 +331,8 @@ namespace {
 
 	BitmapRef LoadBitmap(StringView folder_name, StringView filename,
 						 bool transparent, const uint32_t flags) {
-		const auto key = MakeHashKey(folder_name, filename, transparent);
+		std::string key;
+		MakeHashKey(key, folder_name, filename, transparent);
 
 		auto it = cache.find(key);
 
@@ -255,7 +453,8 @@ namespace {
 
 		const Spec& s = spec[T];
 
-		const auto key = MakeHashKey(folder_name, filename, transparent);
+		std::string key;
+		MakeHashKey(key, folder_name, filename, transparent);
 
 		auto it = cache.find(key);
 
@@ -290,7 +489,8 @@ namespace {
 #endif
 
 		BitmapRef ret = LoadBitmap(s.directory, f, transparent, Bitmap::Flag_ReadOnly | (
-										 T == Material::Chipset? Bitmap::Flag_Chipset:
+										 T == Material::Chipset? Bitmap::Flag_Chipset | Bitmap::Flag_Indexed:
+										 T == Material::Charset? Bitmap::Flag_Indexed:
 										 T == Material::System? Bitmap::Flag_System:
 										 0));
 
@@ -397,7 +597,8 @@ BitmapRef Cache::System(StringView file) {
 }
 
 BitmapRef Cache::Exfont() {
-	const auto key = MakeHashKey("ExFont", "ExFont", false);
+	std::string key;
+	MakeHashKey(key, "ExFont", "ExFont", false);
 
 	auto it = cache.find(key);
 
@@ -454,8 +655,8 @@ BitmapRef Cache::Tile(StringView filename, int tile_id) {
 }
 
 BitmapRef Cache::SpriteEffect(const BitmapRef& src_bitmap, const Rect& rect, bool flip_x, bool flip_y, const Tone& tone, const Color& blend) {
-	const effect_key_type key {
-		src_bitmap,
+	const EffectKey key {
+		src_bitmap.get(),
 		rect,
 		flip_x,
 		flip_y,
@@ -463,48 +664,118 @@ BitmapRef Cache::SpriteEffect(const BitmapRef& src_bitmap, const Rect& rect, boo
 		blend
 	};
 
+	auto cur_ticks = Game_Clock::GetFrameTime();
+
 	const auto it = cache_effects.find(key);
 
-	if (it == cache_effects.end() || it->second.expired()) {
+	if (it == cache_effects.end() || it->second.source.expired()) {
+		++effect_cache_stats.misses;
+
+		SweepDerivedCache(cache_effects, effect_cache_info);
+
+#ifdef CACHE_DEBUG
+		Output::Debug("Effect cache: {} entries, {} KiB, {} hits, {} misses",
+			cache_effects.size(), effect_cache_info.size / 1024.0, effect_cache_stats.hits, effect_cache_stats.misses);
+#endif
+
 		BitmapRef bitmap_effects;
 
 		auto create = [&rect] () -> BitmapRef {
 			return Bitmap::Create(rect.width, rect.height, true);
 		};
 
-		if (tone != Tone()) {
+		const bool has_color = tone != Tone() || blend != Color();
+
+		if ((flip_x || flip_y) && has_color) {
+			// Mirror the cached unflipped variant instead of toning again
+			auto base = SpriteEffect(src_bitmap, rect, false, false, tone, blend);
+			bitmap_effects = create();
+			bitmap_effects->FlipBlit(0, 0, *base, base->GetRect(), flip_x, flip_y, Opacity::Opaque());
+		} else if (blend != Color() && tone != Tone()) {
+			// A changing flash only blends the cached toned variant
+			auto base = SpriteEffect(src_bitmap, rect, false, false, tone, Color());
+			bitmap_effects = create();
+			bitmap_effects->BlendBlit(0, 0, *base, base->GetRect(), blend, Opacity::Opaque());
+		} else if (blend != Color()) {
+			bitmap_effects = create();
+			bitmap_effects->BlendBlit(0, 0, *src_bitmap, rect, blend, Opacity::Opaque());
+		} else if (tone != Tone()) {
 			bitmap_effects = create();
 			bitmap_effects->ToneBlit(0, 0, *src_bitmap, rect, tone, Opacity::Opaque());
+		} else if (flip_x || flip_y) {
+			bitmap_effects = create();
+			bitmap_effects->FlipBlit(rect.x, rect.y, *src_bitmap, rect, flip_x, flip_y, Opacity::Opaque());
 		}
 
-		if (blend != Color()) {
-			if (bitmap_effects) {
-				// Tone blit was applied
-				bitmap_effects->BlendBlit(0, 0, *bitmap_effects, bitmap_effects->GetRect(), blend, Opacity::Opaque());
-			} else {
-				bitmap_effects = create();
-				bitmap_effects->BlendBlit(0, 0, *src_bitmap, rect, blend, Opacity::Opaque());
-			}
-		}
+		assert(bitmap_effects && "Effect cache used but no effect applied!");
 
-		if (flip_x || flip_y) {
-			if (bitmap_effects) {
-				// Tone or blend blit was applied
-				bitmap_effects->Flip(flip_x, flip_y);
-			} else {
-				bitmap_effects = create();
-				bitmap_effects->FlipBlit(rect.x, rect.y, *src_bitmap, rect, flip_x, flip_y, Opacity::Opaque());
-			}
+		// Building a variant on top of a base variant can modify the cache
+		const auto old = cache_effects.find(key);
+		if (old != cache_effects.end()) {
+			// Stale entry of a destroyed source bitmap at the same address
+			effect_cache_info.size -= old->second.bitmap->GetSize();
 		}
+		effect_cache_info.size += bitmap_effects->GetSize();
 
-		assert(bitmap_effects && "Effect cache used but no effect applied!");
+		return (cache_effects[key] = { src_bitmap, bitmap_effects, cur_ticks }).bitmap;
+	} else {
+		++effect_cache_stats.hits;
+		it->second.last_access = cur_ticks;
+		return it->second.bitmap;
+	}
+}
 
-		return(cache_effects[key] = bitmap_effects).lock();
-	} else { return it->second.lock(); }
+BitmapRef Cache::WindowSkinPart(const BitmapRef& skin, WindowPart part, int width, int height) {
+	// The frame strips only depend on one dimension and are shared by more windows
+	if (part == WindowPart::FrameUp || part == WindowPart::FrameDown) {
+		height = 0;
+	} else if (part == WindowPart::FrameLeft || part == WindowPart::FrameRight) {
+		width = 0;
+	}
+
+	const WindowKey key { skin.get(), part, width, height };
+
+	auto cur_ticks = Game_Clock::GetFrameTime();
+
+	const auto it = cache_windows.find(key);
+	if (it != cache_windows.end() && !it->second.source.expired()) {
+		it->second.last_access = cur_ticks;
+		return it->second.bitmap;
+	}
+
+	SweepDerivedCache(cache_windows, window_cache_info);
+
+	// The sweep may have removed a stale entry of a destroyed skin at the same address
+	const auto old = cache_windows.find(key);
+	if (old != cache_windows.end()) {
+		window_cache_info.size -= old->second.bitmap->GetSize();
+	}
+
+	auto bitmap = RenderWindowPart(*skin, part, width, height);
+	window_cache_info.size += bitmap->GetSize();
+
+	return (cache_windows[key] = { skin, bitmap, cur_ticks }).bitmap;
+}
+
+size_t Cache::GetNumWindowSkinParts() {
+	return cache_windows.size();
+}
+
+Cache::EffectCacheStats Cache::GetEffectCacheStats() {
+	auto stats = effect_cache_stats;
+	stats.entries = cache_effects.size();
+	stats.bytes = effect_cache_info.size;
+	return stats;
 }
 
 void Cache::Clear() {
 	cache_effects.clear();
+	effect_cache_info.size = 0;
+	effect_cache_info.last_sweep = {};
+	effect_cache_stats = {};
+	cache_windows.clear();
+	window_cache_info.size = 0;
+	window_cache_info.last_sweep = {};
 	cache.clear();
 	cache_size = 0;
 
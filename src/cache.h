@@ -57,6 +57,52 @@ namespace Cache {
 	BitmapRef Tile(StringView filename, int tile_id);
 	BitmapRef SpriteEffect(const BitmapRef& src_bitmap, const Rect& rect, bool flip_x, bool flip_y, const Tone& tone, const Color& blend);
 
+	/** Usage counters of the sprite effect cache */
+	struct EffectCacheStats {
+		/** Lookups answered from the cache */
+		int hits = 0;
+		/** Lookups which created a new effect bitmap */
+		int misses = 0;
+		/** Number of cached effect bitmaps */
+		size_t entries = 0;
+		/** Memory used by the cached effect bitmaps */
+		size_t bytes = 0;
+	};
+
+	/** @return usage counters of the sprite effect cache since the last Clear */
+	EffectCacheStats GetEffectCacheStats();
+
+	/** Parts of a window rendered from a window skin */
+	enum class WindowPart {
+		/** Background stretched over the whole window */
+		BackgroundStretch,
+		/** Background tiled over the whole window */
+		BackgroundTiled,
+		/** Upper border including both corners, width x 8 */
+		FrameUp,
+		/** Lower border including both corners, width x 8 */
+		FrameDown,
+		/** Left border without the corners, 8 x (height - 16) */
+		FrameLeft,
+		/** Right border without the corners, 8 x (height - 16) */
+		FrameRight
+	};
+
+	/**
+	 * Renders a part of a window from a window skin.
+	 * The bitmap is shared by all windows of the same skin and size and must not be modified.
+	 *
+	 * @param skin window skin
+	 * @param part part to render
+	 * @param width width of the window
+	 * @param height height of the window
+	 * @return the rendered part
+	 */
+	BitmapRef WindowSkinPart(const BitmapRef& skin, WindowPart part, int width, int height);
+
+	/** @return number of cached window parts */
+	size_t GetNumWindowSkinParts();
+
 	void Clear();
 
 	/** @return the configured system bitmap, or nullptr if there is no system */
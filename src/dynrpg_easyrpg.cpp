@@ -20,6 +20,8 @@
 
 #include "dynrpg_easyrpg.h"
 #include "main_data.h"
+#include "game_character.h"
+#include "game_pathfinder.h"
 #include "game_variables.h"
 #include "utils.h"
 #include "version.h"
@@ -88,10 +90,41 @@ static bool EasyAdd(dyn_arg_list args) {
 	return true;
 }
 
+static bool EasyMoveTo(dyn_arg_list args) {
+	auto func = "easyrpg_move_to";
+	bool okay = false;
+
+	int character_id;
+	int x;
+	int y;
+	std::tie(character_id, x, y) = DynRpg::ParseArgs<int, int, int>(func, args, &okay);
+	if (!okay)
+		return true;
+
+	int max_steps = 0;
+	if (args.size() > 3) {
+		max_steps = std::get<0>(DynRpg::ParseArgs<int>(func, args.subspan(3), &okay));
+		if (!okay)
+			return true;
+	}
+
+	// There is no calling event, "this event" is not supported
+	auto* ch = Game_Character::GetCharacter(character_id, 0);
+	if (!ch) {
+		Output::Warning("{}: Invalid character {}", func, character_id);
+		return true;
+	}
+
+	Game_Pathfinder::MoveTo(*ch, x, y, max_steps);
+
+	return true;
+}
+
 void DynRpg::EasyRpgPlugin::RegisterFunctions() {
 	DynRpg::RegisterFunction("call", EasyCall);
 	DynRpg::RegisterFunction("easyrpg_output", EasyOput);
 	DynRpg::RegisterFunction("easyrpg_add", EasyAdd);
+	DynRpg::RegisterFunction("easyrpg_move_to", EasyMoveTo);
 }
 
 void DynRpg::EasyRpgPlugin::Load(const std::vector<uint8_t>& buffer) {
@@ -68,6 +68,7 @@ std::unique_ptr<AlgorithmBase> CreateAlgorithm(StringView name) {
 }
 
 void AlgorithmBase::SetEnemyAiAction(Game_Enemy& source) {
+	Game_Battler::StatCacheScope stat_cache;
 	vSetEnemyAiAction(source);
 	if (source.GetBattleAlgorithm() == nullptr) {
 		source.SetBattleAlgorithm(std::make_shared<Game_BattleAlgorithm::None>(&source));
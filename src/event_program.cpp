@@ -0,0 +1,178 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "event_program.h"
+
+constexpr int EventProgram::kStall;
+
+namespace {
+	using Cmd = lcf::rpg::EventCommand::Code;
+	using Op = EventProgram::Op;
+	using Instr = EventProgram::Instr;
+	using List = std::vector<lcf::rpg::EventCommand>;
+
+	bool IsCode(const lcf::rpg::EventCommand& com, Cmd code) {
+		return static_cast<Cmd>(com.code) == code;
+	}
+
+	/** Same search as Game_Interpreter::SkipToNextConditional */
+	int FindNextConditional(const List& list, int index, Cmd code1, Cmd code2, int indent) {
+		for (++index; index < static_cast<int>(list.size()); ++index) {
+			const auto& com = list[index];
+			if (com.indent > indent) {
+				continue;
+			}
+			if (IsCode(com, code1) || IsCode(com, code2)) {
+				break;
+			}
+		}
+		return index;
+	}
+
+	/** Same search as Game_Interpreter::CommandJumpToLabel */
+	int FindLabel(const List& list, int label_id) {
+		for (int idx = 0; idx < static_cast<int>(list.size()); ++idx) {
+			const auto& com = list[idx];
+			if (IsCode(com, Cmd::Label) && com.parameters[0] == label_id) {
+				return idx;
+			}
+		}
+		return -1;
+	}
+
+	/** Same search as Game_Interpreter::CommandBreakLoop */
+	int FindBreakTarget(const List& list, int index) {
+		auto pcode = static_cast<Cmd>(list[index].code);
+		for (++index; index < static_cast<int>(list.size()); ++index) {
+			if (pcode == Cmd::EndLoop) {
+				break;
+			}
+			pcode = static_cast<Cmd>(list[index].code);
+		}
+		return index;
+	}
+
+	/** Same search as Game_Interpreter::CommandEndLoop */
+	int FindLoopStart(const List& list, int index) {
+		const int indent = list[index].indent;
+		for (int idx = index; idx >= 0; --idx) {
+			if (list[idx].indent > indent) {
+				continue;
+			}
+			if (list[idx].indent < indent) {
+				return EventProgram::kStall;
+			}
+			if (IsCode(list[idx], Cmd::Loop)) {
+				return idx;
+			}
+		}
+		return -1;
+	}
+
+	Instr LowerCommand(const List& list, int index) {
+		const auto& com = list[index];
+		const auto& p = com.parameters;
+		const int np = static_cast<int>(p.size());
+
+		Instr instr;
+		instr.op = Op::Generic;
+
+		switch (static_cast<Cmd>(com.code)) {
+			case Cmd::ControlSwitches:
+				// Single switch with a constant ID
+				if (np >= 4 && p[0] == 0) {
+					instr.op = p[3] < 2 ? Op::SetSwitch : Op::FlipSwitch;
+					instr.a = p[1];
+					instr.b = p[3] == 0;
+				}
+				break;
+			case Cmd::ControlVars:
+				// Single variable with a constant ID, operand is a constant or a variable
+				if (np >= 6 && p[0] == 0 && p[3] >= 0 && p[3] <= 5 && (p[4] == 0 || p[4] == 1)) {
+					instr.op = p[4] == 0 ? Op::VarOpConst : Op::VarOpVar;
+					instr.a = p[1];
+					instr.b = p[5];
+					instr.c = p[3];
+				}
+				break;
+			case Cmd::Wait:
+				// Timed wait, key waits need the message state
+				if (np == 1 || (np > 1 && p[1] == 0)) {
+					instr.op = Op::Wait;
+					instr.a = p[0];
+				}
+				break;
+			case Cmd::ConditionalBranch:
+				if (np >= 3 && p[0] == 0) {
+					instr.op = Op::BranchSwitch;
+					instr.a = p[1];
+					instr.b = p[2] == 0;
+				} else if (np >= 5 && p[0] == 1 && p[4] >= 0 && p[4] <= 5) {
+					instr.op = p[2] == 0 ? Op::BranchVarConst : Op::BranchVarVar;
+					instr.a = p[1];
+					instr.b = p[3];
+					instr.c = p[4];
+				}
+				if (instr.op != Op::Generic) {
+					instr.target = FindNextConditional(list, index, Cmd::ElseBranch, Cmd::EndBranch, com.indent);
+				}
+				break;
+			case Cmd::ElseBranch:
+				instr.op = Op::Else;
+				instr.target = FindNextConditional(list, index, Cmd::EndBranch, Cmd::EndBranch, com.indent);
+				break;
+			case Cmd::EndBranch:
+			case Cmd::Label:
+			case Cmd::Loop:
+				instr.op = Op::Nop;
+				break;
+			case Cmd::JumpToLabel:
+				if (np >= 1) {
+					instr.op = Op::JumpToLabel;
+					instr.target = FindLabel(list, p[0]);
+				}
+				break;
+			case Cmd::BreakLoop:
+				instr.op = Op::BreakLoop;
+				instr.target = FindBreakTarget(list, index);
+				break;
+			case Cmd::EndLoop:
+				instr.op = Op::EndLoop;
+				instr.target = FindLoopStart(list, index);
+				break;
+			default:
+				break;
+		}
+
+		return instr;
+	}
+}
+
+EventProgram::EventProgram(int size, bool lower)
+	: instrs(size)
+{
+	if (!lower) {
+		for (auto& instr: instrs) {
+			instr.op = Op::Generic;
+		}
+	}
+}
+
+void EventProgram::Lower(const std::vector<lcf::rpg::EventCommand>& commands, int index) {
+	instrs[index] = LowerCommand(commands, index);
+}
@@ -0,0 +1,136 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_EVENT_PROGRAM_H
+#define EP_EVENT_PROGRAM_H
+
+// Headers
+#include <cstdint>
+#include <vector>
+#include <lcf/rpg/eventcommand.h>
+
+/**
+ * Event command list lowered for execution by Game_Interpreter.
+ *
+ * Every event command gets one instruction at the same index. The common
+ * commands (setting a switch, variable operations with a constant or a
+ * variable, waiting and branching on a switch or variable) are decoded
+ * into specialized instructions, and the jump targets of branches, loops and
+ * labels are resolved. All other commands are executed by the regular
+ * command handlers.
+ *
+ * Commands are lowered when they are executed the first time, so only
+ * branches which actually run pay for the jump target search, once per
+ * program instead of every time.
+ *
+ * The event commands themselves are not modified, they are still stored in
+ * the savegame.
+ */
+class EventProgram {
+public:
+	enum class Op : uint8_t {
+		/** Not lowered yet */
+		Unlowered,
+		/** Executed by the command handler */
+		Generic,
+		/** Does nothing: Label, Loop, EndBranch */
+		Nop,
+		/** sw[a] = b */
+		SetSwitch,
+		/** sw[a] = !sw[a] */
+		FlipSwitch,
+		/** var[a] (op c) b */
+		VarOpConst,
+		/** var[a] (op c) var[b] */
+		VarOpVar,
+		/** Wait a tenths of a second */
+		Wait,
+		/** Continue when sw[a] == b, otherwise jump to target */
+		BranchSwitch,
+		/** Continue when var[a] (compare c) b, otherwise jump to target */
+		BranchVarConst,
+		/** Continue when var[a] (compare c) var[b], otherwise jump to target */
+		BranchVarVar,
+		/** Else of a conditional branch, jumps to target when the branch was taken */
+		Else,
+		/** Jump to target when not -1 */
+		JumpToLabel,
+		/** Jump to target */
+		BreakLoop,
+		/** Jump behind target when not -1, stops the interpreter when target is kStall */
+		EndLoop
+	};
+
+	/** EndLoop target when the interpreter stops on the command, emulates RPG_RT */
+	static constexpr int kStall = -2;
+
+	struct Instr {
+		Op op = Op::Unlowered;
+		int32_t a = 0;
+		int32_t b = 0;
+		int32_t c = 0;
+		int32_t target = -1;
+	};
+
+	EventProgram() = default;
+
+	/**
+	 * Creates the program of a list of event commands, nothing is lowered yet.
+	 *
+	 * @param size number of event commands
+	 * @param lower when false every command is executed by the command handlers
+	 */
+	explicit EventProgram(int size, bool lower = true);
+
+	/** @return whether the program has no instructions */
+	bool empty() const;
+
+	/** @return number of instructions, equal to the number of event commands */
+	int size() const;
+
+	/**
+	 * Gets the instruction of a command and lowers it on first use.
+	 *
+	 * @param commands event commands the program was created for
+	 * @param index command index
+	 * @return instruction of the command
+	 */
+	const Instr& Get(const std::vector<lcf::rpg::EventCommand>& commands, int index);
+
+private:
+	void Lower(const std::vector<lcf::rpg::EventCommand>& commands, int index);
+
+	std::vector<Instr> instrs;
+};
+
+inline bool EventProgram::empty() const {
+	return instrs.empty();
+}
+
+inline int EventProgram::size() const {
+	return static_cast<int>(instrs.size());
+}
+
+inline const EventProgram::Instr& EventProgram::Get(const std::vector<lcf::rpg::EventCommand>& commands, int index) {
+	auto& instr = instrs[index];
+	if (instr.op == Op::Unlowered) {
+		Lower(commands, index);
+	}
+	return instr;
+}
+
+#endif
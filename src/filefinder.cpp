@@ -389,6 +389,18 @@ int64_t FileFinder::GetFileSize(StringView file) {
 	return Platform::File(ToString(file)).GetSize();
 }
 
+int64_t FileFinder::GetModificationTime(StringView file) {
+	return Platform::File(ToString(file)).GetModificationTime();
+}
+
+bool FileFinder::Rename(StringView file, StringView new_name) {
+	return Platform::File(ToString(file)).Rename(ToString(new_name));
+}
+
+bool FileFinder::Remove(StringView file) {
+	return Platform::File(ToString(file)).Remove();
+}
+
 bool FileFinder::IsMajorUpdatedTree() {
 	// Find an MP3 music file only when official Harmony.dll exists
 	// in the gamedir or the file doesn't exist because
@@ -270,6 +270,31 @@ namespace FileFinder {
 	 */
 	int64_t GetFileSize(StringView file);
 
+	/**
+	 * Get the time a file was last modified
+	 *
+	 * @param file the path to a file
+	 * @return seconds since the epoch, or -1 on error
+	 */
+	int64_t GetModificationTime(StringView file);
+
+	/**
+	 * Renames a file, replacing the target when it exists.
+	 *
+	 * @param file the path to a file
+	 * @param new_name the new path of the file
+	 * @return true on success
+	 */
+	bool Rename(StringView file, StringView new_name);
+
+	/**
+	 * Deletes a file.
+	 *
+	 * @param file the path to a file
+	 * @return true on success
+	 */
+	bool Remove(StringView file);
+
 	/**
 	 * Known file sizes
 	 */
@@ -24,6 +24,7 @@
 #include "input.h"
 #include "font.h"
 #include "drawable_mgr.h"
+#include "frame_arena.h"
 
 using namespace std::chrono_literals;
 
@@ -40,6 +41,9 @@ FpsOverlay::FpsOverlay() :
 void FpsOverlay::UpdateText() {
 	auto fps = Utils::RoundTo<int>(Game_Clock::GetFPS());
 	text = "FPS: " + std::to_string(fps);
+	if (FrameArena::IsHeapCounterEnabled()) {
+		text += " Alloc: " + std::to_string(FrameArena::GetHeapAllocations());
+	}
 	fps_dirty = true;
 }
 
@@ -0,0 +1,158 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include "frame_arena.h"
+
+#ifdef PLAYER_ALLOCATION_COUNTER
+#  include <atomic>
+#  include <cstdlib>
+#  include <new>
+#endif
+
+namespace {
+	constexpr std::size_t min_block_size = 64 * 1024;
+
+	struct Block {
+		std::unique_ptr<char[]> data;
+		std::size_t size = 0;
+	};
+
+	Block block;
+	std::size_t offset = 0;
+
+	/** Blocks which were filled in the current frame */
+	std::vector<Block> full_blocks;
+	std::size_t full_bytes = 0;
+
+	Block MakeBlock(std::size_t size) {
+		Block b;
+		b.data.reset(new char[size]);
+		b.size = size;
+		return b;
+	}
+
+	/** @return offset of the next aligned address in the current block, or block.size when it does not fit */
+	std::size_t AlignedOffset(std::size_t size, std::size_t align) {
+		if (!block.data) {
+			return block.size;
+		}
+		const auto base = reinterpret_cast<std::uintptr_t>(block.data.get());
+		const auto aligned = ((base + offset + align - 1) & ~static_cast<std::uintptr_t>(align - 1)) - base;
+		if (aligned > block.size || block.size - aligned < size) {
+			return block.size;
+		}
+		return aligned;
+	}
+
+#ifdef PLAYER_ALLOCATION_COUNTER
+	std::atomic<unsigned> heap_allocations(0);
+	unsigned last_heap_allocations = 0;
+#endif
+}
+
+void* FrameArena::Allocate(std::size_t size, std::size_t align) {
+	auto pos = AlignedOffset(size, align);
+	if (pos == block.size) {
+		if (block.data) {
+			full_bytes += offset;
+			full_blocks.push_back(std::move(block));
+		}
+		block = MakeBlock(std::max({ min_block_size, block.size * 2, size + align }));
+		offset = 0;
+		pos = AlignedOffset(size, align);
+	}
+
+	offset = pos + size;
+	return block.data.get() + pos;
+}
+
+void FrameArena::Deallocate(void* ptr, std::size_t size) {
+	auto* p = static_cast<char*>(ptr);
+	if (block.data && p + size == block.data.get() + offset) {
+		offset = p - block.data.get();
+	}
+}
+
+void FrameArena::Reset() {
+	if (!full_blocks.empty()) {
+		// Merge everything into one block, the next frame likely needs as much memory
+		std::size_t size = block.size;
+		for (auto& b: full_blocks) {
+			size += b.size;
+		}
+		full_blocks.clear();
+		full_bytes = 0;
+		block = MakeBlock(size);
+	}
+	offset = 0;
+
+#ifdef PLAYER_ALLOCATION_COUNTER
+	last_heap_allocations = heap_allocations.exchange(0, std::memory_order_relaxed);
+#endif
+}
+
+std::size_t FrameArena::GetUsedBytes() {
+	return full_bytes + offset;
+}
+
+std::size_t FrameArena::GetCapacity() {
+	std::size_t size = block.size;
+	for (auto& b: full_blocks) {
+		size += b.size;
+	}
+	return size;
+}
+
+bool FrameArena::IsHeapCounterEnabled() {
+#ifdef PLAYER_ALLOCATION_COUNTER
+	return true;
+#else
+	return false;
+#endif
+}
+
+unsigned FrameArena::GetHeapAllocations() {
+#ifdef PLAYER_ALLOCATION_COUNTER
+	return last_heap_allocations;
+#else
+	return 0;
+#endif
+}
+
+#ifdef PLAYER_ALLOCATION_COUNTER
+// Replaces the global allocation functions to count every heap allocation.
+// The array and nothrow variants of the standard library forward to these.
+void* operator new(std::size_t size) {
+	heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size > 0 ? size : 1)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+#endif
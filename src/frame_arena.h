@@ -0,0 +1,120 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_FRAME_ARENA_H
+#define EP_FRAME_ARENA_H
+
+// Headers
+#include <cstddef>
+#include <vector>
+
+/**
+ * Bump allocator for temporary data which lives at most until the end of
+ * the current frame.
+ *
+ * Allocating is a pointer increment and freeing does nothing, the whole
+ * arena is released at once by Player::MainLoop after the frame was drawn.
+ * When a frame needs more memory than the arena holds, additional blocks
+ * are allocated and merged into one block on the next reset, so the arena
+ * stops touching the heap after a few frames.
+ *
+ * Only use it from the main thread and never keep pointers into it
+ * across frames.
+ */
+namespace FrameArena {
+
+/**
+ * Allocates memory which is valid until the next Reset.
+ *
+ * @param size number of bytes
+ * @param align alignment of the memory, a power of two
+ * @return pointer to the memory
+ */
+void* Allocate(std::size_t size, std::size_t align = alignof(std::max_align_t));
+
+/**
+ * Gives memory back to the arena. This only has an effect when it was
+ * the latest allocation, which makes growing the last vector cheap.
+ *
+ * @param ptr memory returned by Allocate
+ * @param size number of bytes passed to Allocate
+ */
+void Deallocate(void* ptr, std::size_t size);
+
+/**
+ * Releases all memory allocated in the current frame.
+ * Called once per frame by Player::MainLoop.
+ */
+void Reset();
+
+/** @return bytes allocated since the last Reset */
+std::size_t GetUsedBytes();
+
+/** @return bytes held by the arena */
+std::size_t GetCapacity();
+
+/** @return whether the Player was built with the heap allocation counter */
+bool IsHeapCounterEnabled();
+
+/**
+ * Returns the number of heap allocations made by the whole program in the
+ * previous frame. Always 0 when IsHeapCounterEnabled is false.
+ *
+ * @return heap allocations of the previous frame
+ */
+unsigned GetHeapAllocations();
+
+}
+
+/**
+ * Standard allocator which takes its memory from the FrameArena.
+ * Containers using it must be destroyed before the frame ends.
+ */
+template <typename T>
+class FrameAllocator {
+public:
+	using value_type = T;
+
+	FrameAllocator() noexcept = default;
+
+	template <typename U>
+	FrameAllocator(const FrameAllocator<U>&) noexcept {}
+
+	T* allocate(std::size_t n) {
+		return static_cast<T*>(FrameArena::Allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T* ptr, std::size_t n) noexcept {
+		FrameArena::Deallocate(ptr, n * sizeof(T));
+	}
+};
+
+template <typename T, typename U>
+inline bool operator==(const FrameAllocator<T>&, const FrameAllocator<U>&) noexcept {
+	return true;
+}
+
+template <typename T, typename U>
+inline bool operator!=(const FrameAllocator<T>&, const FrameAllocator<U>&) noexcept {
+	return false;
+}
+
+/** Vector which lives in the FrameArena */
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+#endif
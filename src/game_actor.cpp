@@ -109,6 +109,7 @@ void Game_Actor::SetSaveData(lcf::rpg::SaveActor save) {
 
 	MakeExpList();
 	Fixup();
+	InvalidateStatCache();
 }
 
 lcf::rpg::SaveActor Game_Actor::GetSaveData() const {
@@ -302,6 +303,7 @@ int Game_Actor::SetEquipment(int equip_type, int new_item_id) {
 	}
 
 	data.equipped[equip_type - 1] = (short)new_item_id;
+	InvalidateStatCache();
 
 	AdjustEquipmentStates(old_item, false, false);
 	AdjustEquipmentStates(new_item, true, false);
@@ -716,6 +718,7 @@ void Game_Actor::ChangeExp(int exp, PendingMessage* pm) {
 
 void Game_Actor::SetLevel(int _level) {
 	data.level = Utils::Clamp(_level, 1, GetMaxLevel());
+	InvalidateStatCache();
 	// Ensure current HP/SP remain clamped if new Max HP/SP is less.
 	SetHp(GetHp());
 	SetSp(GetSp());
@@ -1015,6 +1018,7 @@ void Game_Actor::ChangeClass(int new_class_id,
 
 		data.battle_commands = dbActor->battle_commands;
 	}
+	InvalidateStatCache();
 
 	MakeExpList();
 
@@ -1119,21 +1123,25 @@ int Game_Actor::SetSp(int sp) {
 void Game_Actor::SetBaseAtk(int atk) {
 	int new_attack_mod = data.attack_mod + (atk - GetBaseAtk());
 	data.attack_mod = ClampStatMod(new_attack_mod, this);
+	InvalidateStatCache();
 }
 
 void Game_Actor::SetBaseDef(int def) {
 	int new_defense_mod = data.defense_mod + (def - GetBaseDef());
 	data.defense_mod = ClampStatMod(new_defense_mod, this);
+	InvalidateStatCache();
 }
 
 void Game_Actor::SetBaseSpi(int spi) {
 	int new_spirit_mod = data.spirit_mod + (spi - GetBaseSpi());
 	data.spirit_mod = ClampStatMod(new_spirit_mod, this);
+	InvalidateStatCache();
 }
 
 void Game_Actor::SetBaseAgi(int agi) {
 	int new_agility_mod = data.agility_mod + (agi - GetBaseAgi());
 	data.agility_mod = ClampStatMod(new_agility_mod, this);
+	InvalidateStatCache();
 }
 
 Game_Actor::RowType Game_Actor::GetBattleRow() const {
@@ -1261,6 +1269,7 @@ void Game_Actor::RemoveInvalidData() {
 	if (GetStates().size() > lcf::Data::states.size()) {
 		Output::Warning("Actor {}: State array contains invalid states ({} > {})", GetId(), GetStates().size(), lcf::Data::states.size());
 		GetStates().resize(lcf::Data::states.size());
+		InvalidateStatCache();
 	}
 
 	// Remove invalid levels
@@ -135,8 +135,10 @@ bool Game_Battle::CheckWin() {
 bool Game_Battle::CheckLose() {
 	// If there are active characters, but all of them are in a state with Restriction "Do Nothing" and 0% recovery probability (including death), it's game over
 	// Physical recovery doesn't matter in this case
-	for (auto& actor : Main_Data::game_party->GetActors()) {
-		if (!actor->IsHidden() && actor->CanActOrRecoverable()) {
+	auto& party = *Main_Data::game_party;
+	for (int i = 0; i < party.GetBattlerCount(); ++i) {
+		auto& actor = party[i];
+		if (!actor.IsHidden() && actor.CanActOrRecoverable()) {
 			return false;
 		}
 	}
@@ -190,12 +192,13 @@ bool Game_Battle::IsBattleAnimationWaiting() {
 }
 
 void Game_Battle::UpdateAtbGauges() {
-	std::vector<Game_Battler*> battlers;
+	FrameVector<Game_Battler*> battlers;
 	Main_Data::game_enemyparty->GetBattlers(battlers);
 	Main_Data::game_party->GetBattlers(battlers);
 
 	const auto use_2k3e_algo = Player::IsRPG2k3E();
 
+	Game_Battler::StatCacheScope stat_cache;
 	int sum_agi = 0;
 	for (auto* bat: battlers) {
 		// RPG_RT uses dead and state restricted battlers to contribute to the sum.
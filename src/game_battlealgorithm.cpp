@@ -137,6 +137,8 @@ Game_Battler* Game_BattleAlgorithm::AlgorithmBase::GetTarget() const {
 }
 
 bool Game_BattleAlgorithm::AlgorithmBase::Execute() {
+	// Execution only computes the outcome, the battlers are modified later by Apply.
+	Game_Battler::StatCacheScope stat_cache;
 	Reset();
 	return vExecute();
 }
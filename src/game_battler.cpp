@@ -323,6 +323,7 @@ bool Game_Battler::AddState(int state_id, bool allow_battle_states) {
 	if (!was_added) {
 		return was_added;
 	}
+	InvalidateStatCache();
 
 	if (state_id == lcf::rpg::State::kDeathID) {
 		SetAtbGauge(0);
@@ -373,6 +374,7 @@ bool Game_Battler::RemoveState(int state_id, bool always_remove_battle_states) {
 
 	auto was_removed = State::Remove(state_id, GetStates(), ps);
 	if (was_removed) {
+		InvalidateStatCache();
 		if (state_id == lcf::rpg::State::kDeathID) {
 			SetHp(1);
 		}
@@ -438,10 +440,12 @@ int Game_Battler::ApplyConditions() {
 
 void Game_Battler::RemoveBattleStates() {
 	State::RemoveAllBattle(GetStates(), GetPermanentStates());
+	InvalidateStatCache();
 }
 
 void Game_Battler::RemoveAllStates() {
 	State::RemoveAll(GetStates(), GetPermanentStates());
+	InvalidateStatCache();
 }
 
 int Game_Battler::ChangeHp(int hp, bool lethal) {
@@ -526,20 +530,77 @@ int Game_Battler::CalcValueAfterAgiStates(int value) const {
 	return AdjustParam(value, 0, MaxStatBattleValue(), GetInflictedStates(), &lcf::rpg::State::affect_agility);
 }
 
+int Game_Battler::stat_cache_scopes = 0;
+uint32_t Game_Battler::stat_cache_generation = 0;
+
+Game_Battler::StatCacheScope::StatCacheScope() {
+	if (stat_cache_scopes++ == 0) {
+		// 0 marks an invalidated cache
+		if (++stat_cache_generation == 0) {
+			++stat_cache_generation;
+		}
+	}
+}
+
+Game_Battler::StatCacheScope::~StatCacheScope() {
+	--stat_cache_scopes;
+}
+
+template <typename F>
+int Game_Battler::GetCachedStat(StatValues StatCache::*values, Weapon weapon, const char* name, F&& compute) const {
+	const int idx = static_cast<int>(weapon) + 1;
+	if (stat_cache_scopes == 0 || idx < 0 || idx >= static_cast<int>(StatValues().size())) {
+		return compute();
+	}
+
+	constexpr int unset = std::numeric_limits<int>::min();
+	if (stat_cache.generation != stat_cache_generation) {
+		for (auto* v: { &stat_cache.atk, &stat_cache.def, &stat_cache.spi, &stat_cache.agi }) {
+			v->fill(unset);
+		}
+		stat_cache.generation = stat_cache_generation;
+	}
+
+	int& value = (stat_cache.*values)[idx];
+	if (value == unset) {
+		value = compute();
+		return value;
+	}
+
+#ifdef EP_DEBUG_STAT_CACHE
+	const int fresh = compute();
+	if (fresh != value) {
+		Output::Warning("StatCache: {} of {} (weapon {}) is stale: cached {}, actual {}", name, GetName(), static_cast<int>(weapon), value, fresh);
+		value = fresh;
+	}
+#else
+	(void)name;
+#endif
+	return value;
+}
+
 int Game_Battler::GetAtk(Weapon weapon) const {
-	return AdjustParam(GetBaseAtk(weapon), atk_modifier, MaxStatBattleValue(), GetInflictedStates(), &lcf::rpg::State::affect_attack);
+	return GetCachedStat(&StatCache::atk, weapon, "atk", [&]() {
+		return AdjustParam(GetBaseAtk(weapon), atk_modifier, MaxStatBattleValue(), GetInflictedStates(), &lcf::rpg::State::affect_attack);
+	});
 }
 
 int Game_Battler::GetDef(Weapon weapon) const {
-	return AdjustParam(GetBaseDef(weapon), def_modifier, MaxStatBattleValue(), GetInflictedStates(), &lcf::rpg::State::affect_defense);
+	return GetCachedStat(&StatCache::def, weapon, "def", [&]() {
+		return AdjustParam(GetBaseDef(weapon), def_modifier, MaxStatBattleValue(), GetInflictedStates(), &lcf::rpg::State::affect_defense);
+	});
 }
 
 int Game_Battler::GetSpi(Weapon weapon) const {
-	return AdjustParam(GetBaseSpi(weapon), spi_modifier, MaxStatBattleValue(), GetInflictedStates(), &lcf::rpg::State::affect_spirit);
+	return GetCachedStat(&StatCache::spi, weapon, "spi", [&]() {
+		return AdjustParam(GetBaseSpi(weapon), spi_modifier, MaxStatBattleValue(), GetInflictedStates(), &lcf::rpg::State::affect_spirit);
+	});
 }
 
 int Game_Battler::GetAgi(Weapon weapon) const {
-	return AdjustParam(GetBaseAgi(weapon), agi_modifier, MaxStatBattleValue(), GetInflictedStates(), &lcf::rpg::State::affect_agility);
+	return GetCachedStat(&StatCache::agi, weapon, "agi", [&]() {
+		return AdjustParam(GetBaseAgi(weapon), agi_modifier, MaxStatBattleValue(), GetInflictedStates(), &lcf::rpg::State::affect_agility);
+	});
 }
 
 int Game_Battler::GetDisplayX() const {
@@ -582,6 +643,7 @@ std::vector<int16_t> Game_Battler::BattleStateHeal() {
 			}
 		}
 	}
+	InvalidateStatCache();
 
 	return healed_states;
 }
@@ -610,6 +672,7 @@ void Game_Battler::ResetBattle() {
 	def_modifier = 0;
 	spi_modifier = 0;
 	agi_modifier = 0;
+	InvalidateStatCache();
 	frame_counter = Rand::GetRandomNumber(0, 63);
 	battle_combo_command_id = -1;
 	battle_combo_times = 1;
@@ -19,6 +19,8 @@
 #define EP_GAME_BATTLER_H
 
 // Headers
+#include <array>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <limits>
@@ -113,6 +115,7 @@ public:
 	 * inflected states set to at least 1 (this maps to the turn count).
 	 *
 	 * @return vector containing state list
+	 * @note Call InvalidateStatCache after modifying the list.
 	 */
 	virtual const std::vector<int16_t>& GetStates() const = 0;
 	virtual std::vector<int16_t>& GetStates() = 0;
@@ -371,6 +374,33 @@ public:
 	 */
 	int GetAgi(Weapon weapon = Game_Battler::WeaponAll) const;
 
+	/**
+	 * While at least one scope is alive GetAtk(), GetDef(), GetSpi() and
+	 * GetAgi() are memoized per battler and weapon mode.
+	 * Used around battle code which evaluates the same stats many times,
+	 * e.g. AI target ranking and action execution. Each new outermost
+	 * scope starts with empty caches, so database changes between scopes
+	 * are always picked up.
+	 *
+	 * Define EP_DEBUG_STAT_CACHE to verify every cache hit against a
+	 * fresh computation.
+	 */
+	class StatCacheScope {
+	public:
+		StatCacheScope();
+		~StatCacheScope();
+
+		StatCacheScope(const StatCacheScope&) = delete;
+		StatCacheScope& operator=(const StatCacheScope&) = delete;
+	};
+
+	/**
+	 * Discards the memoized battle stats.
+	 * Must be called whenever level, class, equipment, states or
+	 * modifiers of the battler change.
+	 */
+	void InvalidateStatCache();
+
 	/**
 	 * Gets the maximum HP for the current level.
 	 *
@@ -920,8 +950,31 @@ protected:
 		double current_level = 0.0;
 	};
 	FlashData flash;
+
+private:
+	/** Indexed by Weapon + 1 */
+	using StatValues = std::array<int, 4>;
+
+	struct StatCache {
+		uint32_t generation = 0;
+		StatValues atk;
+		StatValues def;
+		StatValues spi;
+		StatValues agi;
+	};
+	mutable StatCache stat_cache;
+
+	static int stat_cache_scopes;
+	static uint32_t stat_cache_generation;
+
+	template <typename F>
+	int GetCachedStat(StatValues StatCache::*values, Weapon weapon, const char* name, F&& compute) const;
 };
 
+inline void Game_Battler::InvalidateStatCache() {
+	stat_cache.generation = 0;
+}
+
 inline Color Game_Battler::GetFlashColor() const {
 	return Flash::MakeColor(flash.red, flash.green, flash.blue, flash.current_level);
 }
@@ -941,18 +994,22 @@ inline bool Game_Battler::Exists() const {
 
 inline void Game_Battler::SetAtkModifier(int modifier) {
 	atk_modifier = modifier;
+	InvalidateStatCache();
 }
 
 inline void Game_Battler::SetDefModifier(int modifier) {
 	def_modifier = modifier;
+	InvalidateStatCache();
 }
 
 inline void Game_Battler::SetSpiModifier(int modifier) {
 	spi_modifier = modifier;
+	InvalidateStatCache();
 }
 
 inline void Game_Battler::SetAgiModifier(int modifier) {
 	agi_modifier = modifier;
+	InvalidateStatCache();
 }
 
 inline bool Game_Battler::IsCharged() const {
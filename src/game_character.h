@@ -754,6 +754,22 @@ public:
 	 */
 	virtual bool IsInPosition(int x, int y) const;
 
+	/** Tile position of a character, see BindPosition() */
+	struct Position {
+		int x = 0;
+		int y = 0;
+	};
+
+	/**
+	 * Binds an external copy of the tile position which SetX() and SetY()
+	 * keep up to date. Game_Map uses this to store the positions of all
+	 * events in one contiguous array, so scans for events on a tile do
+	 * not need to touch the event objects.
+	 *
+	 * @param pos position to keep in sync, nullptr to unbind
+	 */
+	void BindPosition(Position* pos);
+
 	/**
 	 * Gets current opacity of character.
 	 *
@@ -887,6 +903,7 @@ protected:
 
 	Type _type = {};
 	lcf::rpg::SaveMapEventBase* _data = nullptr;
+	Position* _position = nullptr;
 };
 
 template <typename T>
@@ -935,6 +952,9 @@ inline int Game_Character::GetX() const {
 
 inline void Game_Character::SetX(int new_x) {
 	data()->position_x = new_x;
+	if (_position) {
+		_position->x = new_x;
+	}
 }
 
 inline int Game_Character::GetY() const {
@@ -943,6 +963,17 @@ inline int Game_Character::GetY() const {
 
 inline void Game_Character::SetY(int new_y) {
 	data()->position_y = new_y;
+	if (_position) {
+		_position->y = new_y;
+	}
+}
+
+inline void Game_Character::BindPosition(Position* pos) {
+	_position = pos;
+	if (_position) {
+		_position->x = GetX();
+		_position->y = GetY();
+	}
 }
 
 inline int Game_Character::GetMapId() const {
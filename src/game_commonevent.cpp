@@ -89,6 +89,13 @@ std::vector<lcf::rpg::EventCommand>& Game_CommonEvent::GetList() {
 	return lcf::ReaderUtil::GetElement(lcf::Data::commonevents, common_event_id)->event_commands;
 }
 
+std::shared_ptr<EventProgram> Game_CommonEvent::GetProgram() {
+	if (!program) {
+		program = std::make_shared<EventProgram>(static_cast<int>(GetList().size()));
+	}
+	return program;
+}
+
 lcf::rpg::SaveEventExecState Game_CommonEvent::GetSaveData() {
 	lcf::rpg::SaveEventExecState state;
 	if (interpreter) {
@@ -19,6 +19,7 @@
 #define EP_GAME_COMMONEVENT_H
 
 // Headers
+#include <memory>
 #include <string>
 #include <vector>
 #include "game_interpreter_map.h"
@@ -96,6 +97,14 @@ public:
 	 */
 	std::vector<lcf::rpg::EventCommand>& GetList();
 
+	/**
+	 * Returns the lowered commands of the list, shared by every interpreter
+	 * frame executing this common event. Created on first use.
+	 *
+	 * @return program of the list
+	 */
+	std::shared_ptr<EventProgram> GetProgram();
+
 	lcf::rpg::SaveEventExecState GetSaveData();
 
 	/** @return true if waiting for foreground execution */
@@ -112,6 +121,9 @@ private:
 
 	/** Interpreter for parallel common events. */
 	std::unique_ptr<Game_Interpreter_Map> interpreter;
+
+	/** Lowered commands of the list */
+	std::shared_ptr<EventProgram> program;
 };
 
 #endif
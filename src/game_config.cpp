@@ -102,6 +102,14 @@ void Game_Config::LoadFromArgs(CmdlineParser& cp) {
 			video.fps_render_window.Set(false);
 			continue;
 		}
+		if (cp.ParseNext(arg, 0, "--screen-tone-pass")) {
+			video.screen_tone_pass.Set(true);
+			continue;
+		}
+		if (cp.ParseNext(arg, 0, "--no-screen-tone-pass")) {
+			video.screen_tone_pass.Set(false);
+			continue;
+		}
 		if (cp.ParseNext(arg, 0, "--window")) {
 			video.fullscreen.Set(false);
 			continue;
@@ -130,6 +138,22 @@ void Game_Config::LoadFromArgs(CmdlineParser& cp) {
 			}
 			continue;
 		}
+		if (cp.ParseNext(arg, 0, "--save-metadata")) {
+			player.save_metadata.Set(true);
+			continue;
+		}
+		if (cp.ParseNext(arg, 0, "--no-save-metadata")) {
+			player.save_metadata.Set(false);
+			continue;
+		}
+		if (cp.ParseNext(arg, 0, "--translation-cache")) {
+			player.translation_cache.Set(true);
+			continue;
+		}
+		if (cp.ParseNext(arg, 0, "--no-translation-cache")) {
+			player.translation_cache.Set(false);
+			continue;
+		}
 
 		cp.SkipNext();
 	}
@@ -159,6 +183,12 @@ void Game_Config::LoadFromConfig(const std::string& path) {
 	if (ini.HasValue("player", "enemyai-algo")) {
 		player.enemyai_algo.Set(ini.GetString("player", "enemyai-algo", "RPG_RT"));
 	}
+	if (ini.HasValue("player", "save-metadata")) {
+		player.save_metadata.Set(ini.GetBoolean("player", "save-metadata", false));
+	}
+	if (ini.HasValue("player", "translation-cache")) {
+		player.translation_cache.Set(ini.GetBoolean("player", "translation-cache", false));
+	}
 
 	/** VIDEO SECTION */
 
@@ -180,6 +210,9 @@ void Game_Config::LoadFromConfig(const std::string& path) {
 	if (ini.HasValue("video", "window-zoom")) {
 		video.window_zoom.Set(ini.GetInteger("video", "window-zoom", 0));
 	}
+	if (ini.HasValue("video", "screen-tone-pass")) {
+		video.screen_tone_pass.Set(ini.GetBoolean("video", "screen-tone-pass", false));
+	}
 
 	/** AUDIO SECTION */
 
@@ -198,6 +231,8 @@ void Game_Config::WriteToConfig(const std::string& path) const {
 	of << "[player]\n";
 	of << "autobattle-algo=" << player.autobattle_algo.Get() << "\n";
 	of << "enemyai-algo=" << player.enemyai_algo.Get() << "\n";
+	of << "save-metadata=" << int(player.save_metadata.Get()) << "\n";
+	of << "translation-cache=" << int(player.translation_cache.Get()) << "\n";
 	of << "\n";
 
 	/** VIDEO SECTION */
@@ -221,6 +256,9 @@ void Game_Config::WriteToConfig(const std::string& path) const {
 	if (video.window_zoom.Enabled()) {
 		of << "window-zoom=" << video.window_zoom.Get() << "\n";
 	}
+	if (video.screen_tone_pass.Enabled()) {
+		of << "screen-tone-pass=" << int(video.screen_tone_pass.Get()) << "\n";
+	}
 	of << "\n";
 
 	/** AUDIO SECTION */
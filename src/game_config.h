@@ -26,6 +26,8 @@ class CmdlineParser;
 struct Game_ConfigPlayer {
 	StringConfigParam autobattle_algo{ "RPG_RT" };
 	StringConfigParam enemyai_algo{ "RPG_RT" };
+	BoolConfigParam save_metadata{ false };
+	BoolConfigParam translation_cache{ false };
 };
 
 struct Game_ConfigVideo {
@@ -35,6 +37,7 @@ struct Game_ConfigVideo {
 	BoolConfigParam fps_render_window{ false };
 	RangeConfigParam<int> fps_limit{ DEFAULT_FPS, 0, std::numeric_limits<int>::max() };
 	RangeConfigParam<int> window_zoom{ 2, 1, std::numeric_limits<int>::max() };
+	BoolConfigParam screen_tone_pass{ false };
 };
 
 struct Game_ConfigAudio {
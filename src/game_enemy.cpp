@@ -112,6 +112,7 @@ void Game_Enemy::Transform(int new_enemy_id) {
 		static auto dummy = makeDummyEnemy();
 		enemy = &dummy;
 	}
+	InvalidateStatCache();
 
 	auto* sprite = GetEnemyBattleSprite();
 	if (sprite) {
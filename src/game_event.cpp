@@ -637,3 +637,19 @@ const lcf::rpg::EventPage *Game_Event::GetActivePage() const {
 	return page;
 }
 
+std::shared_ptr<EventProgram> Game_Event::GetProgram(const lcf::rpg::EventPage* page) {
+	const auto& pages = event->pages;
+	if (page < pages.data() || page >= pages.data() + pages.size()) {
+		return nullptr;
+	}
+
+	if (page_programs.empty()) {
+		page_programs.resize(pages.size());
+	}
+	auto& program = page_programs[page - pages.data()];
+	if (!program) {
+		program = std::make_shared<EventProgram>(static_cast<int>(page->event_commands.size()));
+	}
+	return program;
+}
+
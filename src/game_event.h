@@ -19,6 +19,7 @@
 #define EP_GAME_EVENT_H
 
 // Headers
+#include <memory>
 #include <string>
 #include <vector>
 #include "game_character.h"
@@ -159,6 +160,15 @@ public:
 	/** @returns the number of pages this event has */
 	int GetNumPages() const;
 
+	/**
+	 * Returns the lowered commands of a page, shared by every interpreter
+	 * frame executing the page. Created on first use.
+	 *
+	 * @param page page of this event
+	 * @return program of the page or nullptr if page is not a page of this event
+	 */
+	std::shared_ptr<EventProgram> GetProgram(const lcf::rpg::EventPage* page);
+
 protected:
 	/** Check for and fix incorrect data after loading save game */
 	void SanitizeData();
@@ -211,6 +221,8 @@ private:
 	const lcf::rpg::Event* event = nullptr;
 	const lcf::rpg::EventPage* page = nullptr;
 	std::unique_ptr<Game_Interpreter_Map> interpreter;
+	/** Lowered commands of each page, indexed like event->pages */
+	std::vector<std::shared_ptr<EventProgram>> page_programs;
 };
 
 inline int Game_Event::GetNumPages() const {
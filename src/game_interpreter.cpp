@@ -23,6 +23,7 @@
 #include <cassert>
 #include "game_interpreter.h"
 #include "audio.h"
+#include "compiler.h"
 #include "dynrpg.h"
 #include "filefinder.h"
 #include "game_map.h"
@@ -38,6 +39,7 @@
 #include "game_system.h"
 #include "game_message.h"
 #include "game_pictures.h"
+#include "interpreter_profiler.h"
 #include "game_screen.h"
 #include "spriteset_map.h"
 #include "sprite_character.h"
@@ -62,6 +64,57 @@ enum BranchSubcommand {
 	eOptionBranchElse = 1
 };
 
+namespace {
+	/** Operations of ControlVariables on a single variable */
+	void OperateVariable(int var_id, int operation, int value) {
+		switch (operation) {
+			case 0:
+				Main_Data::game_variables->Set(var_id, value);
+				break;
+			case 1:
+				Main_Data::game_variables->Add(var_id, value);
+				break;
+			case 2:
+				Main_Data::game_variables->Sub(var_id, value);
+				break;
+			case 3:
+				Main_Data::game_variables->Mult(var_id, value);
+				break;
+			case 4:
+				Main_Data::game_variables->Div(var_id, value);
+				break;
+			case 5:
+				Main_Data::game_variables->Mod(var_id, value);
+				break;
+		}
+	}
+
+	/** Comparisons of the ConditionalBranch variable condition */
+	bool CompareValues(int value1, int value2, int comparison) {
+		switch (comparison) {
+			case 0:
+				// Equal to
+				return value1 == value2;
+			case 1:
+				// Greater than or equal
+				return value1 >= value2;
+			case 2:
+				// Less than or equal
+				return value1 <= value2;
+			case 3:
+				// Greater than
+				return value1 > value2;
+			case 4:
+				// Less than
+				return value1 < value2;
+			case 5:
+				// Different
+				return value1 != value2;
+		}
+		return false;
+	}
+}
+
 constexpr int Game_Interpreter::loop_limit;
 constexpr int Game_Interpreter::call_stack_limit;
 constexpr int Game_Interpreter::subcommand_sentinel;
@@ -78,6 +131,8 @@ Game_Interpreter::~Game_Interpreter() {
 // Clear.
 void Game_Interpreter::Clear() {
 	_state = {};
+	_programs.clear();
+	_frame_owners.clear();
 	_keyinput = {};
 	_async_op = {};
 }
@@ -91,7 +146,9 @@ bool Game_Interpreter::IsRunning() const {
 void Game_Interpreter::Push(
 	const std::vector<lcf::rpg::EventCommand>& _list,
 	int event_id,
-	bool started_by_decision_key
+	bool started_by_decision_key,
+	InterpreterProfiler::Owner owner,
+	std::shared_ptr<EventProgram> program
 ) {
 	if (_list.empty()) {
 		return;
@@ -114,6 +171,14 @@ void Game_Interpreter::Push(
 		Main_Data::game_player->SetEncounterCalling(false);
 	}
 
+	// Drop programs of frames that were replaced without OnFinishStackFrame
+	_programs.resize(_state.stack.size());
+	_programs.push_back(std::move(program));
+	if (EP_UNLIKELY(InterpreterProfiler::IsEnabled())) {
+		_frame_owners.resize(_state.stack.size());
+		_frame_owners.push_back(owner);
+	}
+
 	_state.stack.push_back(std::move(frame));
 }
 
@@ -404,7 +469,20 @@ void Game_Interpreter::Update(bool reset_loop_count) {
 		int current_frame_idx = _state.stack.size() - 1;
 
 		const int index_before_exec = frame->current_command;
-		if (!ExecuteCommand()) {
+		const auto& instr = GetProgram(current_frame_idx).Get(frame->commands, index_before_exec);
+		if (EP_UNLIKELY(InterpreterProfiler::IsEnabled())) {
+			// The command can modify the stack, so take everything we need first
+			const int event_id = GetOriginalEventId();
+			const auto owner = current_frame_idx < static_cast<int>(_frame_owners.size())
+				? _frame_owners[current_frame_idx] : InterpreterProfiler::Owner();
+			const int code = static_cast<int>(frame->commands[index_before_exec].code);
+			const auto start = Game_Clock::now();
+			const bool success = ExecuteInstruction(instr, frame->commands[index_before_exec]);
+			InterpreterProfiler::Record(event_id, owner, current_frame_idx, index_before_exec, code, Game_Clock::now() - start);
+			if (!success) {
+				break;
+			}
+		} else if (!ExecuteInstruction(instr, frame->commands[index_before_exec])) {
 			break;
 		}
 
@@ -443,15 +521,22 @@ void Game_Interpreter::Update(bool reset_loop_count) {
 
 // Setup Starting Event
 void Game_Interpreter::Push(Game_Event* ev) {
-	Push(ev->GetList(), ev->GetId(), ev->WasStartedByDecisionKey());
+	const auto* page = ev->GetActivePage();
+	InterpreterProfiler::Owner owner;
+	if (EP_UNLIKELY(InterpreterProfiler::IsEnabled())) {
+		owner = { InterpreterProfiler::Source::MapEvent, ev->GetId(), page ? page->ID : 0 };
+	}
+	Push(ev->GetList(), ev->GetId(), ev->WasStartedByDecisionKey(), owner,
+			page ? ev->GetProgram(page) : nullptr);
 }
 
 void Game_Interpreter::Push(Game_Event* ev, const lcf::rpg::EventPage* page, bool triggered_by_decision_key) {
-	Push(page->event_commands, ev->GetId(), triggered_by_decision_key);
+	Push(page->event_commands, ev->GetId(), triggered_by_decision_key,
+			{ InterpreterProfiler::Source::MapEvent, ev->GetId(), page->ID }, ev->GetProgram(page));
 }
 
 void Game_Interpreter::Push(Game_CommonEvent* ev) {
-	Push(ev->GetList(), 0, false);
+	Push(ev->GetList(), 0, false, { InterpreterProfiler::Source::CommonEvent, ev->GetIndex(), 0 }, ev->GetProgram());
 }
 
 bool Game_Interpreter::CheckGameOver() {
@@ -745,6 +830,100 @@ bool Game_Interpreter::ExecuteCommand() {
 	}
 }
 
+EventProgram& Game_Interpreter::GetProgram(int frame_idx) {
+	if (static_cast<int>(_programs.size()) <= frame_idx) {
+		_programs.resize(frame_idx + 1);
+	}
+
+	const auto& commands = _state.stack[frame_idx].commands;
+	auto& program = _programs[frame_idx];
+	if (!program || program->size() != static_cast<int>(commands.size())) {
+		program = std::make_shared<EventProgram>(static_cast<int>(commands.size()));
+	}
+	return *program;
+}
+
+bool Game_Interpreter::ExecuteInstruction(const EventProgram::Instr& instr, const lcf::rpg::EventCommand& com) {
+	using Op = EventProgram::Op;
+
+	switch (instr.op) {
+		case Op::Unlowered:
+		case Op::Generic:
+			return ExecuteCommand();
+		case Op::Nop:
+			return true;
+		case Op::SetSwitch:
+			Main_Data::game_switches->Set(instr.a, instr.b != 0);
+			Game_Map::SetNeedRefresh(true);
+			return true;
+		case Op::FlipSwitch:
+			Main_Data::game_switches->Flip(instr.a);
+			Game_Map::SetNeedRefresh(true);
+			return true;
+		case Op::VarOpConst:
+			OperateVariable(instr.a, instr.c, instr.b);
+			Game_Map::SetNeedRefresh(true);
+			return true;
+		case Op::VarOpVar:
+			OperateVariable(instr.a, instr.c, Main_Data::game_variables->Get(instr.b));
+			Game_Map::SetNeedRefresh(true);
+			return true;
+		case Op::Wait:
+			SetupWait(instr.a);
+			return true;
+		case Op::BranchSwitch:
+		case Op::BranchVarConst:
+		case Op::BranchVarVar: {
+			bool result;
+			if (instr.op == Op::BranchSwitch) {
+				result = Main_Data::game_switches->Get(instr.a) == (instr.b != 0);
+			} else {
+				const int value1 = Main_Data::game_variables->Get(instr.a);
+				const int value2 = instr.op == Op::BranchVarConst ? instr.b : Main_Data::game_variables->Get(instr.b);
+				result = CompareValues(value1, value2, instr.c);
+			}
+
+			int sub_idx = subcommand_sentinel;
+			if (!result) {
+				sub_idx = eOptionBranchElse;
+				GetFrame().current_command = instr.target;
+			}
+			SetSubcommandIndex(com.indent, sub_idx);
+			return true;
+		}
+		case Op::Else:
+			if (GetSubcommandIndex(com.indent) == eOptionBranchElse) {
+				SetSubcommandIndex(com.indent, subcommand_sentinel);
+			} else {
+				GetFrame().current_command = instr.target;
+			}
+			return true;
+		case Op::JumpToLabel:
+			if (instr.target >= 0) {
+				GetFrame().current_command = instr.target;
+			}
+			return true;
+		case Op::BreakLoop:
+			GetFrame().current_command = instr.target;
+			return true;
+		case Op::EndLoop: {
+			if (instr.target == EventProgram::kStall) {
+				return false;
+			}
+			auto& frame = GetFrame();
+			if (instr.target >= 0) {
+				frame.current_command = instr.target;
+			}
+			// Jump past the Cmd::Loop to the first command.
+			if (frame.current_command < static_cast<int>(frame.commands.size())) {
+				++frame.current_command;
+			}
+			return true;
+		}
+	}
+	return ExecuteCommand();
+}
+
 bool Game_Interpreter::OnFinishStackFrame() {
 	auto& frame = GetFrame();
 
@@ -773,6 +952,12 @@ bool Game_Interpreter::OnFinishStackFrame() {
 	} else {
 		// If a called frame, or base frame of foreground interpreter, pop the stack.
 		_state.stack.pop_back();
+		if (_programs.size() > _state.stack.size()) {
+			_programs.resize(_state.stack.size());
+		}
+		if (_frame_owners.size() > _state.stack.size()) {
+			_frame_owners.resize(_state.stack.size());
+		}
 	}
 
 	return !is_base_frame;
@@ -1242,26 +1427,7 @@ bool Game_Interpreter::CommandControlVariables(lcf::rpg::EventCommand const& com
 
 		if (start == end) {
 			// Single variable case - if this is random value, we already called the RNG earlier.
-			switch (com.parameters[3]) {
-				case 0:
-					Main_Data::game_variables->Set(start, value);
-					break;
-				case 1:
-					Main_Data::game_variables->Add(start, value);
-					break;
-				case 2:
-					Main_Data::game_variables->Sub(start, value);
-					break;
-				case 3:
-					Main_Data::game_variables->Mult(start, value);
-					break;
-				case 4:
-					Main_Data::game_variables->Div(start, value);
-					break;
-				case 5:
-					Main_Data::game_variables->Mod(start, value);
-					break;
-			}
+			OperateVariable(start, com.parameters[3], value);
 		} else if (com.parameters[4] == 1) {
 			// Multiple variables - Direct variable lookup
 			int var_id = com.parameters[5];
@@ -2939,7 +3105,7 @@ bool Game_Interpreter::CommandChangeMapTileset(lcf::rpg::EventCommand const& com
 
 bool Game_Interpreter::CommandChangePBG(lcf::rpg::EventCommand const& com) { // code 11720
 	Game_Map::Parallax::Params params;
-	params.name = ToString(com.string);
+	params.name = com.string;
 	params.scroll_horz = com.parameters[0] != 0;
 	params.scroll_vert = com.parameters[1] != 0;
 	params.scroll_horz_auto = com.parameters[2] != 0;
@@ -3044,32 +3210,7 @@ bool Game_Interpreter::CommandConditionalBranch(lcf::rpg::EventCommand const& co
 		} else {
 			value2 = Main_Data::game_variables->Get(com.parameters[3]);
 		}
-		switch (com.parameters[4]) {
-		case 0:
-			// Equal to
-			result = (value1 == value2);
-			break;
-		case 1:
-			// Greater than or equal
-			result = (value1 >= value2);
-			break;
-		case 2:
-			// Less than or equal
-			result = (value1 <= value2);
-			break;
-		case 3:
-			// Greater than
-			result = (value1 > value2);
-			break;
-		case 4:
-			// Less than
-			result = (value1 < value2);
-			break;
-		case 5:
-			// Different
-			result = (value1 != value2);
-			break;
-		}
+		result = CompareValues(value1, value2, com.parameters[4]);
 		break;
 	case 2:
 		value1 = Main_Data::game_party->GetTimerSeconds(Main_Data::game_party->Timer1);
@@ -3377,7 +3518,7 @@ bool Game_Interpreter::CommandCallEvent(lcf::rpg::EventCommand const& com) { //
 		return false;
 	}
 
-	Push(page->event_commands, event->GetId(), false);
+	Push(event, page, false);
 
 	return true;
 }
@@ -19,11 +19,14 @@
 #define EP_GAME_INTERPRETER_H
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include "async_handler.h"
+#include "event_program.h"
 #include "game_character.h"
 #include "game_actor.h"
+#include "interpreter_profiler.h"
 #include <lcf/dbarray.h>
 #include <lcf/rpg/fwd.h>
 #include <lcf/rpg/eventcommand.h>
@@ -62,10 +65,22 @@ public:
 
 	void Update(bool reset_loop_count=true);
 
+	/**
+	 * Pushes a list of event commands onto the call stack.
+	 *
+	 * @param _list event commands to execute
+	 * @param _event_id id of the calling map event, 0 for common and battle events
+	 * @param started_by_decision_key whether the event was started by the decision key
+	 * @param owner event owning the list, recorded while the profiler is enabled
+	 * @param program lowered program of _list shared by every call of the list,
+	 *                when empty the frame lowers into a program of its own
+	 */
 	void Push(
 			const std::vector<lcf::rpg::EventCommand>& _list,
 			int _event_id,
-			bool started_by_decision_key = false
+			bool started_by_decision_key = false,
+			InterpreterProfiler::Owner owner = {},
+			std::shared_ptr<EventProgram> program = {}
 	);
 	void Push(Game_Event* ev);
 	void Push(Game_Event* ev, const lcf::rpg::EventPage* page, bool triggered_by_decision_key);
@@ -166,6 +181,25 @@ protected:
 	 */
 	bool OnFinishStackFrame();
 
+	/**
+	 * Returns the lowered commands of a stack frame.
+	 * Commands are lowered when they are executed the first time.
+	 *
+	 * @param frame_idx index of the frame in the call stack
+	 * @return program of the frame
+	 */
+	EventProgram& GetProgram(int frame_idx);
+
+	/**
+	 * Executes the current command of the current frame.
+	 * Specialized instructions run directly, all others go to ExecuteCommand.
+	 *
+	 * @param instr lowered command
+	 * @param com event command
+	 * @return same as ExecuteCommand
+	 */
+	bool ExecuteInstruction(const EventProgram::Instr& instr, const lcf::rpg::EventCommand& com);
+
 	/**
 	 * Triggers a game over when all party members are dead.
 	 *
@@ -311,6 +345,14 @@ protected:
 	};
 
 	lcf::rpg::SaveEventExecState _state;
+	/**
+	 * Lowered commands, one per stack frame. Shared with the event page or
+	 * common event the frame was pushed from, frames restored from a savegame
+	 * get their own program when they are executed the first time.
+	 */
+	std::vector<std::shared_ptr<EventProgram>> _programs;
+	/** Event of each stack frame, only maintained while the profiler is enabled */
+	std::vector<InterpreterProfiler::Owner> _frame_owners;
 	KeyInputState _keyinput;
 	AsyncOp _async_op = {};
 };
@@ -36,7 +36,7 @@ enum BranchBattleSubcommand {
 };
 
 Game_Interpreter_Battle::Game_Interpreter_Battle(Span<const lcf::rpg::TroopPage> pages)
-	: Game_Interpreter(true), pages(pages), executed(pages.size(), false)
+	: Game_Interpreter(true), pages(pages), executed(pages.size(), false), page_programs(pages.size())
 {
 }
 
@@ -136,8 +136,12 @@ int Game_Interpreter_Battle::ScheduleNextPage(lcf::rpg::TroopPageCondition::Flag
 				|| !AreConditionsMet(page.condition)) {
 			continue;
 		}
+		auto& program = page_programs[i];
+		if (!program) {
+			program = std::make_shared<EventProgram>(static_cast<int>(page.event_commands.size()));
+		}
 		Clear();
-		Push(page.event_commands, 0);
+		Push(page.event_commands, 0, false, {}, program);
 		executed[i] = true;
 		return i + 1;
 	}
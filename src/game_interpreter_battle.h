@@ -20,6 +20,7 @@
 
 // Headers
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <cassert>
@@ -81,6 +82,8 @@ private:
 private:
 	Span<const lcf::rpg::TroopPage> pages;
 	std::vector<bool> executed;
+	/** Lowered commands of each page, created when the page runs first */
+	std::vector<std::shared_ptr<EventProgram>> page_programs;
 	int target_enemy_index = -1;
 	int current_actor_id = 0;
 	bool targets_single_enemy = false;
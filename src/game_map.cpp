@@ -23,6 +23,7 @@
 #include <climits>
 
 #include "async_handler.h"
+#include "compiler.h"
 #include "system.h"
 #include "game_battle.h"
 #include "game_battler.h"
@@ -34,6 +35,7 @@
 #include "game_message.h"
 #include "game_screen.h"
 #include "game_pictures.h"
+#include "interpreter_profiler.h"
 #include "scene_battle.h"
 #include <lcf/lmu/reader.h>
 #include <lcf/reader_lcf.h>
@@ -61,7 +63,12 @@ namespace {
 	bool animation_fast;
 	std::vector<unsigned char> passages_down;
 	std::vector<unsigned char> passages_up;
+	/** Per tile passages_up of the upper tile (low byte) and passable bits of the lower tile (high byte) */
+	std::vector<uint16_t> tile_passages;
+	bool tile_passages_dirty = true;
 	std::vector<Game_Event> events;
+	/** Tile positions of the events, same order as events, kept in sync by the events */
+	std::vector<Game_Character::Position> event_positions;
 	std::vector<Game_CommonEvent> common_events;
 
 	std::unique_ptr<lcf::rpg::Map> map;
@@ -80,6 +87,20 @@ namespace Game_Map {
 void SetupCommon();
 }
 
+static void BindEventPositions() {
+	event_positions.resize(events.size());
+	for (size_t i = 0; i < events.size(); ++i) {
+		events[i].BindPosition(&event_positions[i]);
+	}
+}
+
+// Same as events[i].IsInPosition(x, y) but only reads the contiguous
+// position array, most events are rejected without touching them.
+static bool IsEventInPosition(size_t i, int x, int y) {
+	const auto& pos = event_positions[i];
+	return pos.x == x && pos.y == y;
+}
+
 void Game_Map::OnContinueFromBattle() {
 	Main_Data::game_system->BgmPlay(Main_Data::game_system->GetBeforeBattleMusic());
 }
@@ -109,11 +130,18 @@ void Game_Map::Init() {
 
 void Game_Map::Dispose() {
 	events.clear();
+	event_positions.clear();
+	tile_passages.clear();
+	tile_passages_dirty = true;
 	map.reset();
 	map_info = {};
 	panorama = {};
 }
 
+std::unique_ptr<lcf::rpg::Map> Game_Map::ReleaseMap() {
+	return std::move(map);
+}
+
 void Game_Map::Quit() {
 	Dispose();
 	common_events.clear();
@@ -225,6 +253,7 @@ void Game_Map::SetupFromSave(
 			auto& ev = events[i];
 			ev.SetSaveData(map_info.events[i]);
 		}
+		BindEventPositions();
 	}
 	map_info.events.clear();
 
@@ -304,19 +333,22 @@ std::unique_ptr<lcf::rpg::Map> Game_Map::loadMapFile(int map_id) {
 		Output::ErrorStr(lcf::LcfReader::GetError());
 	}
 
-	return map;
-}
-
-void Game_Map::SetupCommon() {
-	if (!Tr::GetCurrentTranslationId().empty()) {
+	// Translate on load and not on setup, so a map reused by QuickSave is not translated twice
+	if (map && !Tr::GetCurrentTranslationId().empty()) {
 		//  Build our map translation id.
 		std::stringstream ss;
-		ss << "map" << std::setfill('0') << std::setw(4) << GetMapId() << ".po";
+		ss << "map" << std::setfill('0') << std::setw(4) << map_id << ".po";
 
 		// Translate all messages for this map
 		Player::translation.RewriteMapMessages(ss.str(), *map);
 	}
+
+	return map;
+}
+
+void Game_Map::SetupCommon() {
 	SetNeedRefresh(true);
+	tile_passages_dirty = true;
 
 	int current_index = GetMapIndex(GetMapId());
 
@@ -336,6 +368,7 @@ void Game_Map::SetupCommon() {
 	for (const auto& ev : map->events) {
 		events.emplace_back(GetMapId(), &ev);
 	}
+	BindEventPositions();
 }
 
 void Game_Map::PrepareSave(lcf::rpg::Save& save) {
@@ -583,8 +616,11 @@ bool Game_Map::MakeWay(const Game_Character& self,
 
 	if (vehicle_type != Game_Vehicle::Airship) {
 		// Check for collision with events on the target tile.
-		for (auto& other: GetEvents()) {
-			if (MakeWayCollideEvent(to_x, to_y, self, other, self_conflict)) {
+		for (size_t i = 0; i < events.size(); ++i) {
+			if (!IsEventInPosition(i, to_x, to_y)) {
+				continue;
+			}
+			if (MakeWayCollideEvent(to_x, to_y, self, events[i], self_conflict)) {
 				return false;
 			}
 		}
@@ -630,8 +666,9 @@ bool Game_Map::CanLandAirship(int x, int y) {
 		return false;
 	}
 
-	for (auto& ev: events) {
-		if (ev.IsInPosition(x, y)
+	for (size_t i = 0; i < events.size(); ++i) {
+		auto& ev = events[i];
+		if (IsEventInPosition(i, x, y)
 				&& ev.IsActive()
 				&& ev.GetActivePage() != nullptr) {
 			return false;
@@ -668,8 +705,9 @@ bool Game_Map::CanDisembarkShip(Game_Player& player, int x, int y) {
 		return false;
 	}
 
-	for (auto& ev: GetEvents()) {
-		if (ev.IsInPosition(x, y)
+	for (size_t i = 0; i < events.size(); ++i) {
+		auto& ev = events[i];
+		if (IsEventInPosition(i, x, y)
 			&& ev.GetLayer() == lcf::rpg::EventPage::Layers_same
 			&& ev.IsActive()
 			&& ev.GetActivePage() != nullptr) {
@@ -735,14 +773,18 @@ bool Game_Map::IsPassableTile(const Game_Character* self, int bit, int x, int y)
 
 	// Highest ID event with layer=below, not through, and a tile graphic wins.
 	int event_tile_id = 0;
-	for (auto& ev: events) {
+	for (size_t i = 0; i < events.size(); ++i) {
+		if (!IsEventInPosition(i, x, y)) {
+			continue;
+		}
+		auto& ev = events[i];
 		if (self == &ev) {
 			continue;
 		}
 		if (!ev.IsActive() || ev.GetActivePage() == nullptr || ev.GetThrough()) {
 			continue;
 		}
-		if (ev.IsInPosition(x, y) && ev.GetLayer() == lcf::rpg::EventPage::Layers_below) {
+		if (ev.GetLayer() == lcf::rpg::EventPage::Layers_below) {
 			int tile_id = ev.GetTileId();
 			if (tile_id > 0) {
 				event_tile_id = tile_id;
@@ -765,23 +807,58 @@ bool Game_Map::IsPassableTile(const Game_Character* self, int bit, int x, int y)
 		};
 	}
 
-	int tile_index = x + y * GetWidth();
-	int tile_id = map->upper_layer[tile_index] - BLOCK_F;
-	tile_id = map_info.upper_tiles[tile_id];
-
 	if (vehicle_type == Game_Vehicle::Boat || vehicle_type == Game_Vehicle::Ship) {
+		int tile_index = x + y * GetWidth();
+		int tile_id = map->upper_layer[tile_index] - BLOCK_F;
+		tile_id = map_info.upper_tiles[tile_id];
+
 		if ((passages_up[tile_id] & Passable::Above) == 0)
 			return false;
 		return true;
 	}
 
-	if ((passages_up[tile_id] & bit) == 0)
+	return IsPassableTileLayers(bit, x, y);
+}
+
+static void RefreshTilePassages() {
+	const int num_tiles = Game_Map::GetWidth() * Game_Map::GetHeight();
+	tile_passages.resize(num_tiles);
+
+	for (int tile_index = 0; tile_index < num_tiles; ++tile_index) {
+		int tile_id = map->upper_layer[tile_index] - BLOCK_F;
+		tile_id = map_info.upper_tiles[tile_id];
+
+		int lower = 0;
+		for (int bit: { Passable::Down, Passable::Left, Passable::Right, Passable::Up }) {
+			if (Game_Map::IsPassableLowerTile(bit, tile_index)) {
+				lower |= bit;
+			}
+		}
+
+		tile_passages[tile_index] = static_cast<uint16_t>(passages_up[tile_id] | (lower << 8));
+	}
+
+	tile_passages_dirty = false;
+}
+
+bool Game_Map::IsPassableTileLayers(int bit, int x, int y) {
+	if (!IsValid(x, y)) return false;
+
+	if (tile_passages_dirty) {
+		RefreshTilePassages();
+	}
+
+	const int passage = tile_passages[x + y * GetWidth()];
+	const int upper = passage & 0xFF;
+	const int lower = passage >> 8;
+
+	if ((upper & bit) == 0)
 		return false;
 
-	if ((passages_up[tile_id] & Passable::Above) == 0)
+	if ((upper & Passable::Above) == 0)
 		return true;
 
-	return IsPassableLowerTile(bit, tile_index);
+	return (lower & bit) != 0;
 }
 
 int Game_Map::GetBushDepth(int x, int y) {
@@ -844,19 +921,18 @@ int Game_Map::GetTerrainTag(int x, int y) {
 	return terrain_data[chip_index];
 }
 
-void Game_Map::GetEventsXY(std::vector<Game_Event*>& events, int x, int y) {
-	for (Game_Event& ev : GetEvents()) {
-		if (ev.IsInPosition(x, y) && ev.IsActive()) {
-			events.push_back(&ev);
+void Game_Map::GetEventsXY(std::vector<Game_Event*>& out, int x, int y) {
+	for (size_t i = 0; i < events.size(); ++i) {
+		if (IsEventInPosition(i, x, y) && events[i].IsActive()) {
+			out.push_back(&events[i]);
 		}
 	}
 }
 
 Game_Event* Game_Map::GetEventAt(int x, int y, bool require_active) {
-	auto& events = GetEvents();
-	for (auto iter = events.rbegin(); iter != events.rend(); ++iter) {
-		auto& ev = *iter;
-		if (ev.IsInPosition(x, y) && (!require_active || ev.IsActive())) {
+	for (size_t i = events.size(); i > 0; --i) {
+		auto& ev = events[i - 1];
+		if (IsEventInPosition(i - 1, x, y) && (!require_active || ev.IsActive())) {
 			return &ev;
 		}
 	}
@@ -912,9 +988,9 @@ int Game_Map::YwithDirection(int y, int direction) {
 }
 
 int Game_Map::CheckEvent(int x, int y) {
-	for (const Game_Event& ev : events) {
-		if (ev.IsInPosition(x, y)) {
-			return ev.GetId();
+	for (size_t i = 0; i < events.size(); ++i) {
+		if (IsEventInPosition(i, x, y)) {
+			return events[i].GetId();
 		}
 	}
 
@@ -1015,7 +1091,13 @@ bool Game_Map::UpdateCommonEvents(MapUpdateAsyncContext& actx) {
 			}
 		}
 
-		auto aop = ev.Update(resume_async);
+		AsyncOp aop;
+		if (EP_UNLIKELY(InterpreterProfiler::IsEnabled())) {
+			InterpreterProfiler::Scope profile_scope(InterpreterProfiler::Source::CommonEvent, ev.GetIndex(), 0);
+			aop = ev.Update(resume_async);
+		} else {
+			aop = ev.Update(resume_async);
+		}
 		if (aop.IsActive()) {
 			// Suspend due to this event ..
 			actx = MapUpdateAsyncContext::FromCommonEvent(ev.GetIndex(), aop);
@@ -1042,7 +1124,14 @@ bool Game_Map::UpdateMapEvents(MapUpdateAsyncContext& actx) {
 			}
 		}
 
-		auto aop = ev.Update(resume_async);
+		AsyncOp aop;
+		if (EP_UNLIKELY(InterpreterProfiler::IsEnabled())) {
+			const auto* page = ev.GetActivePage();
+			InterpreterProfiler::Scope profile_scope(InterpreterProfiler::Source::MapEvent, ev.GetId(), page ? page->ID : 0);
+			aop = ev.Update(resume_async);
+		} else {
+			aop = ev.Update(resume_async);
+		}
 		if (aop.IsActive()) {
 			// Suspend due to this event ..
 			actx = MapUpdateAsyncContext::FromMapEvent(ev.GetId(), aop);
@@ -1179,10 +1268,10 @@ void Game_Map::SetEncounterRate(int step) {
 	map_info.encounter_rate = step;
 }
 
-std::vector<int> Game_Map::GetEncountersAt(int x, int y) {
+FrameVector<int> Game_Map::GetEncountersAt(int x, int y) {
 	int terrain_tag = GetTerrainTag(Main_Data::game_player->GetX(), Main_Data::game_player->GetY());
 
-	std::function<bool(int)> is_acceptable = [=](int troop_id) {
+	auto is_acceptable = [=](int troop_id) {
 		const lcf::rpg::Troop* troop = lcf::ReaderUtil::GetElement(lcf::Data::troops, troop_id);
 		if (!troop) {
 			Output::Warning("GetEncountersAt: Invalid troop ID {} in encounter list", troop_id);
@@ -1196,7 +1285,7 @@ std::vector<int> Game_Map::GetEncountersAt(int x, int y) {
 				terrain_set[terrain_tag - 1];
 	};
 
-	std::vector<int> out;
+	FrameVector<int> out;
 
 	for (unsigned int i = 0; i < lcf::Data::treemap.maps.size(); ++i) {
 		lcf::rpg::MapInfo& map = lcf::Data::treemap.maps[i];
@@ -1253,7 +1342,7 @@ bool Game_Map::PrepareEncounter(BattleArgs& args) {
 	int x = Main_Data::game_player->GetX();
 	int y = Main_Data::game_player->GetY();
 
-	std::vector<int> encounters = GetEncountersAt(x, y);
+	auto encounters = GetEncountersAt(x, y);
 
 	if (encounters.empty()) {
 		// No enemies on this map :(
@@ -1457,6 +1546,8 @@ void Game_Map::SetChipset(int id) {
 		passages_down.resize(162, (unsigned char) 0x0F);
 	if (passages_up.size() < 144)
 		passages_up.resize(144, (unsigned char) 0x0F);
+
+	tile_passages_dirty = true;
 }
 
 Game_Vehicle* Game_Map::GetVehicle(Game_Vehicle::Type which) {
@@ -1528,11 +1619,19 @@ static int DoSubstitute(std::vector<uint8_t>& tiles, int old_id, int new_id) {
 }
 
 int Game_Map::SubstituteDown(int old_id, int new_id) {
-	return DoSubstitute(map_info.lower_tiles, old_id, new_id);
+	int num_subst = DoSubstitute(map_info.lower_tiles, old_id, new_id);
+	if (num_subst > 0) {
+		tile_passages_dirty = true;
+	}
+	return num_subst;
 }
 
 int Game_Map::SubstituteUp(int old_id, int new_id) {
-	return DoSubstitute(map_info.upper_tiles, old_id, new_id);
+	int num_subst = DoSubstitute(map_info.upper_tiles, old_id, new_id);
+	if (num_subst > 0) {
+		tile_passages_dirty = true;
+	}
+	return num_subst;
 }
 
 std::string Game_Map::ConstructMapName(int map_id, bool is_easyrpg) {
@@ -1575,7 +1674,7 @@ static Game_Map::Parallax::Params GetParallaxParams() {
 		params.scroll_vert_speed = map_info.parallax_vert_speed;
 	} else if (map->parallax_flag) {
 		// Default case when map parallax hasn't been overwritten.
-		params.name = ToString(map->parallax_name);
+		params.name = map->parallax_name;
 		params.scroll_horz = map->parallax_loop_x;
 		params.scroll_horz_auto = map->parallax_auto_loop_x;
 		params.scroll_horz_speed = map->parallax_sx;
@@ -1589,7 +1688,7 @@ static Game_Map::Parallax::Params GetParallaxParams() {
 	return params;
 }
 
-std::string Game_Map::Parallax::GetName() {
+StringView Game_Map::Parallax::GetName() {
 	return GetParallaxParams().name;
 }
 
@@ -1734,7 +1833,7 @@ void Game_Map::Parallax::Update() {
 }
 
 void Game_Map::Parallax::ChangeBG(const Params& params) {
-	map_info.parallax_name = params.name;
+	map_info.parallax_name = ToString(params.name);
 	map_info.parallax_horz = params.scroll_horz;
 	map_info.parallax_horz_auto = params.scroll_horz_auto;
 	map_info.parallax_horz_speed = params.scroll_horz_speed;
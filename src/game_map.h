@@ -22,10 +22,12 @@
 #include <vector>
 #include <string>
 #include "system.h"
+#include "frame_arena.h"
 #include "game_commonevent.h"
 #include "game_event.h"
 #include "game_vehicle.h"
 #include "game_player.h"
+#include "string_view.h"
 #include <lcf/rpg/fwd.h>
 #include <lcf/rpg/encounter.h>
 #include <lcf/rpg/map.h>
@@ -90,7 +92,15 @@ namespace Game_Map {
 	void Dispose();
 
 	/**
-	 * Loads the map from disk
+	 * Takes the data of the current map out of Game_Map.
+	 * The map must be disposed or setup again afterwards.
+	 *
+	 * @return the map, or nullptr if no map is loaded
+	 */
+	std::unique_ptr<lcf::rpg::Map> ReleaseMap();
+
+	/**
+	 * Loads the map from disk and applies the active translation to its messages
 	 *
 	 * @param map_id the id of the map to load
 	 * @return the map, or nullptr if it couldn't be loaded
@@ -336,9 +346,9 @@ namespace Game_Map {
 	 *
 	 * @param x x position
 	 * @param y y position
-	 * @return Possible encounters
+	 * @return Possible encounters, valid until the end of the frame
 	 */
-	std::vector<int> GetEncountersAt(int x, int y);
+	FrameVector<int> GetEncountersAt(int x, int y);
 
 	/**
 	 * Updates all battle data based on the current player position and starts
@@ -585,6 +595,21 @@ namespace Game_Map {
 	 */
 	bool IsPassableLowerTile(int bit, int tile_index);
 
+	/**
+	 * Checks if the tile layers at (x,y) are passable, ignoring all events.
+	 * Gives the same result as IsPassableTile for a character without
+	 * vehicle when no tile graphic event is on the tile.
+	 *
+	 * The passability is looked up in a grid which is only rebuilt after
+	 * the map, the chipset or a tile substitution changed.
+	 *
+	 * @param bit which direction bits to check
+	 * @param x target tile x.
+	 * @param y target tile y.
+	 * @return whether is passable.
+	 */
+	bool IsPassableTileLayers(int bit, int x, int y);
+
 	/**
 	 * Gets whether there are any starting non-parallel event or common event.
 	 * Used as a workaround for the Game Player.
@@ -620,8 +645,12 @@ namespace Game_Map {
 	FileRequestAsync* RequestMap(int map_id);
 
 	namespace Parallax {
+		/**
+		 * Parallax settings. The name refers to the string it was
+		 * assigned from and must not outlive it.
+		 */
 		struct Params {
-			std::string name;
+			StringView name;
 			bool scroll_horz;
 			bool scroll_horz_auto;
 			int scroll_horz_speed;
@@ -634,7 +663,7 @@ namespace Game_Map {
 		 * The name of the current parallax graphic (or the empty string
 		 * if none).
 		 */
-		std::string GetName();
+		StringView GetName();
 
 		/**
 		 * Offset in pixels of the bitmap at the top-left of the screen.
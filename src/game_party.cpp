@@ -79,23 +79,21 @@ void Game_Party::SetupFromSave(lcf::rpg::SaveInventory save) {
 }
 
 Game_Actor& Game_Party::operator[] (const int index) {
-	std::vector<Game_Actor*> actors = GetActors();
-
-	if (index < 0 || (size_t)index >= actors.size()) {
+	if (index < 0 || (size_t)index >= data.party.size()) {
 		assert(false && "Subscript out of range");
 	}
 
-	return *actors[index];
+	return *Main_Data::game_actors->GetActor(data.party[index]);
 }
 
 int Game_Party::GetBattlerCount() const {
-	return (int)GetActors().size();
+	return (int)data.party.size();
 }
 
 int Game_Party::GetVisibleBattlerCount() const {
 	int visible = 0;
-	for (const auto& actor: GetActors()) {
-		visible += !actor->IsHidden();
+	for (auto actor_id: data.party) {
+		visible += !Main_Data::game_actors->GetActor(actor_id)->IsHidden();
 	}
 	return visible;
 }
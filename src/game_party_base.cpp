@@ -32,6 +32,13 @@ void Game_Party_Base::GetBattlers(std::vector<Game_Battler*>& out) {
 	}
 }
 
+void Game_Party_Base::GetBattlers(FrameVector<Game_Battler*>& out) {
+	int count = GetBattlerCount();
+	for (int i = 0; i < count; ++i) {
+		out.push_back(&(*this)[i]);
+	}
+}
+
 void Game_Party_Base::GetActiveBattlers(std::vector<Game_Battler*>& out) {
 	int count = GetBattlerCount();
 	for (int i = 0; i < count; ++i) {
@@ -19,6 +19,7 @@
 #define EP_GAME_PARTY_BASE_H
 
 #include <vector>
+#include "frame_arena.h"
 #include "game_actor.h"
 #include "main_data.h"
 
@@ -58,6 +59,14 @@ public:
 	 */
 	virtual void GetBattlers(std::vector<Game_Battler*>& out);
 
+	/**
+	 * Returns a list of all battlers in the party, for lists which only live
+	 * until the end of the frame.
+	 *
+	 * @param out List of all battlers
+	 */
+	void GetBattlers(FrameVector<Game_Battler*>& out);
+
 	/**
 	 * Gets a list with all active (not dead or hidden) party members.
 	 *
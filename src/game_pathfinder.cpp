@@ -0,0 +1,342 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <cstdlib>
+#include "game_pathfinder.h"
+#include "game_character.h"
+#include "game_event.h"
+#include "game_map.h"
+#include "game_player.h"
+#include "game_vehicle.h"
+#include "main_data.h"
+#include "map_data.h"
+
+namespace {
+	/**
+	 * Search state of one tile. Tiles are only valid when their stamp
+	 * matches the current search, this avoids clearing the whole grid
+	 * for every search.
+	 */
+	struct Node {
+		uint32_t stamp = 0;
+		/** A character blocks the tile */
+		uint32_t obstacle_stamp = 0;
+		/** A tile graphic event is on the tile, passability needs the full check */
+		uint32_t tile_event_stamp = 0;
+		int cost = 0;
+		int parent = -1;
+		int8_t dir = -1;
+		bool closed = false;
+	};
+
+	struct OpenEntry {
+		int score;
+		int cost;
+		int index;
+	};
+
+	/** Orders the heap by lowest score first, then highest cost, which prefers tiles near the target */
+	bool operator<(const OpenEntry& l, const OpenEntry& r) {
+		if (l.score != r.score) {
+			return l.score > r.score;
+		}
+		if (l.cost != r.cost) {
+			return l.cost < r.cost;
+		}
+		return l.index > r.index;
+	}
+
+	std::vector<Node> nodes;
+	std::vector<OpenEntry> open;
+	uint32_t stamp = 0;
+
+	constexpr int directions[] = { Game_Character::Up, Game_Character::Right, Game_Character::Down, Game_Character::Left };
+
+	int DirectionBit(int dir) {
+		switch (dir) {
+			case Game_Character::Up:
+				return Passable::Up;
+			case Game_Character::Right:
+				return Passable::Right;
+			case Game_Character::Down:
+				return Passable::Down;
+			case Game_Character::Left:
+				return Passable::Left;
+		}
+		return 0;
+	}
+
+	int Distance(int from, int to, int size, bool loop) {
+		int d = std::abs(to - from);
+		if (loop) {
+			d = std::min(d, size - d);
+		}
+		return d;
+	}
+
+	int Heuristic(int x, int y, int tx, int ty) {
+		return Distance(x, tx, Game_Map::GetWidth(), Game_Map::LoopHorizontal())
+			+ Distance(y, ty, Game_Map::GetHeight(), Game_Map::LoopVertical());
+	}
+
+	/** Same as the collision check of Game_Map::MakeWay, without the tile graphic self conflict */
+	bool IsObstacle(const Game_Character& self, const Game_Character& other) {
+		if (&self == &other) {
+			return false;
+		}
+
+		if (self.GetThrough() || other.GetThrough()) {
+			return false;
+		}
+
+		if (self.IsFlying() || other.IsFlying()) {
+			return false;
+		}
+
+		if (!self.IsActive() || !other.IsActive()) {
+			return false;
+		}
+
+		if (self.GetType() == Game_Character::Event
+				&& other.GetType() == Game_Character::Event
+				&& (self.IsOverlapForbidden() || other.IsOverlapForbidden())) {
+			return true;
+		}
+
+		return self.GetLayer() == other.GetLayer();
+	}
+
+	void MarkObstacle(int x, int y) {
+		if (Game_Map::IsValid(x, y)) {
+			nodes[x + y * Game_Map::GetWidth()].obstacle_stamp = stamp;
+		}
+	}
+
+	void MarkObstacles(const Game_Character& self, bool is_vehicle) {
+		for (auto& ev: Game_Map::GetEvents()) {
+			if (&ev == &self) {
+				continue;
+			}
+
+			if (!is_vehicle && ev.IsActive() && ev.GetActivePage() != nullptr && !ev.GetThrough()
+					&& ev.GetLayer() == lcf::rpg::EventPage::Layers_below && ev.GetTileId() > 0
+					&& Game_Map::IsValid(ev.GetX(), ev.GetY())) {
+				nodes[ev.GetX() + ev.GetY() * Game_Map::GetWidth()].tile_event_stamp = stamp;
+			}
+
+			if (IsObstacle(self, ev)) {
+				MarkObstacle(ev.GetX(), ev.GetY());
+			}
+		}
+
+		auto& player = *Main_Data::game_player;
+		if (player.GetVehicleType() == Game_Vehicle::None && IsObstacle(self, player)) {
+			MarkObstacle(player.GetX(), player.GetY());
+		}
+
+		for (auto vid: { Game_Vehicle::Boat, Game_Vehicle::Ship, Game_Vehicle::Airship }) {
+			auto& vehicle = *Game_Map::GetVehicle(vid);
+			if (vid == Game_Vehicle::Airship && self.GetType() == Game_Character::Player) {
+				continue;
+			}
+			if (vehicle.IsInCurrentMap() && IsObstacle(self, vehicle)) {
+				MarkObstacle(vehicle.GetX(), vehicle.GetY());
+			}
+		}
+	}
+
+	bool IsPassable(const Game_Character& self, bool is_vehicle, int bit, int index, int x, int y) {
+		if (is_vehicle || nodes[index].tile_event_stamp == stamp) {
+			return Game_Map::IsPassableTile(&self, bit, x, y);
+		}
+		return Game_Map::IsPassableTileLayers(bit, x, y);
+	}
+}
+
+bool Game_Pathfinder::FindPath(const Game_Character& ch, int x, int y, std::vector<int>& path, int max_nodes) {
+	path.clear();
+
+	if (!Game_Map::IsValid(x, y) || !Game_Map::IsValid(ch.GetX(), ch.GetY())) {
+		return false;
+	}
+
+	// The player walks with the rules of the vehicle it is in
+	const Game_Character* self = &ch;
+	if (ch.GetType() == Game_Character::Player && static_cast<const Game_Player&>(ch).InVehicle()) {
+		self = static_cast<const Game_Player&>(ch).GetVehicle();
+	}
+	const bool is_vehicle = self->GetType() == Game_Character::Vehicle;
+	const bool is_airship = is_vehicle && static_cast<const Game_Vehicle*>(self)->GetVehicleType() == Game_Vehicle::Airship;
+
+	const int width = Game_Map::GetWidth();
+	const int height = Game_Map::GetHeight();
+
+	if (nodes.size() != static_cast<size_t>(width * height)) {
+		nodes.clear();
+		nodes.resize(width * height);
+		stamp = 0;
+	}
+
+	if (++stamp == 0) {
+		// All stamps are stale after the counter wrapped around
+		for (auto& node: nodes) {
+			node = {};
+		}
+		stamp = 1;
+	}
+
+	if (!self->GetThrough() && !is_airship) {
+		MarkObstacles(*self, is_vehicle);
+	}
+
+	const int start = ch.GetX() + ch.GetY() * width;
+	const int target = x + y * width;
+
+	nodes[start].stamp = stamp;
+	nodes[start].cost = 0;
+	nodes[start].parent = -1;
+	nodes[start].dir = -1;
+	nodes[start].closed = false;
+
+	int best = start;
+	int best_distance = Heuristic(ch.GetX(), ch.GetY(), x, y);
+
+	open.clear();
+	open.push_back({ best_distance, 0, start });
+
+	int num_visited = 0;
+	while (!open.empty() && num_visited < max_nodes) {
+		std::pop_heap(open.begin(), open.end());
+		const auto entry = open.back();
+		open.pop_back();
+
+		auto& node = nodes[entry.index];
+		if (node.closed) {
+			continue;
+		}
+		node.closed = true;
+		++num_visited;
+
+		const int cx = entry.index % width;
+		const int cy = entry.index / width;
+
+		const int distance = Heuristic(cx, cy, x, y);
+		if (distance < best_distance) {
+			best = entry.index;
+			best_distance = distance;
+		}
+
+		if (entry.index == target) {
+			break;
+		}
+
+		for (int dir: directions) {
+			int nx = cx + Game_Character::GetDxFromDirection(dir);
+			int ny = cy + Game_Character::GetDyFromDirection(dir);
+			if (!Game_Map::IsValid(Game_Map::RoundX(nx), Game_Map::RoundY(ny))) {
+				continue;
+			}
+			nx = Game_Map::RoundX(nx);
+			ny = Game_Map::RoundY(ny);
+
+			const int index = nx + ny * width;
+			auto& next = nodes[index];
+			if (next.stamp == stamp && (next.closed || next.cost <= node.cost + 1)) {
+				continue;
+			}
+
+			if (!self->GetThrough()) {
+				if (next.obstacle_stamp == stamp && index != target) {
+					continue;
+				}
+				// Vehicles can always step off a tile
+				if (!is_vehicle && !IsPassable(*self, is_vehicle, DirectionBit(dir), entry.index, cx, cy)) {
+					continue;
+				}
+				if (!IsPassable(*self, is_vehicle, DirectionBit(Game_Character::ReverseDir(dir)), index, nx, ny)) {
+					continue;
+				}
+			}
+
+			next.stamp = stamp;
+			next.cost = node.cost + 1;
+			next.parent = entry.index;
+			next.dir = static_cast<int8_t>(dir);
+			next.closed = false;
+
+			open.push_back({ next.cost + Heuristic(nx, ny, x, y), next.cost, index });
+			std::push_heap(open.begin(), open.end());
+		}
+	}
+
+	for (int index = best; index != start; index = nodes[index].parent) {
+		path.push_back(nodes[index].dir);
+	}
+	std::reverse(path.begin(), path.end());
+
+	if (best == target && nodes[target].obstacle_stamp == stamp && !path.empty()) {
+		// The step onto the occupied target would block the move route forever
+		path.pop_back();
+	}
+
+	return best == target;
+}
+
+lcf::rpg::MoveRoute Game_Pathfinder::MakeMoveRoute(const std::vector<int>& path, int max_steps) {
+	using Code = lcf::rpg::MoveCommand::Code;
+
+	lcf::rpg::MoveRoute route;
+	route.repeat = false;
+	route.skippable = false;
+
+	const int num_steps = static_cast<int>(path.size());
+	const int n = (max_steps > 0) ? std::min(max_steps, num_steps) : num_steps;
+
+	for (int i = 0; i < n; ++i) {
+		lcf::rpg::MoveCommand cmd;
+		switch (path[i]) {
+			case Game_Character::Up:
+				cmd.command_id = static_cast<int>(Code::move_up);
+				break;
+			case Game_Character::Right:
+				cmd.command_id = static_cast<int>(Code::move_right);
+				break;
+			case Game_Character::Down:
+				cmd.command_id = static_cast<int>(Code::move_down);
+				break;
+			case Game_Character::Left:
+				cmd.command_id = static_cast<int>(Code::move_left);
+				break;
+		}
+		route.move_commands.push_back(std::move(cmd));
+	}
+
+	return route;
+}
+
+bool Game_Pathfinder::MoveTo(Game_Character& ch, int x, int y, int max_steps) {
+	std::vector<int> path;
+	const bool found = FindPath(ch, x, y, path);
+
+	if (!path.empty()) {
+		ch.ForceMoveRoute(MakeMoveRoute(path, max_steps), ch.GetMoveFrequency());
+	}
+
+	return found;
+}
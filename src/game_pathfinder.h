@@ -0,0 +1,81 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_GAME_PATHFINDER_H
+#define EP_GAME_PATHFINDER_H
+
+// Headers
+#include <vector>
+#include <lcf/rpg/moveroute.h>
+
+class Game_Character;
+
+/**
+ * Finds walking paths for characters on the current map.
+ *
+ * Tiles are checked with the cached passability grid of Game_Map and
+ * events are treated as obstacles at their current position, so a path
+ * is only valid for the frame it was searched in. Characters following
+ * a path over a longer distance should search again after every few steps.
+ */
+namespace Game_Pathfinder {
+
+/** Default limit of tiles visited by one search */
+constexpr int default_max_nodes = 4096;
+
+/**
+ * Searches the shortest path of single steps (up, right, down, left) with A*.
+ *
+ * The target tile is never treated as blocked by a character. When it is
+ * occupied, the path towards the event or player ends next to it and counts
+ * as reaching the target.
+ * When the target is unreachable or the search limit is hit, the path leads
+ * to the visited tile closest to the target.
+ *
+ * @param ch character to move
+ * @param x target tile x
+ * @param y target tile y
+ * @param path receives the directions of the steps, cleared first
+ * @param max_nodes maximum number of tiles to visit
+ * @return whether the path reaches the target
+ */
+bool FindPath(const Game_Character& ch, int x, int y, std::vector<int>& path, int max_nodes = default_max_nodes);
+
+/**
+ * Converts a path into a move route which walks the steps.
+ *
+ * @param path directions returned by FindPath
+ * @param max_steps maximum number of steps to take, 0 for the whole path
+ * @return move route, not repeating and not skippable
+ */
+lcf::rpg::MoveRoute MakeMoveRoute(const std::vector<int>& path, int max_steps = 0);
+
+/**
+ * Searches a path and forces the character to walk it with its current
+ * move frequency. Nothing happens when no step can be taken.
+ *
+ * @param ch character to move
+ * @param x target tile x
+ * @param y target tile y
+ * @param max_steps maximum number of steps to take, 0 for the whole path
+ * @return whether the path reaches the target
+ */
+bool MoveTo(Game_Character& ch, int x, int y, int max_steps = 0);
+
+}
+
+#endif
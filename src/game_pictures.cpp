@@ -63,19 +63,26 @@ Game_Pictures::Picture::Picture(lcf::rpg::SavePicture save)
 {
 	// FIXME: Make this more accurate by checking all animating chunks values to see if they all will remain stable.
 	// Write unit tests to ensure it's correct.
-	// Then add it to ErasePicture()
 	needs_update = !IsEmpty(data);
 }
 
 void Game_Pictures::InitGraphics() {
-	for (auto& pic: pictures) {
-		RequestPictureSprite(pic);
+	for (int id: active_pictures) {
+		RequestPictureSprite(pictures[id - 1]);
+	}
+}
+
+void Game_Pictures::Track(Picture& pic) {
+	if (!pic.tracked) {
+		pic.tracked = true;
+		active_pictures.push_back(pic.data.ID);
 	}
 }
 
 void Game_Pictures::SetSaveData(std::vector<lcf::rpg::SavePicture> save)
 {
 	pictures.clear();
+	active_pictures.clear();
 
 	frame_counter = save.empty() ? 0 : save.back().frames;
 
@@ -91,6 +98,9 @@ void Game_Pictures::SetSaveData(std::vector<lcf::rpg::SavePicture> save)
 	pictures.reserve(num_pictures);
 	for (int i = 0; i < num_pictures; ++i) {
 		pictures.emplace_back(std::move(save[i]));
+		if (pictures.back().needs_update) {
+			Track(pictures.back());
+		}
 	}
 }
 
@@ -155,7 +165,8 @@ Game_Pictures::Picture* Game_Pictures::GetPicturePtr(int id) {
 }
 
 void Game_Pictures::OnMapChange() {
-	for (auto& pic: pictures) {
+	for (int id: active_pictures) {
+		auto& pic = pictures[id - 1];
 		if (pic.data.flags.erase_on_map_change) {
 			pic.Erase();
 		}
@@ -163,7 +174,8 @@ void Game_Pictures::OnMapChange() {
 }
 
 void Game_Pictures::OnBattleEnd() {
-	for (auto& pic: pictures) {
+	for (int id: active_pictures) {
+		auto& pic = pictures[id - 1];
 		if (pic.data.flags.erase_on_battle_end) {
 			pic.Erase();
 		}
@@ -230,6 +242,7 @@ bool Game_Pictures::Picture::Show(const ShowParams& params) {
 
 void Game_Pictures::Show(int id, const ShowParams& params) {
 	auto& pic = GetPicture(id);
+	Track(pic);
 	if (pic.Show(params)) {
 		RequestPictureSprite(pic);
 	}
@@ -353,8 +366,8 @@ void Game_Pictures::Picture::OnMapScrolled(int dx16, int dy16) {
 }
 
 void Game_Pictures::OnMapScrolled(int dx, int dy) {
-	for (auto& pic: pictures) {
-		pic.OnMapScrolled(dx, dy);
+	for (int id: active_pictures) {
+		pictures[id - 1].OnMapScrolled(dx, dy);
 	}
 }
 
@@ -363,10 +376,6 @@ void Game_Pictures::Picture::Update(bool is_battle) {
 		return;
 	}
 
-	if (Player::IsRPG2k3E()) {
-		++data.frames;
-	}
-
 	if (!needs_update) {
 		return;
 	}
@@ -442,8 +451,20 @@ void Game_Pictures::Picture::Update(bool is_battle) {
 
 void Game_Pictures::Update(bool is_battle) {
 	++frame_counter;
-	for (auto& pic: pictures) {
-		pic.Update(is_battle);
+
+	// RPG_RT counts the frames of every picture with save data,
+	// also of erased ones and of slots which were never shown
+	if (Player::IsRPG2k3E()) {
+		for (auto& pic: pictures) {
+			if (is_battle ? pic.IsOnBattle() : pic.IsOnMap()) {
+				++pic.data.frames;
+			}
+		}
+	}
+
+	// Only pictures which were shown move and animate
+	for (int id: active_pictures) {
+		pictures[id - 1].Update(is_battle);
 	}
 }
 
@@ -93,6 +93,8 @@ public:
 		lcf::rpg::SavePicture data;
 		FileRequestBinding request_id;
 		bool needs_update = false;
+		/** Whether the picture is in the active picture list */
+		bool tracked = false;
 
 		void Update(bool is_battle);
 
@@ -116,8 +118,14 @@ public:
 private:
 	void RequestPictureSprite(Picture& pic);
 	void OnPictureSpriteReady(int id);
+	void Track(Picture& pic);
 
 	std::vector<Picture> pictures;
+	/**
+	 * IDs of the pictures that were shown or loaded from a save.
+	 * Erased pictures stay in the list, their save data keeps changing.
+	 */
+	std::vector<int> active_pictures;
 	std::deque<Sprite_Picture> sprites;
 	int frame_counter = 0;
 };
@@ -16,15 +16,82 @@
  */
 
 // Headers
+#include <algorithm>
 #include "game_switches.h"
 #include "output.h"
 #include <lcf/reader_util.h>
 #include <lcf/data.h>
 
 constexpr int Game_Switches::kMaxWarnings;
+constexpr int Game_Switches::kWordBits;
+
+namespace {
+	using Word_t = Game_Switches::Word_t;
+	constexpr int kWordBits = Game_Switches::kWordBits;
+	constexpr Word_t kAllBits = ~Word_t(0);
+
+	/**
+	 * Calls op(word, mask) for every word overlapping the bit range [first, last).
+	 * Only the bits set in mask belong to the range, inner words get a full mask.
+	 */
+	template <typename W, typename F>
+	void ForEachWord(W* words, int first, int last, F&& op) {
+		const int first_word = first / kWordBits;
+		const int last_word = (last - 1) / kWordBits;
+		const Word_t first_mask = kAllBits << (first % kWordBits);
+		const Word_t last_mask = kAllBits >> (kWordBits - 1 - (last - 1) % kWordBits);
+
+		if (first_word == last_word) {
+			op(words[first_word], first_mask & last_mask);
+			return;
+		}
+
+		op(words[first_word], first_mask);
+		for (int i = first_word + 1; i < last_word; ++i) {
+			op(words[i], kAllBits);
+		}
+		op(words[last_word], last_mask);
+	}
+
+	int PopCount(Word_t w) {
+#ifdef __GNUC__
+		return __builtin_popcountll(w);
+#else
+		w = w - ((w >> 1) & 0x5555555555555555ULL);
+		w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+		w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		return static_cast<int>((w * 0x0101010101010101ULL) >> 56);
+#endif
+	}
+}
 
 Game_Switches::Game_Switches() {
-	_switches.reserve(lcf::Data::switches.size());
+	_words.reserve((lcf::Data::switches.size() + kWordBits - 1) / kWordBits);
+}
+
+void Game_Switches::SetData(const Switches_t& s) {
+	_size = static_cast<int>(s.size());
+	_words.assign((_size + kWordBits - 1) / kWordBits, 0);
+	for (int i = 0; i < _size; ++i) {
+		if (s[i]) {
+			_words[i / kWordBits] |= Word_t(1) << (i % kWordBits);
+		}
+	}
+}
+
+Game_Switches::Switches_t Game_Switches::GetData() const {
+	Switches_t s(_size);
+	for (int i = 0; i < _size; ++i) {
+		s[i] = (_words[i / kWordBits] >> (i % kWordBits)) & 1;
+	}
+	return s;
+}
+
+void Game_Switches::Resize(int size) {
+	if (size > _size) {
+		_words.resize((size + kWordBits - 1) / kWordBits, 0);
+		_size = size;
+	}
 }
 
 void Game_Switches::WarnGet(int variable_id) const {
@@ -40,11 +107,11 @@ bool Game_Switches::Set(int switch_id, bool value) {
 	if (switch_id <= 0) {
 		return false;
 	}
-	auto& ss = _switches;
-	if (switch_id > static_cast<int>(ss.size())) {
-		ss.resize(switch_id);
-	}
-	ss[switch_id - 1] = value;
+	Resize(switch_id);
+	const int idx = switch_id - 1;
+	const Word_t bit = Word_t(1) << (idx % kWordBits);
+	auto& word = _words[idx / kWordBits];
+	word = value ? (word | bit) : (word & ~bit);
 	return value;
 }
 
@@ -53,12 +120,15 @@ void Game_Switches::SetRange(int first_id, int last_id, bool value) {
 		Output::Debug("Invalid write sw[{},{}] = {}!", first_id, last_id, value);
 		--_warnings;
 	}
-	auto& ss = _switches;
-	if (last_id > static_cast<int>(ss.size())) {
-		ss.resize(last_id, false);
+	Resize(last_id);
+	const int first = std::max(0, first_id - 1);
+	if (first >= last_id) {
+		return;
 	}
-	for (int i = std::max(0, first_id - 1); i < last_id; ++i) {
-		ss[i] = value;
+	if (value) {
+		ForEachWord(_words.data(), first, last_id, [](Word_t& w, Word_t mask) { w |= mask; });
+	} else {
+		ForEachWord(_words.data(), first, last_id, [](Word_t& w, Word_t mask) { w &= ~mask; });
 	}
 }
 
@@ -70,12 +140,11 @@ bool Game_Switches::Flip(int switch_id) {
 	if (switch_id <= 0) {
 		return false;
 	}
-	auto& ss = _switches;
-	if (switch_id > static_cast<int>(ss.size())) {
-		ss.resize(switch_id);
-	}
-	ss[switch_id - 1].flip();
-	return ss[switch_id - 1];
+	Resize(switch_id);
+	const int idx = switch_id - 1;
+	auto& word = _words[idx / kWordBits];
+	word ^= Word_t(1) << (idx % kWordBits);
+	return (word >> (idx % kWordBits)) & 1;
 }
 
 void Game_Switches::FlipRange(int first_id, int last_id) {
@@ -83,13 +152,27 @@ void Game_Switches::FlipRange(int first_id, int last_id) {
 		Output::Debug("Invalid flip sw[{},{}]!", first_id, last_id);
 		--_warnings;
 	}
-	auto& ss = _switches;
-	if (last_id > static_cast<int>(ss.size())) {
-		ss.resize(last_id);
+	Resize(last_id);
+	const int first = std::max(0, first_id - 1);
+	if (first >= last_id) {
+		return;
+	}
+	ForEachWord(_words.data(), first, last_id, [](Word_t& w, Word_t mask) { w ^= mask; });
+}
+
+int Game_Switches::CountOn(int first_id, int last_id) const {
+	if (EP_UNLIKELY(ShouldWarn(first_id, last_id))) {
+		Output::Debug("Invalid read sw[{},{}]!", first_id, last_id);
+		--_warnings;
 	}
-	for (int i = std::max(0, first_id - 1); i < last_id; ++i) {
-		ss[i].flip();
+	const int first = std::max(0, first_id - 1);
+	const int last = std::min(last_id, _size);
+	if (first >= last) {
+		return 0;
 	}
+	int count = 0;
+	ForEachWord(_words.data(), first, last, [&count](const Word_t& w, Word_t mask) { count += PopCount(w & mask); });
+	return count;
 }
 
 StringView Game_Switches::GetName(int _id) const {
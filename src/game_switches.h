@@ -19,6 +19,7 @@
 #define EP_GAME_SWITCHES_H
 
 // Headers
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <lcf/data.h>
@@ -27,16 +28,21 @@
 
 /**
  * Game_Switches class
+ *
+ * Switches are stored packed into 64 bit words, range operations work on
+ * whole words.
  */
 class Game_Switches {
 public:
 	using Switches_t = std::vector<bool>;
+	using Word_t = uint64_t;
 	static constexpr int kMaxWarnings = 10;
+	static constexpr int kWordBits = 64;
 
 	Game_Switches();
 
-	void SetData(Switches_t s);
-	const Switches_t& GetData() const;
+	void SetData(const Switches_t& s);
+	Switches_t GetData() const;
 
 	bool Get(int switch_id) const;
 
@@ -46,6 +52,15 @@ public:
 	bool Flip(int switch_id);
 	void FlipRange(int first_id, int last_id);
 
+	/**
+	 * Counts the switches that are ON.
+	 *
+	 * @param first_id first switch to check
+	 * @param last_id last switch to check
+	 * @return number of switches in the range that are ON
+	 */
+	int CountOn(int first_id, int last_id) const;
+
 	StringView GetName(int switch_id) const;
 
 	bool IsValid(int switch_id) const;
@@ -58,20 +73,16 @@ private:
 	bool ShouldWarn(int first_id, int last_id) const;
 	void WarnGet(int variable_id) const;
 
+	/** Grows the storage to hold at least size switches, new switches are OFF */
+	void Resize(int size);
+
 private:
-	Switches_t _switches;
+	std::vector<Word_t> _words;
+	/** Number of switches, bits after it are always 0 */
+	int _size = 0;
 	mutable int _warnings = kMaxWarnings;
 };
 
-
-inline void Game_Switches::SetData(Switches_t s) {
-	_switches = std::move(s);
-}
-
-inline const Game_Switches::Switches_t& Game_Switches::GetData() const {
-	return _switches;
-}
-
 inline int Game_Switches::GetSize() const {
 	return static_cast<int>(lcf::Data::switches.size());
 }
@@ -88,10 +99,11 @@ inline bool Game_Switches::Get(int switch_id) const {
 	if (EP_UNLIKELY(ShouldWarn(switch_id, switch_id))) {
 		WarnGet(switch_id);
 	}
-	if (switch_id <= 0 || switch_id > static_cast<int>(_switches.size())) {
+	if (switch_id <= 0 || switch_id > _size) {
 		return false;
 	}
-	return _switches[switch_id - 1];
+	const int idx = switch_id - 1;
+	return (_words[idx / kWordBits] >> (idx % kWordBits)) & 1;
 }
 
 inline void Game_Switches::SetWarning(int w) {
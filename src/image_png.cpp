@@ -46,27 +46,83 @@ static void on_png_error(png_structp, png_const_charp error_msg) {
 	Output::Warning("libpng: {}", error_msg);
 }
 
-static bool ReadPNGWithReadFunction(png_voidp,png_rw_ptr, bool, int&, int&, void*&);
-static void ReadPalettedData(png_struct*, png_info*, png_uint_32, png_uint_32, bool, uint32_t*);
-static void ReadGrayData(png_struct*, png_info*, png_uint_32, png_uint_32, bool, uint32_t*);
-static void ReadGrayAlphaData(png_struct*, png_info*, png_uint_32, png_uint_32, uint32_t*);
-static void ReadRGBData(png_struct*, png_info*, png_uint_32, png_uint_32, uint32_t*);
-static void ReadRGBAData(png_struct*, png_info*, png_uint_32, png_uint_32, uint32_t*);
+namespace {
+	/** Collects the rows in a malloc'ed R8G8B8A8 buffer */
+	class BufferWriter final : public ImagePNG::RowWriter {
+	public:
+		explicit BufferWriter(void*& pixels) : pixels(pixels) {}
+
+		bool Begin(int w, int h, const uint32_t* pal) override {
+			width = w;
+			height = h;
+			palette = pal;
+			pixels = malloc(w * h * 4);
+			if (!pixels) {
+				Output::Warning("Error allocating PNG pixel buffer.");
+				return false;
+			}
+			return true;
+		}
+
+		void WriteRow(int y, const uint8_t* rgba) override {
+			memcpy(static_cast<uint32_t*>(pixels) + y * width, rgba, width * 4);
+		}
+
+		void WriteIndexedRow(int y, const uint8_t* indices) override {
+			uint32_t* dst = static_cast<uint32_t*>(pixels) + y * width;
+			for (int x = 0; x < width; x++) {
+				dst[x] = palette[indices[x]];
+			}
+		}
+
+		int GetWidth() const { return width; }
+		int GetHeight() const { return height; }
+
+	private:
+		void*& pixels;
+		const uint32_t* palette = nullptr;
+		int width = 0;
+		int height = 0;
+	};
+}
+
+static bool ReadPNGWithReadFunction(png_voidp, png_rw_ptr, bool, ImagePNG::RowWriter&);
+static bool ReadPalette(png_struct*, png_info*, bool, uint32_t*);
 
 bool ImagePNG::ReadPNG(const void* buffer, bool transparent,
 	int& width, int& height, void*& pixels) {
-	return ReadPNGWithReadFunction((png_voidp)&buffer, read_data, transparent, width, height, pixels);
+	pixels = nullptr;
+	BufferWriter writer(pixels);
+	if (!ReadPNGWithReadFunction((png_voidp)&buffer, read_data, transparent, writer)) {
+		return false;
+	}
+	width = writer.GetWidth();
+	height = writer.GetHeight();
+	return true;
 }
 
 bool ImagePNG::ReadPNG(Filesystem_Stream::InputStream& stream, bool transparent,
 	int& width, int& height, void*& pixels) {
-	return ReadPNGWithReadFunction(&stream, read_data_istream, transparent, width, height, pixels);
+	pixels = nullptr;
+	BufferWriter writer(pixels);
+	if (!ReadPNGWithReadFunction(&stream, read_data_istream, transparent, writer)) {
+		return false;
+	}
+	width = writer.GetWidth();
+	height = writer.GetHeight();
+	return true;
 }
 
-static bool ReadPNGWithReadFunction(png_voidp user_data, png_rw_ptr fn, bool transparent,
-					   int& width, int& height, void*& pixels) {
-	pixels = nullptr;
+bool ImagePNG::ReadPNG(const void* buffer, bool transparent, RowWriter& writer) {
+	return ReadPNGWithReadFunction((png_voidp)&buffer, read_data, transparent, writer);
+}
+
+bool ImagePNG::ReadPNG(Filesystem_Stream::InputStream& stream, bool transparent, RowWriter& writer) {
+	return ReadPNGWithReadFunction(&stream, read_data_istream, transparent, writer);
+}
 
+static bool ReadPNGWithReadFunction(png_voidp user_data, png_rw_ptr fn, bool transparent,
+					   ImagePNG::RowWriter& writer) {
 	png_struct *png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, on_png_error, on_png_warning);
 	if (png_ptr == NULL) {
 		Output::Warning("Couldn't allocate PNG structure");
@@ -79,6 +135,10 @@ static bool ReadPNGWithReadFunction(png_voidp user_data, png_rw_ptr fn, bool tra
 		return false;
 	}
 
+	// Declared before setjmp, a longjmp returns into this frame
+	std::vector<uint8_t> row;
+	uint32_t palette[256];
+
 	if (setjmp(png_jmpbuf(png_ptr))) {
 		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
 		return false;
@@ -93,154 +153,101 @@ static bool ReadPNGWithReadFunction(png_voidp user_data, png_rw_ptr fn, bool tra
 	png_get_IHDR(png_ptr, info_ptr, &w, &h,
 				 &bit_depth, &color_type, NULL, NULL, NULL);
 
-	pixels = malloc(w * h * 4);
-	if (!pixels) {
-		Output::Warning("Error allocating PNG pixel buffer.");
-		return false;
-	}
-
+	// Every row is converted to R8G8B8A8 or to 8 bit palette indices
 	switch (color_type) {
 		case PNG_COLOR_TYPE_PALETTE:
-			ReadPalettedData(png_ptr, info_ptr, w, h, transparent, (uint32_t*)pixels);
+			// For transparent images, all the colors are opaque, except the
+			// color with index 0. So we'll need to do index->RGB conversion
+			// on our own.
+			png_set_packing(png_ptr);
+			if (!ReadPalette(png_ptr, info_ptr, transparent, palette)) {
+				png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+				return false;
+			}
 			break;
 		case PNG_COLOR_TYPE_GRAY:
-			ReadGrayData(png_ptr, info_ptr, w, h, transparent, (uint32_t*)pixels);
+			png_set_strip_16(png_ptr);
+			png_set_expand(png_ptr);
+			png_set_gray_to_rgb(png_ptr);
+			png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
 			break;
 		case PNG_COLOR_TYPE_GRAY_ALPHA:
-			ReadGrayAlphaData(png_ptr, info_ptr, w, h, (uint32_t*)pixels);
+			png_set_strip_16(png_ptr);
+			png_set_gray_to_rgb(png_ptr);
 			break;
 		case PNG_COLOR_TYPE_RGB:
-			ReadRGBData(png_ptr, info_ptr, w, h, (uint32_t*)pixels);
+			png_set_strip_16(png_ptr);
+			png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
 			break;
 		case PNG_COLOR_TYPE_RGB_ALPHA:
-			ReadRGBAData(png_ptr, info_ptr, w, h, (uint32_t*)pixels);
+			png_set_strip_16(png_ptr);
 			break;
 	}
-
-	png_read_end(png_ptr, NULL);
-	png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-
-	width = w;
-	height = h;
-	return true;
-}
-
-static void ReadPalettedData(
-	png_struct* png_ptr, png_info* info_ptr,
-	png_uint_32 w, png_uint_32 h,
-	bool transparent,
-	uint32_t* pixels
-) {
-	// For transparent images, all the colors are opaque, except the
-	// color with index 0. So we'll need to do index->RGB conversion
-	// on our own.
-	png_set_packing(png_ptr);
 	png_read_update_info(png_ptr, info_ptr);
 
-	if (!png_get_valid(png_ptr, info_ptr, PNG_INFO_PLTE)) {
-		Output::Warning("Palette PNG without PLTE block");
-		return;
-	}
-
-	png_colorp palette;
-	int num_palette;
-	png_get_PLTE(png_ptr, info_ptr, &palette, &num_palette);
+	const bool paletted = (color_type == PNG_COLOR_TYPE_PALETTE);
+	// Black pixels are transparent
+	const bool gray_key = (color_type == PNG_COLOR_TYPE_GRAY && transparent);
 
-	for (png_uint_32 y = 0; y < h; y++) {
-		// We read the indices (w bytes) into the end of the pixel
-		// data for this row (4w bytes), then scan over them
-		// converting them into RGBA values. Putting them at the end
-		// gives us enough room that we don't overwrite an index
-		// we'll need later with an RGBA value.
-
-		uint32_t* beginning_of_row = pixels + y * w;
-
-		uint8_t* indices = (uint8_t*)beginning_of_row + w * 3;
-		png_read_row(png_ptr, (png_bytep)indices, NULL);
-
-		uint32_t* dst = beginning_of_row;
-		for (png_uint_32 x = 0; x < w; x++, dst++) {
-			uint8_t idx = indices[x];
-			png_color& color = palette[idx];
-			uint8_t alpha = (idx == 0 && transparent) ? 0 : 255;
-			uint8_t rgba[4] = { color.red, color.green, color.blue, alpha };
-			*dst = *(uint32_t*)rgba;
-		}
+	if (!writer.Begin(w, h, paletted ? palette : nullptr)) {
+		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+		return false;
 	}
-}
 
-static void ReadGrayData(
-	png_struct* png_ptr, png_info* info_ptr,
-	png_uint_32 w, png_uint_32 h,
-	bool transparent,
-	uint32_t* pixels
-) {
-	png_set_strip_16(png_ptr);
-	png_set_expand(png_ptr);
-	png_set_gray_to_rgb(png_ptr);
-	png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
-	png_read_update_info(png_ptr, info_ptr);
+	row.resize(w * 4);
 
 	for (png_uint_32 y = 0; y < h; y++) {
-		png_bytep dst = (png_bytep) pixels + y * w * 4;
-		png_read_row(png_ptr, dst, NULL);
-	}
+		png_read_row(png_ptr, row.data(), NULL);
 
-	// Black pixels are transparent
-	if (transparent) {
-		uint8_t ck1[4] = {0, 0, 0, 255};
-		uint8_t ck2[4] = {0, 0, 0,   0};
-		uint32_t srckey = *(uint32_t*)ck1;
-		uint32_t dstkey = *(uint32_t*)ck2;
-		uint32_t* p = (uint32_t*) pixels;
-		for (unsigned i = 0; i < w * h; i++, p++)
-			if (*p == srckey)
-				*p = dstkey;
-	}
-}
-
-static void ReadGrayAlphaData(
-	png_struct* png_ptr, png_info* info_ptr,
-	png_uint_32 w, png_uint_32 h,
-	uint32_t* pixels
-) {
-	png_set_strip_16(png_ptr);
-	png_set_gray_to_rgb(png_ptr);
-	png_read_update_info(png_ptr, info_ptr);
+		if (paletted) {
+			writer.WriteIndexedRow(y, row.data());
+			continue;
+		}
 
-	for (png_uint_32 y = 0; y < h; y++) {
-		png_bytep dst = (png_bytep) pixels + y * w * 4;
-		png_read_row(png_ptr, dst, NULL);
+		if (gray_key) {
+			uint8_t* p = row.data();
+			for (png_uint_32 x = 0; x < w; x++, p += 4) {
+				if (p[0] == 0 && p[1] == 0 && p[2] == 0 && p[3] == 255) {
+					p[3] = 0;
+				}
+			}
+		}
+		writer.WriteRow(y, row.data());
 	}
-}
 
-static void ReadRGBData(
-	png_struct* png_ptr, png_info* info_ptr,
-	png_uint_32 w, png_uint_32 h,
-	uint32_t* pixels
-) {
-	png_set_strip_16(png_ptr);
-	png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
-	png_read_update_info(png_ptr, info_ptr);
+	png_read_end(png_ptr, NULL);
+	png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
 
-	for (png_uint_32 y = 0; y < h; y++) {
-		png_bytep dst = (png_bytep) pixels + y * w * 4;
-		png_read_row(png_ptr, dst, NULL);
-	}
+	return true;
 }
 
-static void ReadRGBAData(
+static bool ReadPalette(
 	png_struct* png_ptr, png_info* info_ptr,
-	png_uint_32 w, png_uint_32 h,
-	uint32_t* pixels
+	bool transparent,
+	uint32_t* palette
 ) {
-	png_set_strip_16(png_ptr);
-	png_read_update_info(png_ptr, info_ptr);
+	if (!png_get_valid(png_ptr, info_ptr, PNG_INFO_PLTE)) {
+		Output::Warning("Palette PNG without PLTE block");
+		return false;
+	}
 
-	for (png_uint_32 y = 0; y < h; y++) {
-		png_bytep dst = (png_bytep) pixels + y * w * 4;
-		png_read_row(png_ptr, dst, NULL);
+	png_colorp png_palette;
+	int num_palette;
+	png_get_PLTE(png_ptr, info_ptr, &png_palette, &num_palette);
+
+	for (int i = 0; i < 256; i++) {
+		uint8_t rgba[4] = { 0, 0, 0, 255 };
+		if (i < num_palette) {
+			rgba[0] = png_palette[i].red;
+			rgba[1] = png_palette[i].green;
+			rgba[2] = png_palette[i].blue;
+		}
+		if (i == 0 && transparent) {
+			rgba[3] = 0;
+		}
+		memcpy(&palette[i], rgba, sizeof(rgba));
 	}
+	return true;
 }
 
 static void write_data(png_structp out_ptr, png_bytep data, png_size_t len) {
@@ -18,11 +18,51 @@
 #ifndef EP_IMAGE_PNG_H
 #define EP_IMAGE_PNG_H
 
+#include <cstdint>
 #include "filesystem_stream.h"
 
 namespace ImagePNG {
+	/**
+	 * Destination of a streamed PNG decode.
+	 * The decoder reports the image size first and then hands out every row
+	 * exactly once, so rows can be converted directly into their final storage.
+	 */
+	class RowWriter {
+	public:
+		virtual ~RowWriter() = default;
+
+		/**
+		 * Called after the PNG header was read.
+		 *
+		 * @param width image width
+		 * @param height image height
+		 * @param palette 256 colors in R8G8B8A8 byte order for paletted images,
+		 *                all rows are passed to WriteIndexedRow then. nullptr otherwise.
+		 * @return false to abort decoding
+		 */
+		virtual bool Begin(int width, int height, const uint32_t* palette) = 0;
+
+		/**
+		 * Receives a row as R8G8B8A8 bytes, only valid during the call.
+		 *
+		 * @param y row number
+		 * @param rgba pixel data of the row
+		 */
+		virtual void WriteRow(int y, const uint8_t* rgba) = 0;
+
+		/**
+		 * Receives a row as palette indices, only valid during the call.
+		 *
+		 * @param y row number
+		 * @param indices palette index of every pixel of the row
+		 */
+		virtual void WriteIndexedRow(int y, const uint8_t* indices) = 0;
+	};
+
 	bool ReadPNG(const void* buffer, bool transparent, int& width, int& height, void*& pixels);
 	bool ReadPNG(Filesystem_Stream::InputStream& is, bool transparent, int& width, int& height, void*& pixels);
+	bool ReadPNG(const void* buffer, bool transparent, RowWriter& writer);
+	bool ReadPNG(Filesystem_Stream::InputStream& is, bool transparent, RowWriter& writer);
 	bool WritePNG(Filesystem_Stream::OutputStream& os, uint32_t width, uint32_t height, uint32_t* data);
 }
 
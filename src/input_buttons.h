@@ -61,6 +61,8 @@ namespace Input {
 		DEBUG_MENU,
 		DEBUG_THROUGH,
 		DEBUG_SAVE,
+		DEBUG_QUICK_SAVE,
+		DEBUG_QUICK_LOAD,
 		TOGGLE_FPS,
 		TAKE_SCREENSHOT,
 		SHOW_LOG,
@@ -101,6 +103,8 @@ namespace Input {
 		"DEBUG_MENU",
 		"DEBUG_THROUGH",
 		"DEBUG_SAVE",
+		"DEBUG_QUICK_SAVE",
+		"DEBUG_QUICK_LOAD",
 		"TOGGLE_FPS",
 		"TAKE_SCREENSHOT",
 		"SHOW_LOG",
@@ -140,6 +144,8 @@ namespace Input {
 		"(Test Play) Open the debug menu",
 		"(Test Play) Walk through walls",
 		"(Test Play) Open the save menu",
+		"(Test Play) Store a quick save in memory",
+		"(Test Play) Restore the quick save",
 		"Open the settings menu",
 		"Toggle the FPS display",
 		"Take a screenshot",
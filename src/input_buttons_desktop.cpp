@@ -73,6 +73,8 @@ Input::ButtonMappingArray Input::GetDefaultButtonMappings() {
 		{DEBUG_THROUGH, Keys::LCTRL},
 		{DEBUG_THROUGH, Keys::RCTRL},
 		{DEBUG_SAVE, Keys::F11},
+		{DEBUG_QUICK_SAVE, Keys::F6},
+		{DEBUG_QUICK_LOAD, Keys::F7},
 		{TAKE_SCREENSHOT, Keys::F10},
 		{TOGGLE_FPS, Keys::F2},
 		{SHOW_LOG, Keys::F3},
@@ -0,0 +1,205 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <tuple>
+#include <unordered_map>
+#include "interpreter_profiler.h"
+#include "filefinder.h"
+#include "output.h"
+
+namespace InterpreterProfiler {
+namespace detail {
+bool enabled = false;
+}
+}
+
+namespace {
+	using InterpreterProfiler::Entry;
+	using InterpreterProfiler::Source;
+
+	struct Key {
+		Source source;
+		int owner_id;
+		int page_id;
+		/** Tells frames of unknown origin apart from their caller, 0 otherwise */
+		int depth;
+		int index;
+		int code;
+
+		bool operator==(const Key& o) const {
+			return source == o.source && owner_id == o.owner_id && page_id == o.page_id
+				&& depth == o.depth && index == o.index && code == o.code;
+		}
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key& key) const {
+			size_t h = static_cast<size_t>(key.source);
+			for (int v: { key.owner_id, key.page_id, key.depth, key.index, key.code }) {
+				h = h * 31 + std::hash<int>()(v);
+			}
+			return h;
+		}
+	};
+
+	struct Stat {
+		int64_t count = 0;
+		Game_Clock::duration time = {};
+		int max_depth = 0;
+	};
+
+	std::unordered_map<Key, Stat, KeyHash> stats;
+	std::string report_path;
+
+	/** Owner of the innermost Scope */
+	Source scope_source = Source::Foreground;
+	int scope_owner_id = 0;
+	int scope_page_id = 0;
+	bool in_scope = false;
+}
+
+void InterpreterProfiler::Start(std::string path) {
+	report_path = std::move(path);
+	detail::enabled = true;
+}
+
+InterpreterProfiler::Scope::Scope(Source source, int owner_id, int page_id)
+	: source(scope_source), owner_id(scope_owner_id), page_id(scope_page_id), active(in_scope)
+{
+	scope_source = source;
+	scope_owner_id = owner_id;
+	scope_page_id = page_id;
+	in_scope = true;
+}
+
+InterpreterProfiler::Scope::~Scope() {
+	scope_source = source;
+	scope_owner_id = owner_id;
+	scope_page_id = page_id;
+	in_scope = active;
+}
+
+void InterpreterProfiler::Record(int event_id, const Owner& frame_owner, int depth, int index, int code, Game_Clock::duration time) {
+	Key key;
+	if (frame_owner.source != Source::Foreground) {
+		key = { frame_owner.source, frame_owner.id, frame_owner.page_id, 0, index, code };
+	} else if (in_scope) {
+		key = { scope_source, scope_owner_id, scope_page_id, depth, index, code };
+	} else {
+		key = { Source::Foreground, event_id, 0, depth, index, code };
+	}
+
+	auto& stat = stats[key];
+	++stat.count;
+	stat.time += time;
+	stat.max_depth = std::max(stat.max_depth, depth);
+}
+
+size_t InterpreterProfiler::GetNumEntries() {
+	return stats.size();
+}
+
+std::vector<Entry> InterpreterProfiler::GetEntries() {
+	std::vector<Entry> entries;
+	entries.reserve(stats.size());
+
+	for (const auto& it: stats) {
+		Entry entry;
+		entry.source = it.first.source;
+		entry.owner_id = it.first.owner_id;
+		entry.page_id = it.first.page_id;
+		entry.depth = it.second.max_depth;
+		entry.index = it.first.index;
+		entry.code = it.first.code;
+		entry.count = it.second.count;
+		entry.time = it.second.time;
+		entries.push_back(entry);
+	}
+
+	// Ties are ordered by location so the report is stable
+	std::sort(entries.begin(), entries.end(), [](const Entry& l, const Entry& r) {
+		if (l.time != r.time) {
+			return l.time > r.time;
+		}
+		if (l.count != r.count) {
+			return l.count > r.count;
+		}
+		return std::tie(l.source, l.owner_id, l.page_id, l.depth, l.index)
+			< std::tie(r.source, r.owner_id, r.page_id, r.depth, r.index);
+	});
+
+	return entries;
+}
+
+void InterpreterProfiler::Reset() {
+	stats.clear();
+}
+
+const char* InterpreterProfiler::SourceName(Source source) {
+	switch (source) {
+		case Source::Foreground:
+			return "foreground";
+		case Source::CommonEvent:
+			return "common";
+		case Source::MapEvent:
+			return "map";
+	}
+	return "";
+}
+
+bool InterpreterProfiler::WriteReport(std::ostream& os) {
+	using us = std::chrono::duration<double, std::micro>;
+
+	os << "source\tid\tpage\tdepth\tindex\tcode\tcount\ttotal_us\tavg_us\n";
+	for (const auto& entry: GetEntries()) {
+		const double total = us(entry.time).count();
+		os << SourceName(entry.source) << '\t' << entry.owner_id << '\t' << entry.page_id << '\t'
+			<< entry.depth << '\t' << entry.index << '\t' << entry.code << '\t' << entry.count << '\t'
+			<< total << '\t' << total / entry.count << '\n';
+	}
+	os.flush();
+
+	return static_cast<bool>(os);
+}
+
+void InterpreterProfiler::Quit() {
+	if (!detail::enabled) {
+		return;
+	}
+	detail::enabled = false;
+
+	if (report_path.empty()) {
+		return;
+	}
+
+	auto os = FileFinder::OpenOutputStream(report_path);
+	if (!os) {
+		Output::Warning("Failed to open {} for writing: {}", report_path, strerror(errno));
+		return;
+	}
+	if (WriteReport(os)) {
+		Output::Debug("Wrote event profile to {}", report_path);
+	} else {
+		Output::Warning("Failed writing event profile to {}", report_path);
+	}
+}
@@ -0,0 +1,151 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_INTERPRETER_PROFILER_H
+#define EP_INTERPRETER_PROFILER_H
+
+// Headers
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "game_clock.h"
+
+/**
+ * Opt-in profiler for event commands.
+ *
+ * Counts how often every event command runs and how much wall time it takes.
+ * Commands are attributed to the event their command list belongs to, so a
+ * called common event or map event page is profiled under its own ID, no
+ * matter who called it. Frames of unknown origin, like frames restored from
+ * a savegame, are attributed to the event that owns the interpreter and are
+ * told apart by the call depth.
+ *
+ * The profiler is disabled by default.
+ */
+namespace InterpreterProfiler {
+
+/** Kind of event owning the profiled interpreter */
+enum class Source : uint8_t {
+	/** Foreground, parallel battle and any other interpreter outside of a scope */
+	Foreground,
+	CommonEvent,
+	MapEvent
+};
+
+/** Event a command list belongs to */
+struct Owner {
+	/** Foreground when unknown */
+	Source source = Source::Foreground;
+	/** Map event ID or common event ID */
+	int id = 0;
+	/** Page of a map event, 0 otherwise */
+	int page_id = 0;
+};
+
+/** Accumulated statistics of one event command */
+struct Entry {
+	Source source = Source::Foreground;
+	/** Map event ID, common event ID or the event ID of the foreground interpreter */
+	int owner_id = 0;
+	/** Page of a map event, 0 otherwise */
+	int page_id = 0;
+	/** Deepest call stack depth the command ran at */
+	int depth = 0;
+	/** Index of the command in its command list */
+	int index = 0;
+	/** Event command code */
+	int code = 0;
+	/** Number of executions */
+	int64_t count = 0;
+	/** Total wall time spent */
+	Game_Clock::duration time = {};
+};
+
+namespace detail {
+extern bool enabled;
+}
+
+/** @return whether commands are profiled */
+inline bool IsEnabled() {
+	return detail::enabled;
+}
+
+/**
+ * Enables profiling.
+ *
+ * @param report_path file written by Quit, empty to not write a report
+ */
+void Start(std::string report_path);
+
+/**
+ * Attributes all commands of unknown origin recorded during its lifetime
+ * to an event. Scopes nest, the previous owner is restored on destruction.
+ */
+class Scope {
+public:
+	Scope(Source source, int owner_id, int page_id);
+	~Scope();
+
+	Scope(const Scope&) = delete;
+	Scope& operator=(const Scope&) = delete;
+
+private:
+	Source source;
+	int owner_id;
+	int page_id;
+	bool active;
+};
+
+/**
+ * Records one execution of an event command.
+ *
+ * @param event_id event ID of the interpreter, used for unknown frames outside of a scope
+ * @param frame_owner event the command list belongs to, source Foreground when unknown
+ * @param depth call stack depth of the command
+ * @param index index of the command
+ * @param code code of the command
+ * @param time wall time the command took
+ */
+void Record(int event_id, const Owner& frame_owner, int depth, int index, int code, Game_Clock::duration time);
+
+/** @return number of distinct commands recorded */
+size_t GetNumEntries();
+
+/** @return all entries sorted by total time, highest first */
+std::vector<Entry> GetEntries();
+
+/** Discards all recorded statistics */
+void Reset();
+
+/**
+ * Writes all entries as a tab separated table sorted by total time.
+ *
+ * @param os stream to write to
+ * @return whether writing succeeded
+ */
+bool WriteReport(std::ostream& os);
+
+/** @return name of a source as used in the report */
+const char* SourceName(Source source);
+
+/** Writes the report passed to Start and disables profiling */
+void Quit();
+
+}
+
+#endif
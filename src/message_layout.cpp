@@ -0,0 +1,123 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include "message_layout.h"
+#include "compiler.h"
+#include "font.h"
+#include "game_message.h"
+#include "utils.h"
+
+namespace {
+	using Type = MessageRun::Type;
+
+	// RPG_RT compatible for half-width (6) and full-width (12)
+	// generalizes the algo for even bigger glyphs
+	uint8_t GetWidth(int w) {
+		return static_cast<uint8_t>(std::min((w > 0) ? (w - 1) / 6 + 1 : 0, 255));
+	}
+
+	Type GetEscapeType(char32_t ch) {
+		switch (ch) {
+			case 'c':
+			case 'C':
+				return Type::Color;
+			case 's':
+			case 'S':
+				return Type::Speed;
+			case '_':
+				return Type::HalfSpace;
+			case '$':
+				return Type::Gold;
+			case '!':
+				return Type::Pause;
+			case '^':
+				return Type::KillPage;
+			case '>':
+				return Type::InstantStart;
+			case '<':
+				return Type::InstantStop;
+			case '.':
+				return Type::QuickSleep;
+			case '|':
+				return Type::Sleep;
+			default:
+				return Type::Unknown;
+		}
+	}
+}
+
+const char* MessageLayout::LayoutPage(const char* iter, const char* end, uint32_t escape_char, const Font& font, std::vector<MessageRun>& runs) {
+	runs.clear();
+
+	while (iter != end) {
+		auto tret = Utils::TextNext(iter, end, escape_char);
+		iter = tret.next;
+
+		if (EP_UNLIKELY(!tret)) {
+			continue;
+		}
+
+		MessageRun run;
+		const auto ch = tret.ch;
+
+		if (tret.is_exfont) {
+			run.type = Type::ExFont;
+			run.value = static_cast<int32_t>(ch);
+			run.width = GetWidth(Font::exfont->GetSize(ch).width);
+		} else if (ch == '\f') {
+			run.type = Type::PageEnd;
+			run.value = (iter != end);
+		} else if (ch == '\n') {
+			run.type = Type::NewLine;
+			run.value = (iter != end && *iter == '\f');
+		} else if (Utils::IsControlCharacter(ch)) {
+			// control characters not handled
+			continue;
+		} else if (tret.is_escape && ch != escape_char) {
+			run.type = GetEscapeType(ch);
+			if (run.type == Type::Color) {
+				auto pres = Game_Message::ParseColor(iter, end, escape_char, true);
+				iter = pres.next;
+				run.value = pres.value;
+			} else if (run.type == Type::Speed) {
+				auto pres = Game_Message::ParseSpeed(iter, end, escape_char, true);
+				iter = pres.next;
+				run.value = pres.value;
+			} else if (run.type == Type::HalfSpace) {
+				run.value = font.GetSize(" ").width / 2;
+			}
+		} else {
+			run.type = Type::Glyph;
+			run.value = static_cast<int32_t>(ch);
+			run.width = GetWidth(font.GetSize(ch).width);
+		}
+
+		// Used for the typing speed, RPG_RT only looks at the following bytes
+		run.last_for_line = (iter != end && *iter == '\n');
+		run.last_for_page = (end - iter) < 2 || (*iter == '\n' && *(iter + 1) == '\f');
+
+		runs.push_back(run);
+
+		if (run.type == Type::PageEnd) {
+			break;
+		}
+	}
+
+	return iter;
+}
@@ -0,0 +1,95 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_MESSAGE_LAYOUT_H
+#define EP_MESSAGE_LAYOUT_H
+
+// Headers
+#include <cstdint>
+#include <vector>
+
+class Font;
+
+/**
+ * One element of a laid out message page.
+ * Control codes are already parsed, glyphs are already measured.
+ */
+struct MessageRun {
+	enum class Type : uint8_t {
+		/** Glyph of the message font, value is the character */
+		Glyph,
+		/** Glyph of the ExFont, value is the ExFont index */
+		ExFont,
+		/** Line break, value is 1 when a page break follows */
+		NewLine,
+		/** Page break, the last run of every page, value is 1 when more text follows */
+		PageEnd,
+		/** \c[n], value is the parsed color */
+		Color,
+		/** \s[n], value is the parsed speed */
+		Speed,
+		/** \_, value is the width of the space in pixels */
+		HalfSpace,
+		/** \$ */
+		Gold,
+		/** \! */
+		Pause,
+		/** \^ */
+		KillPage,
+		/** \> */
+		InstantStart,
+		/** \< */
+		InstantStop,
+		/** \. */
+		QuickSleep,
+		/** \| */
+		Sleep,
+		/** Any other escape sequence */
+		Unknown
+	};
+
+	Type type = Type::Glyph;
+	/** The next byte is a line break */
+	bool last_for_line = false;
+	/** The text ends or the next bytes are a line break and a page break */
+	bool last_for_page = false;
+	/** Width of glyphs in half width units, 6 pixel per unit */
+	uint8_t width = 0;
+	/** Character, parameter or width, depending on the type */
+	int32_t value = 0;
+};
+
+namespace MessageLayout {
+
+/**
+ * Parses the next page of message text into runs.
+ *
+ * Text inserting commands (\n[] and \v[]) must already be applied,
+ * \c[] and \s[] may still contain variable references.
+ *
+ * @param iter start of the page
+ * @param end end of the whole message text
+ * @param escape_char the escape character
+ * @param font font used to measure glyphs
+ * @param runs receives the runs of the page, cleared first
+ * @return start of the next page, end when this was the last page
+ */
+const char* LayoutPage(const char* iter, const char* end, uint32_t escape_char, const Font& font, std::vector<MessageRun>& runs);
+
+}
+
+#endif
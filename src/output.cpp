@@ -26,6 +26,20 @@
 #include <thread>
 #include <chrono>
 
+#include "system.h"
+#ifdef HAVE_THREADS
+#  include <atomic>
+#  include <condition_variable>
+#  include <mutex>
+#  include <system_error>
+#  if (defined(__unix__) || defined(__APPLE__)) && !defined(EMSCRIPTEN) && !defined(__ANDROID__) \
+		&& !defined(__SWITCH__) && !defined(_3DS) && !defined(PSP2)
+#    define EP_OUTPUT_ATFORK
+#    include <new>
+#    include <pthread.h>
+#  endif
+#endif
+
 #include "graphics.h"
 
 #ifdef GEKKO
@@ -69,17 +83,8 @@ namespace {
 
 	Filesystem_Stream::OutputStream LOG_FILE;
 	bool init = false;
-
-	std::ostream& output_time() {
-		if (!init) {
-			LOG_FILE = FileFinder::OpenOutputStream(FileFinder::MakePath(Main_Data::GetSavePath(), OUTPUT_FILENAME), std::ios_base::out | std::ios_base::app);
-			init = true;
-		}
-		std::time_t t = std::time(NULL);
-		char timestr[100];
-		strftime(timestr, 100, "[%Y-%m-%d %H:%M:%S] ", std::localtime(&t));
-		return LOG_FILE << timestr;
-	}
+	/** Log file, set once when the save path is known */
+	std::string log_path;
 
 	bool ignore_pause = false;
 
@@ -91,6 +96,289 @@ namespace {
 		LogLevel lvl = {};
 	} last_message;
 
+	/** A message waiting for the log writer */
+	struct LogRecord {
+		LogRecord* next = nullptr;
+		LogLevel lvl = {};
+		std::time_t time = {};
+		/** false when the message was logged before the save path was known */
+		bool to_file = false;
+		std::string msg;
+	};
+
+#ifdef HAVE_THREADS
+	/** Held while a batch is written, so that fork() never copies a half written batch */
+	std::mutex write_mutex;
+#endif
+
+	void WriteTime(std::time_t t) {
+		char timestr[100];
+		strftime(timestr, 100, "[%Y-%m-%d %H:%M:%S] ", std::localtime(&t));
+		LOG_FILE << timestr;
+	}
+
+	/**
+	 * Writes a batch of messages to the log file and to the console.
+	 * Both are flushed once per batch and not once per message.
+	 *
+	 * @param rec first record of a list in logging order, deleted afterwards
+	 */
+	void WriteRecords(LogRecord* rec) {
+#ifdef HAVE_THREADS
+		std::lock_guard<std::mutex> write_lock(write_mutex);
+#endif
+		std::string console;
+
+		while (rec) {
+			const char* prefix = GetLogPrefix(rec->lvl);
+			const auto& msg = rec->msg;
+			// Skip logging to file in the browser
+#ifndef EMSCRIPTEN
+			if (rec->to_file) {
+				// Only write to file when project path is initialized
+				// (happens after parsing the command line)
+				if (!init) {
+					LOG_FILE = FileFinder::OpenOutputStream(log_path, std::ios_base::out | std::ios_base::app);
+					init = true;
+				}
+				for (std::string& log : log_buffer) {
+					WriteTime(rec->time);
+					LOG_FILE << log << '\n';
+				}
+				log_buffer.clear();
+
+				// Every new message is written once to the file.
+				// When it is repeated increment a counter until a different message appears,
+				// then write the buffered message with the counter.
+				if (msg == last_message.msg) {
+					last_message.repeat++;
+				} else {
+					if (last_message.repeat > 0) {
+						WriteTime(rec->time);
+						LOG_FILE << GetLogPrefix(last_message.lvl) << last_message.msg << " [" << last_message.repeat + 1 << "x]\n";
+					}
+					WriteTime(rec->time);
+					LOG_FILE << prefix << msg << '\n';
+					last_message.repeat = 0;
+					last_message.msg = msg;
+					last_message.lvl = rec->lvl;
+				}
+			} else {
+				// buffer log messages until file system is ready
+				log_buffer.push_back(prefix + msg);
+			}
+#endif
+
+#ifdef __ANDROID__
+			__android_log_print(rec->lvl == LogLevel::Error ? ANDROID_LOG_ERROR : ANDROID_LOG_INFO, "EasyRPG Player", "%s", msg.c_str());
+#else
+			console += prefix;
+			console += msg;
+			console += '\n';
+#endif
+
+			auto* next = rec->next;
+			delete rec;
+			rec = next;
+		}
+
+		if (LOG_FILE) {
+			LOG_FILE.flush();
+		}
+		if (!console.empty()) {
+			std::cerr << console;
+			std::cerr.flush();
+		}
+	}
+
+#ifdef HAVE_THREADS
+	/**
+	 * Messages are pushed by any thread onto a lock-free stack and written by
+	 * a worker thread in batches. The mutex is only taken by the worker and
+	 * for waiting, never for logging a message.
+	 */
+	std::atomic<LogRecord*> pending{nullptr};
+	/** Number of records pushed and written, for Flush */
+	std::atomic<uint64_t> num_pushed{0};
+	uint64_t num_written = 0;
+
+	/** Upper bound for the latency of a message missed by a wakeup */
+	constexpr auto writer_interval = 50ms;
+
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::thread worker;
+	std::atomic<bool> running{false};
+	bool quit = false;
+	/** Set by Output::Quit, afterwards messages are written directly */
+	bool stopped = false;
+
+	/** @return all pushed records in logging order */
+	LogRecord* TakeRecords() {
+		LogRecord* rec = pending.exchange(nullptr, std::memory_order_acquire);
+
+		// The stack is newest first
+		LogRecord* ordered = nullptr;
+		while (rec) {
+			auto* next = rec->next;
+			rec->next = ordered;
+			ordered = rec;
+			rec = next;
+		}
+		return ordered;
+	}
+
+	void WorkerLoop() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			cv.wait_for(lock, writer_interval, []() {
+				return quit || pending.load(std::memory_order_relaxed) != nullptr;
+			});
+			const bool stop = quit;
+
+			lock.unlock();
+			uint64_t count = 0;
+			auto* rec = TakeRecords();
+			for (auto* r = rec; r; r = r->next) {
+				++count;
+			}
+			WriteRecords(rec);
+			lock.lock();
+
+			num_written += count;
+			cv.notify_all();
+
+			if (stop && pending.load(std::memory_order_relaxed) == nullptr) {
+				return;
+			}
+		}
+	}
+
+	void StopWorker() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+			stopped = true;
+			cv.notify_all();
+		}
+		if (worker.joinable()) {
+			worker.join();
+		}
+		running = false;
+
+		// Messages pushed while the worker was stopping
+		WriteRecords(TakeRecords());
+	}
+
+	/** Joins the worker when exit() is called without Output::Quit */
+	struct WorkerGuard {
+		~WorkerGuard() {
+			StopWorker();
+		}
+	} worker_guard;
+
+#ifdef EP_OUTPUT_ATFORK
+	/**
+	 * A child process only has a copy of the thread which called fork():
+	 * the worker is gone and its locks may be held. The handlers make fork()
+	 * wait for the current batch and the child logs synchronously.
+	 */
+	void ForkPrepare() {
+		mutex.lock();
+		write_mutex.lock();
+	}
+
+	void ForkParent() {
+		write_mutex.unlock();
+		mutex.unlock();
+	}
+
+	void ForkChild() {
+		write_mutex.unlock();
+		mutex.unlock();
+
+		// Waiters of the parent are not in this process
+		new (&cv) std::condition_variable();
+		// Forget the handle of the parent's worker, it cannot be joined here
+		new (&worker) std::thread();
+		running = false;
+		quit = true;
+		stopped = true;
+
+		// Messages still queued belong to the parent and are written there
+		auto* rec = pending.exchange(nullptr);
+		while (rec) {
+			auto* next = rec->next;
+			delete rec;
+			rec = next;
+		}
+		num_pushed = 0;
+		num_written = 0;
+	}
+#endif
+
+	void PushRecord(LogRecord* rec) {
+		if (!running.load(std::memory_order_acquire)) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if (stopped) {
+				WriteRecords(rec);
+				return;
+			}
+			if (!running) {
+#ifdef EP_OUTPUT_ATFORK
+				static bool atfork_registered = false;
+				if (!atfork_registered) {
+					pthread_atfork(ForkPrepare, ForkParent, ForkChild);
+					atfork_registered = true;
+				}
+#endif
+				try {
+					worker = std::thread(WorkerLoop);
+				} catch (const std::system_error&) {
+					// No threads on this platform, log synchronously from now on
+					stopped = true;
+					WriteRecords(rec);
+					return;
+				}
+				running = true;
+			}
+		}
+
+		// The record belongs to the worker as soon as it is pushed
+		LogRecord* head = pending.load(std::memory_order_relaxed);
+		do {
+			rec->next = head;
+		} while (!pending.compare_exchange_weak(head, rec, std::memory_order_release, std::memory_order_relaxed));
+		num_pushed.fetch_add(1, std::memory_order_relaxed);
+
+		// The worker takes the whole stack, so it only needs a wakeup for the first message
+		if (head == nullptr) {
+			cv.notify_all();
+		}
+	}
+
+	/** Waits until all messages logged so far are written */
+	void FlushRecords() {
+		const auto target = num_pushed.load();
+		std::unique_lock<std::mutex> lock(mutex);
+		if (!worker.joinable()) {
+			return;
+		}
+		cv.notify_all();
+		cv.wait(lock, [&]() { return num_written >= target || !worker.joinable(); });
+	}
+#else
+	void PushRecord(LogRecord* rec) {
+		WriteRecords(rec);
+	}
+
+	void FlushRecords() {
+	}
+
+	void StopWorker() {
+	}
+#endif
+
 #ifdef GEKKO
 	/* USBGecko Debugging on Wii */
 	bool usbgecko = false;
@@ -133,44 +421,21 @@ void Output::IgnorePause(bool const val) {
 }
 
 static void WriteLog(LogLevel lvl, std::string const& msg, Color const& c = Color()) {
-	const char* prefix = GetLogPrefix(lvl);
-	// Skip logging to file in the browser
+	auto* rec = new LogRecord();
+	rec->lvl = lvl;
+	rec->time = std::time(nullptr);
+	rec->msg = msg;
 #ifndef EMSCRIPTEN
 	if (!Main_Data::GetSavePath().empty()) {
-		// Only write to file when project path is initialized
-		// (happens after parsing the command line)
-		for (std::string& log : log_buffer) {
-			output_time() << log << std::endl;
-		}
-		log_buffer.clear();
-
-		// Every new message is written once to the file.
-		// When it is repeated increment a counter until a different message appears,
-		// then write the buffered message with the counter.
-		if (msg == last_message.msg) {
-			last_message.repeat++;
-		} else {
-			if (last_message.repeat > 0) {
-				output_time() << GetLogPrefix(last_message.lvl) << last_message.msg << " [" << last_message.repeat + 1 << "x]" << std::endl;
-				output_time() << prefix << msg << std::endl;
-			} else {
-				output_time() << prefix << msg << std::endl;
-			}
-			last_message.repeat = 0;
-			last_message.msg = msg;
-			last_message.lvl = lvl;
+		if (log_path.empty()) {
+			log_path = FileFinder::MakePath(Main_Data::GetSavePath(), OUTPUT_FILENAME);
 		}
-	} else {
-		// buffer log messages until file system is ready
-		log_buffer.push_back(prefix + msg);
+		rec->to_file = true;
 	}
 #endif
 
-#ifdef __ANDROID__
-	__android_log_print(lvl == LogLevel::Error ? ANDROID_LOG_ERROR : ANDROID_LOG_INFO, "EasyRPG Player", "%s", msg.c_str());
-#else
-	std::cerr << prefix << msg << std::endl;
-#endif
+	// File and console output happen on the log writer
+	PushRecord(rec);
 
 	if (lvl != LogLevel::Debug && lvl != LogLevel::Error) {
 		Graphics::GetMessageOverlay().AddMessage(msg, c);
@@ -208,8 +473,12 @@ static void HandleErrorOutput(const std::string& err) {
 }
 
 void Output::Quit() {
+	// Write all pending messages before trimming the file
+	StopWorker();
+
 	if (LOG_FILE) {
 		LOG_FILE.clear();
+		LOG_FILE.flush();
 	}
 
 	int log_size = 1024 * 100;
@@ -270,6 +539,8 @@ void Output::ToggleLog() {
 
 void Output::ErrorStr(std::string const& err) {
 	WriteLog(LogLevel::Error, err);
+	// The player closes afterwards, make sure the error is logged
+	FlushRecords();
 	static bool recursive_call = false;
 	if (!recursive_call && DisplayUi) {
 		recursive_call = true;
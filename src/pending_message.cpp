@@ -10,6 +10,8 @@
 #include <cassert>
 #include <cctype>
 #include <algorithm>
+#include <iterator>
+#include <fmt/format.h>
 
 static void RemoveControlChars(std::string& s) {
 	// RPG_RT ignores any control characters within messages.
@@ -74,6 +76,7 @@ std::string PendingMessage::ApplyTextInsertingCommands(std::string input, uint32
 		return input;
 	}
 
+	// Only filled when something is substituted, other escape sequences are left for Window_Message
 	std::string output;
 
 	auto iter = input.data();
@@ -92,8 +95,7 @@ std::string PendingMessage::ApplyTextInsertingCommands(std::string input, uint32
 			break;
 		}
 
-		output.append(start_copy, iter);
-		start_copy = iter;
+		const auto escape_start = iter;
 
 		iter = ret.next;
 		if (iter == end) {
@@ -108,11 +110,17 @@ std::string PendingMessage::ApplyTextInsertingCommands(std::string input, uint32
 			iter = parse_ret.next;
 			int value = parse_ret.value;
 
+			if (output.empty()) {
+				output.reserve(input.size() + 16);
+			}
+			output.append(start_copy, escape_start);
+
 			const auto* actor = Main_Data::game_actors->GetActor(value);
 			if (!actor) {
 				Output::Warning("Invalid Actor Id {} in message text", value);
 			} else{
-				output.append(ToString(actor->GetName()));
+				const auto name = actor->GetName();
+				output.append(name.data(), name.size());
 			}
 
 			start_copy = iter;
@@ -121,8 +129,13 @@ std::string PendingMessage::ApplyTextInsertingCommands(std::string input, uint32
 			iter = parse_ret.next;
 			int value = parse_ret.value;
 
+			if (output.empty()) {
+				output.reserve(input.size() + 16);
+			}
+			output.append(start_copy, escape_start);
+
 			int variable_value = Main_Data::game_variables->Get(value);
-			output.append(std::to_string(variable_value));
+			fmt::format_to(std::back_inserter(output), "{}", variable_value);
 
 			start_copy = iter;
 		}
@@ -0,0 +1,72 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_PIXEL_OPS_H
+#define EP_PIXEL_OPS_H
+
+// Headers
+#include <cstdint>
+#include "bitmap.h"
+
+/**
+ * Helpers for drawing directly into premultiplied 32 bit bitmaps.
+ * Only valid for bitmaps where Bitmap::HasPixelFormatLayout is true.
+ */
+namespace PixelOps {
+	/**
+	 * Multiplies all four 8 bit channels, two channels per operation.
+	 *
+	 * @param px pixel
+	 * @param a factor (0-255)
+	 * @return multiplied pixel
+	 */
+	inline uint32_t MulPixel(uint32_t px, uint32_t a) {
+		uint32_t rb = (px & 0x00FF00FF) * a + 0x00800080;
+		rb = ((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+		uint32_t ag = ((px >> 8) & 0x00FF00FF) * a + 0x00800080;
+		ag = (ag + ((ag >> 8) & 0x00FF00FF)) & 0xFF00FF00;
+		return rb | ag;
+	}
+
+	/**
+	 * Premultiplied OVER of a single pixel.
+	 *
+	 * @param dst destination pixel
+	 * @param src source pixel
+	 * @param as alpha shift of the pixel format
+	 */
+	inline void BlendPixel(uint32_t& dst, uint32_t src, int as) {
+		const uint32_t a = (src >> as) & 0xFF;
+		if (a == 0xFF) {
+			dst = src;
+		} else if (a != 0) {
+			dst = src + MulPixel(dst, 0xFF - a);
+		}
+	}
+
+	/** @return pointer to the first pixel of row y */
+	inline uint32_t* Row(Bitmap& bmp, int y) {
+		return reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(bmp.pixels()) + y * bmp.pitch());
+	}
+
+	/** @return pointer to the first pixel of row y */
+	inline const uint32_t* Row(const Bitmap& bmp, int y) {
+		return reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(bmp.pixels()) + y * bmp.pitch());
+	}
+}
+
+#endif
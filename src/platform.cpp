@@ -19,7 +19,11 @@
 #include "platform.h"
 #include "utils.h"
 #include <cassert>
+#include <cstdio>
 #include <utility>
+#ifdef PSP2
+#  include <psp2/io/fcntl.h>
+#endif
 
 #ifndef DT_UNKNOWN
 #define DT_UNKNOWN 0
@@ -124,6 +128,59 @@ int64_t Platform::File::GetSize() const {
 #endif
 }
 
+int64_t Platform::File::GetModificationTime() const {
+#if defined(_WIN32)
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	BOOL res = ::GetFileAttributesExW(filename.c_str(),
+			GetFileExInfoStandard,
+			&data);
+	if (!res) {
+		return -1;
+	}
+
+	// FILETIME counts 100 ns intervals since 1601-01-01
+	int64_t ft = ((int64_t)data.ftLastWriteTime.dwHighDateTime << 32) | (int64_t)data.ftLastWriteTime.dwLowDateTime;
+	return (ft - 116444736000000000LL) / 10000000LL;
+#elif defined(PSP2)
+	// Only available as a calendar date
+	return -1;
+#else
+	struct stat sb = {};
+	int result = ::stat(filename.c_str(), &sb);
+	return (result == 0) ? (int64_t)sb.st_mtime : (int64_t)-1;
+#endif
+}
+
+bool Platform::File::Rename(const std::string& new_name) const {
+#if defined(_WIN32)
+	return ::MoveFileExW(filename.c_str(), Utils::ToWideString(new_name).c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#elif defined(PSP2)
+	::sceIoRemove(new_name.c_str());
+	return ::sceIoRename(filename.c_str(), new_name.c_str()) >= 0;
+#else
+	if (::rename(filename.c_str(), new_name.c_str()) == 0) {
+		return true;
+	}
+#  if (defined(GEKKO) || defined(_3DS) || defined(__SWITCH__))
+	// Some devoptabs do not replace existing files
+	::remove(new_name.c_str());
+	return ::rename(filename.c_str(), new_name.c_str()) == 0;
+#  else
+	return false;
+#  endif
+#endif
+}
+
+bool Platform::File::Remove() const {
+#if defined(_WIN32)
+	return ::DeleteFileW(filename.c_str()) != 0;
+#elif defined(PSP2)
+	return ::sceIoRemove(filename.c_str()) >= 0;
+#else
+	return ::remove(filename.c_str()) == 0;
+#endif
+}
+
 Platform::Directory::Directory(const std::string& name) {
 #if defined(_WIN32)
 	dir_handle = ::_wopendir(Utils::ToWideString(name).c_str());
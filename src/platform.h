@@ -94,6 +94,25 @@ namespace Platform {
 		/** @return Filesize or -1 on error */
 		int64_t GetSize() const;
 
+		/** @return Time of the last modification in seconds since the epoch or -1 on error */
+		int64_t GetModificationTime() const;
+
+		/**
+		 * Renames the file. An existing file with the new name is replaced.
+		 * This is atomic on platforms that support it.
+		 *
+		 * @param new_name New path of the file
+		 * @return true on success
+		 */
+		bool Rename(const std::string& new_name) const;
+
+		/**
+		 * Deletes the file.
+		 *
+		 * @return true on success
+		 */
+		bool Remove() const;
+
 	private:
 #ifdef _WIN32
 		const std::wstring filename;
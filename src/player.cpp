@@ -43,6 +43,8 @@
 
 #include "async_handler.h"
 #include "audio.h"
+#include "battle_simulator.h"
+#include "bitmap.h"
 #include "cache.h"
 #include "rand.h"
 #include "cmdline_parser.h"
@@ -50,6 +52,7 @@
 #include "filefinder.h"
 #include "filefinder_rtp.h"
 #include "fileext_guesser.h"
+#include "frame_arena.h"
 #include "game_actors.h"
 #include "game_battle.h"
 #include "game_map.h"
@@ -67,12 +70,14 @@
 #include "graphics.h"
 #include <lcf/inireader.h>
 #include "input.h"
+#include "interpreter_profiler.h"
 #include <lcf/ldb/reader.h>
 #include <lcf/lmt/reader.h>
 #include <lcf/lsd/reader.h>
 #include "main_data.h"
 #include "output.h"
 #include "player.h"
+#include "save_writer.h"
 #include <lcf/reader_lcf.h>
 #include <lcf/reader_util.h>
 #include "scene_battle.h"
@@ -124,6 +129,7 @@ namespace Player {
 	std::string command_line;
 	int speed_modifier = 3;
 	Game_ConfigPlayer player_config;
+	Game_ConfigVideo video_config;
 #ifdef EMSCRIPTEN
 	std::string emscripten_game_name;
 #endif
@@ -199,7 +205,11 @@ void Player::Init(int argc, char *argv[]) {
 
 	DisplayUi.reset();
 
-	if(! DisplayUi) {
+	if (BattleSimulator::config.enabled) {
+		// The battle simulation runs without window and audio,
+		// bitmaps are only loaded and never displayed
+		Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	} else if(! DisplayUi) {
 		DisplayUi = BaseUi::CreateUi(SCREEN_TARGET_WIDTH, SCREEN_TARGET_HEIGHT, cfg.video);
 	}
 
@@ -210,9 +220,15 @@ void Player::Init(int argc, char *argv[]) {
 	Input::AddRecordingData(Input::RecordingData::CommandLine, command_line);
 
 	player_config = std::move(cfg.player);
+	video_config = std::move(cfg.video);
 }
 
 void Player::Run() {
+	if (BattleSimulator::config.enabled) {
+		RunBattleSimulation();
+		return;
+	}
+
 	Instrumentation::Init("EasyRPG-Player");
 	Scene::Push(std::make_shared<Scene_Logo>());
 	Graphics::UpdateSceneCallback();
@@ -264,6 +280,7 @@ void Player::MainLoop() {
 	Player::Draw();
 
 	Scene::old_instances.clear();
+	FrameArena::Reset();
 
 	if (!Transition::instance().IsActive() && Scene::instance->type == Scene::Null) {
 		Exit();
@@ -408,6 +425,11 @@ void Player::Exit() {
 	DisplayUi->UpdateDisplay();
 #endif
 
+	// Finish saves that are still written in the background
+	SaveWriter::Quit();
+
+	InterpreterProfiler::Quit();
+
 	Player::ResetGameObjects();
 	Font::Dispose();
 	DynRpg::Reset();
@@ -450,6 +472,7 @@ Game_Config Player::ParseCommandLine(int argc, char *argv[]) {
 	mouse_flag = false;
 	touch_flag = false;
 	Game_Battle::battle_test.enabled = false;
+	BattleSimulator::config.enabled = false;
 
 	std::stringstream ss;
 	for (int i = 1; i < argc; ++i) {
@@ -518,6 +541,20 @@ Game_Config Player::ParseCommandLine(int argc, char *argv[]) {
 			}
 			continue;
 		}
+		if (cp.ParseNext(arg, 3, "--battle-sim")) {
+			BattleSimulator::config.enabled = true;
+
+			if (arg.ParseValue(0, li_value)) {
+				BattleSimulator::config.troop_id = li_value;
+			}
+			if (arg.ParseValue(1, li_value)) {
+				BattleSimulator::config.battles = li_value;
+			}
+			if (arg.ParseValue(2, li_value)) {
+				BattleSimulator::config.jobs = li_value;
+			}
+			continue;
+		}
 		if (cp.ParseNext(arg, 1, "--project-path") && arg.NumValues() > 0) {
 			if (arg.NumValues() > 0) {
 #ifdef _WIN32
@@ -619,6 +656,12 @@ Game_Config Player::ParseCommandLine(int argc, char *argv[]) {
 			}
 			continue;
 		}
+		if (cp.ParseNext(arg, 1, "--profile-events")) {
+			if (arg.NumValues() > 0) {
+				InterpreterProfiler::Start(arg.Value(0));
+			}
+			continue;
+		}
 		if (cp.ParseNext(arg, 1, "--replay-input")) {
 			if (arg.NumValues() > 0) {
 				replay_input_path = arg.Value(0);
@@ -732,7 +775,9 @@ void Player::CreateGameObjects() {
 		Output::Debug("Could not read game title.");
 	}
 	title << GAME_TITLE;
-	DisplayUi->SetTitle(title.str());
+	if (DisplayUi) {
+		DisplayUi->SetTitle(title.str());
+	}
 
 	if (no_rtp_warning_flag) {
 		Output::Debug("Game does not need RTP (FullPackageFlag=1)");
@@ -994,8 +1039,7 @@ void Player::LoadDatabase() {
 	}
 }
 
-static void OnMapSaveFileReady(FileRequestResult*, lcf::rpg::Save save) {
-	auto map = Game_Map::loadMapFile(Main_Data::game_player->GetMapId());
+static void SetupMapFromSave(std::unique_ptr<lcf::rpg::Map> map, lcf::rpg::Save save) {
 	Game_Map::SetupFromSave(
 			std::move(map),
 			std::move(save.map_info),
@@ -1007,19 +1051,13 @@ static void OnMapSaveFileReady(FileRequestResult*, lcf::rpg::Save save) {
 			std::move(save.common_events));
 }
 
+static void OnMapSaveFileReady(FileRequestResult*, lcf::rpg::Save save) {
+	auto map = Game_Map::loadMapFile(Main_Data::game_player->GetMapId());
+	SetupMapFromSave(std::move(map), std::move(save));
+}
+
 void Player::LoadSavegame(const std::string& save_name, int save_id) {
 	Output::Debug("Loading Save {}", FileFinder::GetPathInsidePath(Main_Data::GetSavePath(), save_name));
-	Main_Data::game_system->BgmFade(800);
-
-	// We erase the screen now before loading the saved game. This prevents an issue where
-	// if the save game has a different system graphic, the load screen would change before
-	// transitioning out.
-	Transition::instance().InitErase(Transition::TransitionFadeOut, Scene::instance.get(), 6);
-
-	auto title_scene = Scene::Find(Scene::Title);
-	if (title_scene) {
-		static_cast<Scene_Title*>(title_scene.get())->OnGameStart();
-	}
 
 	auto save_stream = FileFinder::OpenInputStream(save_name);
 	if (!save_stream) {
@@ -1066,31 +1104,61 @@ void Player::LoadSavegame(const std::string& save_name, int save_id) {
 		save->airship_location.animation_type = Game_Character::AnimType::AnimType_non_continuous;
 	}
 
+	SetupSavegame(std::move(*save), save_id);
+}
+
+static void SetupGameObjectsFromSave(lcf::rpg::Save& save) {
+	Main_Data::game_switches->SetData(std::move(save.system.switches));
+	Main_Data::game_variables->SetData(std::move(save.system.variables));
+	Main_Data::game_system->SetupFromSave(std::move(save.system));
+	Main_Data::game_actors->SetSaveData(std::move(save.actors));
+	Main_Data::game_party->SetupFromSave(std::move(save.inventory));
+	Main_Data::game_screen->SetSaveData(std::move(save.screen));
+	Main_Data::game_pictures->SetSaveData(std::move(save.pictures));
+	Main_Data::game_targets->SetSaveData(std::move(save.targets));
+	Main_Data::game_player->SetSaveData(save.party_location);
+}
+
+void Player::SetupSavegame(lcf::rpg::Save save, int save_id) {
+	Main_Data::game_system->BgmFade(800);
+
+	// We erase the screen now before loading the saved game. This prevents an issue where
+	// if the save game has a different system graphic, the load screen would change before
+	// transitioning out.
+	Transition::instance().InitErase(Transition::TransitionFadeOut, Scene::instance.get(), 6);
+
+	auto title_scene = Scene::Find(Scene::Title);
+	if (title_scene) {
+		static_cast<Scene_Title*>(title_scene.get())->OnGameStart();
+	}
+
 	Scene::PopUntil(Scene::Title);
 	Game_Map::Dispose();
 
-	Main_Data::game_switches->SetData(std::move(save->system.switches));
-	Main_Data::game_variables->SetData(std::move(save->system.variables));
-	Main_Data::game_system->SetupFromSave(std::move(save->system));
-	Main_Data::game_actors->SetSaveData(std::move(save->actors));
-	Main_Data::game_party->SetupFromSave(std::move(save->inventory));
-	Main_Data::game_screen->SetSaveData(std::move(save->screen));
-	Main_Data::game_pictures->SetSaveData(std::move(save->pictures));
-	Main_Data::game_targets->SetSaveData(std::move(save->targets));
-	Main_Data::game_player->SetSaveData(save->party_location);
+	SetupGameObjectsFromSave(save);
 
 	int map_id = Main_Data::game_player->GetMapId();
 
-	FileRequestAsync* map = Game_Map::RequestMap(map_id);
-	save_request_id = map->Bind([save=std::move(*save)](auto* request) { OnMapSaveFileReady(request, std::move(save)); });
-	map->SetImportantFile(true);
+	FileRequestAsync* map_request = Game_Map::RequestMap(map_id);
+	save_request_id = map_request->Bind([save=std::move(save)](auto* request) { OnMapSaveFileReady(request, std::move(save)); });
+	map_request->SetImportantFile(true);
 
 	Main_Data::game_system->ReloadSystemGraphic();
 
-	map->Start();
+	map_request->Start();
+
 	Scene::Push(std::make_shared<Scene_Map>(save_id));
 }
 
+void Player::RestoreSavegame(lcf::rpg::Save save, std::unique_ptr<lcf::rpg::Map> map) {
+	Game_Map::Dispose();
+
+	SetupGameObjectsFromSave(save);
+	SetupMapFromSave(std::move(map), std::move(save));
+
+	Main_Data::game_system->ReloadSystemGraphic();
+}
+
 static void OnMapFileReady(FileRequestResult*) {
 	int map_id = Player::start_map_id == -1 ?
 		lcf::Data::treemap.start.party_map_id : Player::start_map_id;
@@ -1165,6 +1233,31 @@ void Player::SetupBattleTest() {
 	Scene::Push(Scene_Battle::Create(std::move(args)), true);
 }
 
+void Player::RunBattleSimulation() {
+	const auto& cfg = BattleSimulator::config;
+
+	// What Scene_Logo does for a game, without waiting for a frame
+	auto tree = FileFinder::CreateDirectoryTree(Main_Data::GetProjectPath());
+	if (!tree || !FileFinder::IsValidProject(*tree)) {
+		Output::Error("BattleSim: {} is not a valid project", Main_Data::GetProjectPath());
+	}
+	FileFinder::SetDirectoryTree(std::move(tree));
+	CreateGameObjects();
+
+	auto* troop = lcf::ReaderUtil::GetElement(lcf::Data::troops, cfg.troop_id);
+	if (troop == nullptr) {
+		Output::Error("BattleSim: Invalid Monster Party ID {}", cfg.troop_id);
+	}
+
+	Output::Debug("BattleSim troop=({}) battles=({}) jobs=({})", cfg.troop_id, cfg.battles, cfg.jobs);
+
+	// Seeded from the main RNG, --seed makes the simulation reproducible
+	auto report = BattleSimulator::Run(cfg, Rand::GetRNG()());
+	BattleSimulator::PrintReport(std::cout, report);
+
+	Exit();
+}
+
 std::string Player::GetEncoding() {
 	encoding = forced_encoding;
 
@@ -1248,6 +1341,11 @@ void Player::PrintUsage() {
 R"(EasyRPG Player - An open source interpreter for RPG Maker 2000/2003 games.
 Options:
       --battle-test N      Start a battle test with monster party N.
+      --battle-sim N [B] [J]
+                           Simulate B battles (default: 100) against monster
+                           party N with J processes (default: one per core)
+                           and print statistics without opening a window.
+                           The party is controlled by the autobattle algorithm.
       --disable-audio      Disable audio (in case you prefer your own music).
       --disable-rtp        Disable support for the Runtime Package (RTP).
       --encoding N         Instead of auto detecting the encoding or using
@@ -1269,6 +1367,12 @@ Options:
                            This option is not supported on all platforms.
       --no-vsync           Disable vertical sync and use fps-limit. Even without
                            this option, vsync may not be supported on all platforms.
+      --screen-tone-pass   Apply the screen tone once to the whole map or battle
+                           scene instead of to every single sprite.
+      --save-metadata      Write a small SaveXX.lsd.meta file next to every save,
+                           so the load menu does not parse the full saves.
+      --translation-cache  Store parsed translation files in the save directory,
+                           so changing the language is faster next time.
       --enable-mouse       Use mouse click for decision and scroll wheel for lists
       --enable-touch       Use one/two finger tap for decision/cancel
       --hide-title         Hide the title background image and center the
@@ -1278,6 +1382,9 @@ Options:
       --new-game           Skip the title scene and start a new game directly.
       --project-path PATH  Instead of using the working directory the game in
                            PATH is used.
+      --profile-events PATH
+                           Measure how often and how long every event command
+                           runs and write a report to PATH on exit.
       --record-input PATH  Record all button input to a log file at PATH.
       --replay-input PATH  Replays button presses from an input log generated by
                            --record-input.
@@ -26,6 +26,7 @@
 #include "game_config.h"
 #include <vector>
 #include <memory>
+#include <lcf/rpg/fwd.h>
 
 /**
  * Player namespace.
@@ -151,6 +152,24 @@ namespace Player {
 	 */
 	void LoadSavegame(const std::string& save_file, int save_id = 0);
 
+	/**
+	 * Starts the game from savegame data that is already in memory.
+	 *
+	 * @param save game state
+	 * @param save_id ID of the savegame to load
+	 */
+	void SetupSavegame(lcf::rpg::Save save, int save_id = 0);
+
+	/**
+	 * Replaces the game state with savegame data while the game is running.
+	 * Unlike SetupSavegame no scene is changed and no transition is started,
+	 * the map scene must recreate its graphics.
+	 *
+	 * @param save game state
+	 * @param map data of the map the party is on
+	 */
+	void RestoreSavegame(lcf::rpg::Save save, std::unique_ptr<lcf::rpg::Map> map);
+
 	/**
 	 * Starts a new game
 	 */
@@ -161,6 +180,13 @@ namespace Player {
 	 */
 	void SetupBattleTest();
 
+	/**
+	 * Runs the battle simulation of --battle-sim instead of the main loop.
+	 * Loads the game without creating a window or audio, prints the report
+	 * and quits the Player.
+	 */
+	void RunBattleSimulation();
+
 	/**
 	 * Moves the player to the start map.
 	 */
@@ -366,6 +392,11 @@ namespace Player {
 	 */
 	extern Game_ConfigPlayer player_config;
 
+	/**
+	 * The video configuration
+	 */
+	extern Game_ConfigVideo video_config;
+
 #ifdef EMSCRIPTEN
 	/** Name of game emscripten uses */
 	extern std::string emscripten_game_name;
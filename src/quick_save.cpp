@@ -0,0 +1,67 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <memory>
+#include <lcf/rpg/map.h>
+#include "quick_save.h"
+#include "game_map.h"
+#include "game_player.h"
+#include "game_system.h"
+#include "main_data.h"
+#include "output.h"
+#include "player.h"
+#include "scene_save.h"
+#include "version.h"
+
+namespace {
+	std::unique_ptr<lcf::rpg::Save> stored;
+}
+
+lcf::rpg::Save QuickSave::Take() {
+	auto snapshot = Scene_Save::CreateSaveGame(Main_Data::game_system->GetSaveSlot(), false);
+	snapshot.easyrpg_data.version = PLAYER_SAVEGAME_VERSION;
+	return snapshot;
+}
+
+void QuickSave::Restore(lcf::rpg::Save snapshot) {
+	// The map data is never modified while playing and can be reused
+	std::unique_ptr<lcf::rpg::Map> map;
+	const int map_id = snapshot.party_location.map_id;
+	if (Game_Map::GetMapId() == map_id) {
+		map = Game_Map::ReleaseMap();
+	} else {
+		map = Game_Map::loadMapFile(map_id);
+	}
+
+	Player::RestoreSavegame(std::move(snapshot), std::move(map));
+}
+
+void QuickSave::Store() {
+	stored = std::make_unique<lcf::rpg::Save>(Take());
+	Output::Debug("Quick save stored");
+}
+
+bool QuickSave::Load() {
+	if (!stored) {
+		return false;
+	}
+
+	Output::Debug("Restoring quick save");
+	Restore(*stored);
+	return true;
+}
@@ -0,0 +1,67 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_QUICK_SAVE_H
+#define EP_QUICK_SAVE_H
+
+// Headers
+#include <lcf/rpg/save.h>
+
+/**
+ * In-memory snapshots of the game state for quick saving and loading.
+ *
+ * A snapshot is the decoded savegame data, the same that a save file
+ * contains, but taking and restoring it skips the LSD encoding and the file
+ * access. Restoring replaces the state of the running game, without scene
+ * change and transition. When the party is still on the map of the
+ * snapshot, the loaded map data is reused instead of reading the map file
+ * again.
+ *
+ * Snapshots do not update the save count and timestamp and are not visible
+ * in the save menus.
+ */
+namespace QuickSave {
+
+/**
+ * Collects the current game state.
+ *
+ * @return the snapshot
+ */
+lcf::rpg::Save Take();
+
+/**
+ * Replaces the game state with a snapshot.
+ * The map scene must recreate its graphics afterwards.
+ *
+ * @param snapshot snapshot to restore
+ */
+void Restore(lcf::rpg::Save snapshot);
+
+/** Takes a snapshot and keeps it in the quick save slot. */
+void Store();
+
+/**
+ * Restores the snapshot of the quick save slot.
+ * The map scene must recreate its graphics afterwards.
+ *
+ * @return false when the slot is empty
+ */
+bool Load();
+
+} // namespace QuickSave
+
+#endif
@@ -0,0 +1,413 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <fmt/format.h>
+#include <lcf/lsd/reader.h>
+#include "system.h"
+#ifdef HAVE_THREADS
+#  include <atomic>
+#  include <mutex>
+#  include <system_error>
+#  include <thread>
+#endif
+#include "save_metadata.h"
+#include "filefinder.h"
+#include "output.h"
+#include "player.h"
+#include "utils.h"
+
+namespace {
+	constexpr char magic[] = "EPSM";
+	constexpr uint32_t version = 3;
+
+	/** Upper bound for strings, protects against garbage files */
+	constexpr uint32_t max_string_size = 1024;
+
+	/** Worker threads, more do not help on slow storage */
+	constexpr int max_jobs = 4;
+
+	void WriteU32(std::ostream& os, uint32_t val) {
+		Utils::SwapByteOrder(val);
+		os.write(reinterpret_cast<const char*>(&val), sizeof(val));
+	}
+
+	void WriteI32(std::ostream& os, int32_t val) {
+		WriteU32(os, static_cast<uint32_t>(val));
+	}
+
+	void WriteI64(std::ostream& os, int64_t val) {
+		WriteU32(os, static_cast<uint32_t>(static_cast<uint64_t>(val)));
+		WriteU32(os, static_cast<uint32_t>(static_cast<uint64_t>(val) >> 32));
+	}
+
+	void WriteDouble(std::ostream& os, double val) {
+		Utils::SwapByteOrder(val);
+		os.write(reinterpret_cast<const char*>(&val), sizeof(val));
+	}
+
+	void WriteString(std::ostream& os, const std::string& str) {
+		WriteU32(os, static_cast<uint32_t>(str.size()));
+		os.write(str.data(), str.size());
+	}
+
+	bool ReadU32(std::istream& is, uint32_t& val) {
+		if (!is.read(reinterpret_cast<char*>(&val), sizeof(val))) {
+			return false;
+		}
+		Utils::SwapByteOrder(val);
+		return true;
+	}
+
+	bool ReadI32(std::istream& is, int32_t& val) {
+		uint32_t uval;
+		if (!ReadU32(is, uval)) {
+			return false;
+		}
+		val = static_cast<int32_t>(uval);
+		return true;
+	}
+
+	bool ReadI64(std::istream& is, int64_t& val) {
+		uint32_t low, high;
+		if (!ReadU32(is, low) || !ReadU32(is, high)) {
+			return false;
+		}
+		val = static_cast<int64_t>((static_cast<uint64_t>(high) << 32) | low);
+		return true;
+	}
+
+	bool ReadDouble(std::istream& is, double& val) {
+		if (!is.read(reinterpret_cast<char*>(&val), sizeof(val))) {
+			return false;
+		}
+		Utils::SwapByteOrder(val);
+		return true;
+	}
+
+	bool ReadString(std::istream& is, std::string& str) {
+		uint32_t size;
+		if (!ReadU32(is, size) || size > max_string_size) {
+			return false;
+		}
+		str.resize(size);
+		return size == 0 || is.read(&str[0], size);
+	}
+
+	/** @return CRC32 of the stream, which is rewound afterwards */
+	uint32_t GetStreamCRC32(std::istream& is) {
+		uint32_t crc = Utils::CRC32(is);
+		is.clear();
+		is.seekg(0, std::ios_base::beg);
+		return crc;
+	}
+}
+
+std::string SaveMetadata::GetSaveName(int slot_id) {
+	return fmt::format("Save{:02d}.lsd", slot_id);
+}
+
+std::string SaveMetadata::GetSidecarName(int slot_id) {
+	return fmt::format("Save{:02d}.lsd.meta", slot_id);
+}
+
+bool SaveMetadata::Write(std::ostream& os, const lcf::rpg::SaveTitle& title, const SaveInfo& save_info) {
+	os.write(magic, 4);
+	WriteU32(os, version);
+	WriteU32(os, save_info.size);
+	WriteI64(os, save_info.mtime);
+	WriteU32(os, save_info.crc);
+	WriteDouble(os, title.timestamp);
+	WriteString(os, title.hero_name);
+	WriteI32(os, title.hero_level);
+	WriteI32(os, title.hero_hp);
+	WriteString(os, title.face1_name);
+	WriteI32(os, title.face1_id);
+	WriteString(os, title.face2_name);
+	WriteI32(os, title.face2_id);
+	WriteString(os, title.face3_name);
+	WriteI32(os, title.face3_id);
+	WriteString(os, title.face4_name);
+	WriteI32(os, title.face4_id);
+	return static_cast<bool>(os);
+}
+
+bool SaveMetadata::Read(std::istream& is, lcf::rpg::SaveTitle& title, SaveInfo& save_info) {
+	char file_magic[4];
+	uint32_t file_version;
+	if (!is.read(file_magic, 4) || !std::equal(file_magic, file_magic + 4, magic)) {
+		return false;
+	}
+	if (!ReadU32(is, file_version) || file_version != version) {
+		return false;
+	}
+
+	lcf::rpg::SaveTitle t;
+	SaveInfo info;
+	bool ok = ReadU32(is, info.size)
+		&& ReadI64(is, info.mtime)
+		&& ReadU32(is, info.crc)
+		&& ReadDouble(is, t.timestamp)
+		&& ReadString(is, t.hero_name)
+		&& ReadI32(is, t.hero_level)
+		&& ReadI32(is, t.hero_hp)
+		&& ReadString(is, t.face1_name)
+		&& ReadI32(is, t.face1_id)
+		&& ReadString(is, t.face2_name)
+		&& ReadI32(is, t.face2_id)
+		&& ReadString(is, t.face3_name)
+		&& ReadI32(is, t.face3_id)
+		&& ReadString(is, t.face4_name)
+		&& ReadI32(is, t.face4_id);
+
+	if (ok) {
+		title = std::move(t);
+		save_info = info;
+	}
+	return ok;
+}
+
+struct SaveMetadata::Loader::Impl {
+	/** Paths are resolved on the main thread, DirectoryTree is not thread safe */
+	struct Job {
+		int index;
+		std::string save_path;
+		std::string sidecar_path;
+	};
+
+	/** A parsed save whose sidecar is written by Poll */
+	struct Sidecar {
+		int job;
+		lcf::rpg::SaveTitle title;
+		SaveInfo save_info;
+	};
+
+	std::vector<Job> jobs;
+	bool use_sidecars = false;
+	bool verify_crc = false;
+	int remaining = 0;
+
+	std::vector<Slot> finished;
+	std::vector<Sidecar> sidecars;
+
+#ifdef HAVE_THREADS
+	std::mutex mutex;
+	std::atomic<int> next_job{0};
+	std::atomic<bool> cancel{false};
+	std::vector<std::thread> workers;
+#else
+	int next_job = 0;
+#endif
+
+	void Load(int job_index);
+	void Finish(Slot slot);
+	void WriteSidecar(const Sidecar& sidecar) const;
+};
+
+void SaveMetadata::Loader::Impl::Load(int job_index) {
+	const auto& job = jobs[job_index];
+
+	Slot slot;
+	slot.index = job.index;
+
+	SaveInfo save_info;
+	bool has_info = false;
+	if (use_sidecars) {
+		// Only the file attributes are needed to validate the sidecar
+		const int64_t save_size = FileFinder::GetFileSize(job.save_path);
+		save_info.mtime = FileFinder::GetModificationTime(job.save_path);
+		save_info.size = static_cast<uint32_t>(save_size);
+		has_info = save_size >= 0 && save_info.mtime >= 0;
+	}
+
+	auto save_stream = FileFinder::OpenInputStream(job.save_path);
+	if (!save_stream) {
+		slot.error = fmt::format("Save {} read error", job.save_path);
+		slot.state = State::Corrupted;
+		Finish(std::move(slot));
+		return;
+	}
+
+	if (has_info) {
+		if (verify_crc) {
+			save_info.crc = GetStreamCRC32(save_stream);
+		}
+
+		auto sidecar_stream = FileFinder::OpenInputStream(job.sidecar_path);
+		lcf::rpg::SaveTitle title;
+		SaveInfo sidecar_info;
+		if (sidecar_stream && Read(sidecar_stream, title, sidecar_info)
+				&& sidecar_info.size == save_info.size
+				&& sidecar_info.mtime == save_info.mtime
+				&& (!verify_crc || sidecar_info.crc == save_info.crc)) {
+			slot.state = State::Valid;
+			slot.title = std::move(title);
+			Finish(std::move(slot));
+			return;
+		}
+	}
+
+	auto savegame = lcf::LSD_Reader::Load(save_stream, Player::encoding);
+	if (!savegame) {
+		slot.error = fmt::format("Save {} corrupted", job.save_path);
+		slot.state = State::Corrupted;
+		Finish(std::move(slot));
+		return;
+	}
+
+	slot.state = State::Valid;
+	slot.title = std::move(savegame->title);
+
+	if (has_info) {
+		if (!verify_crc) {
+			// Stored for a later deep check
+			save_stream.clear();
+			save_stream.seekg(0, std::ios_base::beg);
+			save_info.crc = GetStreamCRC32(save_stream);
+		}
+
+#ifdef HAVE_THREADS
+		std::lock_guard<std::mutex> lock(mutex);
+#endif
+		sidecars.push_back({ job_index, slot.title, save_info });
+	}
+
+	Finish(std::move(slot));
+}
+
+void SaveMetadata::Loader::Impl::Finish(Slot slot) {
+#ifdef HAVE_THREADS
+	std::lock_guard<std::mutex> lock(mutex);
+#endif
+	finished.push_back(std::move(slot));
+}
+
+void SaveMetadata::Loader::Impl::WriteSidecar(const Sidecar& sidecar) const {
+	const auto& job = jobs[sidecar.job];
+
+	// Skip saves which were replaced since they were parsed
+	if (FileFinder::GetFileSize(job.save_path) != sidecar.save_info.size
+			|| FileFinder::GetModificationTime(job.save_path) != sidecar.save_info.mtime) {
+		return;
+	}
+
+	auto sidecar_stream = FileFinder::OpenOutputStream(job.sidecar_path);
+	if (sidecar_stream) {
+		Write(sidecar_stream, sidecar.title, sidecar.save_info);
+	}
+}
+
+SaveMetadata::Loader::Loader(const DirectoryTreeView& tree, int num_slots, bool use_sidecars, bool verify_crc)
+	: impl(std::make_unique<Impl>())
+{
+	impl->use_sidecars = use_sidecars;
+	impl->verify_crc = verify_crc;
+	impl->remaining = num_slots;
+
+	for (int i = 0; i < num_slots; ++i) {
+		auto save_path = tree.FindFile(GetSaveName(i + 1));
+		if (save_path.empty()) {
+			Slot slot;
+			slot.index = i;
+			slot.state = State::Empty;
+			impl->finished.push_back(std::move(slot));
+			continue;
+		}
+
+		auto sidecar_path = tree.FindFile(GetSidecarName(i + 1));
+		if (sidecar_path.empty()) {
+			sidecar_path = tree.MakePath(GetSidecarName(i + 1));
+		}
+		impl->jobs.push_back({ i, std::move(save_path), std::move(sidecar_path) });
+	}
+
+#ifdef HAVE_THREADS
+	const int num_jobs = static_cast<int>(impl->jobs.size());
+	int num_workers = std::min<int>({ max_jobs, num_jobs, static_cast<int>(std::thread::hardware_concurrency()) });
+	if (num_jobs > 0) {
+		num_workers = std::max(num_workers, 1);
+	}
+
+	for (int w = 0; w < num_workers; ++w) {
+		try {
+			impl->workers.emplace_back([d = impl.get(), num_jobs]() {
+				for (int i = d->next_job++; i < num_jobs && !d->cancel; i = d->next_job++) {
+					d->Load(i);
+				}
+			});
+		} catch (const std::system_error&) {
+			// Continue with the workers started so far, or load in Poll without any
+			break;
+		}
+	}
+#endif
+}
+
+SaveMetadata::Loader::~Loader() {
+#ifdef HAVE_THREADS
+	impl->cancel = true;
+	for (auto& worker: impl->workers) {
+		worker.join();
+	}
+#endif
+}
+
+std::vector<SaveMetadata::Loader::Slot> SaveMetadata::Loader::Poll() {
+	// Without worker threads one save is loaded per call
+#ifdef HAVE_THREADS
+	const bool synchronous = impl->workers.empty();
+#else
+	const bool synchronous = true;
+#endif
+	if (synchronous && impl->next_job < static_cast<int>(impl->jobs.size())) {
+		impl->Load(impl->next_job++);
+	}
+
+	std::vector<Slot> slots;
+	std::vector<Impl::Sidecar> sidecars;
+	{
+#ifdef HAVE_THREADS
+		std::lock_guard<std::mutex> lock(impl->mutex);
+#endif
+		slots.swap(impl->finished);
+		sidecars.swap(impl->sidecars);
+	}
+	impl->remaining -= static_cast<int>(slots.size());
+
+	// Written on the main thread and not by the workers. Scene_File flushes
+	// the SaveWriter before it creates the loader, so no other thread writes
+	// a sidecar meanwhile.
+	for (auto& sidecar: sidecars) {
+		impl->WriteSidecar(sidecar);
+	}
+
+	// Output is not thread safe, the workers only store the message
+	for (auto& slot: slots) {
+		if (!slot.error.empty()) {
+			Output::Debug("{}", slot.error);
+		}
+	}
+
+	return slots;
+}
+
+bool SaveMetadata::Loader::IsDone() const {
+	return impl->remaining == 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_SAVE_METADATA_H
+#define EP_SAVE_METADATA_H
+
+// Headers
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+#include <lcf/rpg/savetitle.h>
+#include "directory_tree.h"
+
+/**
+ * Save slot metadata for the load and save menus.
+ *
+ * The menus only need the title chunk of a save (faces, hero name, level
+ * and timestamp). When enabled, a small sidecar file (SaveXX.lsd.meta) with
+ * this data is written next to every save. The sidecar stores the size and
+ * modification time of the save it belongs to and is ignored when the save
+ * was replaced by another program.
+ */
+namespace SaveMetadata {
+
+/** Identifies the save file a sidecar was written for */
+struct SaveInfo {
+	/** Size in bytes */
+	uint32_t size = 0;
+	/** Modification time in seconds since the epoch */
+	int64_t mtime = 0;
+	/** CRC32 of the whole file, only compared by the deep check */
+	uint32_t crc = 0;
+};
+
+/**
+ * @param slot_id save slot (1 based)
+ * @return file name of the save, e.g. Save01.lsd
+ */
+std::string GetSaveName(int slot_id);
+
+/**
+ * @param slot_id save slot (1 based)
+ * @return file name of the metadata sidecar, e.g. Save01.lsd.meta
+ */
+std::string GetSidecarName(int slot_id);
+
+/**
+ * Writes a metadata sidecar.
+ *
+ * @param os stream to write to
+ * @param title title of the save
+ * @param save_info save file the sidecar is written for
+ * @return whether writing succeeded
+ */
+bool Write(std::ostream& os, const lcf::rpg::SaveTitle& title, const SaveInfo& save_info);
+
+/**
+ * Reads a metadata sidecar.
+ *
+ * @param is stream to read from
+ * @param title title of the save
+ * @param save_info save file the sidecar was written for
+ * @return whether the sidecar is valid
+ */
+bool Read(std::istream& is, lcf::rpg::SaveTitle& title, SaveInfo& save_info);
+
+/**
+ * Reads the title of all save slots in the background.
+ *
+ * When sidecars are enabled, slots are read from the sidecar when size and
+ * modification time of the save match, otherwise the save is parsed and
+ * Poll writes a new sidecar. With thread support several worker threads
+ * read the slots in parallel, otherwise one slot is read per call of Poll.
+ */
+class Loader {
+public:
+	enum class State {
+		/** Not read yet */
+		Loading,
+		/** No save in this slot */
+		Empty,
+		Valid,
+		Corrupted
+	};
+
+	struct Slot {
+		/** Save slot (0 based) */
+		int index = 0;
+		State state = State::Loading;
+		lcf::rpg::SaveTitle title;
+		/** Why the slot is corrupted, logged by Poll */
+		std::string error;
+	};
+
+	/**
+	 * Looks up the save files and starts reading them.
+	 *
+	 * @param tree save directory
+	 * @param num_slots number of slots to read
+	 * @param use_sidecars whether sidecars are read, and written after parsing a save when missing or outdated
+	 * @param verify_crc deep check: a sidecar is only used when the CRC32 of the whole save matches too
+	 */
+	Loader(const DirectoryTreeView& tree, int num_slots, bool use_sidecars, bool verify_crc = false);
+
+	/** Stops reading, waits for the worker threads */
+	~Loader();
+
+	Loader(const Loader&) = delete;
+	Loader& operator=(const Loader&) = delete;
+
+	/**
+	 * Collects the slots that were read since the last call and writes
+	 * their sidecars. Must be called from the main thread.
+	 *
+	 * @return finished slots
+	 */
+	std::vector<Slot> Poll();
+
+	/** @return whether all slots were returned by Poll */
+	bool IsDone() const;
+
+private:
+	struct Impl;
+	std::unique_ptr<Impl> impl;
+};
+
+} // namespace SaveMetadata
+
+#endif
@@ -0,0 +1,222 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <lcf/lsd/reader.h>
+#include "system.h"
+#ifdef HAVE_THREADS
+#  include <condition_variable>
+#  include <deque>
+#  include <mutex>
+#  include <system_error>
+#  include <thread>
+#  if (defined(__unix__) || defined(__APPLE__)) && !defined(EMSCRIPTEN) && !defined(__ANDROID__) \
+		&& !defined(__SWITCH__) && !defined(_3DS) && !defined(PSP2)
+#    define EP_SAVE_WRITER_ATFORK
+#    include <new>
+#    include <pthread.h>
+#  endif
+#endif
+#include "save_writer.h"
+#include "filefinder.h"
+#include "save_metadata.h"
+#include "utils.h"
+
+namespace {
+#ifdef HAVE_THREADS
+	std::mutex mutex;
+	/** Signals new jobs to the worker and finished jobs to Flush */
+	std::condition_variable cv;
+	std::deque<SaveWriter::JobRef> queue;
+	std::thread worker;
+	bool busy = false;
+	bool quit = false;
+
+	void WorkerLoop() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			cv.wait(lock, []() { return quit || !queue.empty(); });
+			if (queue.empty()) {
+				return;
+			}
+
+			auto job = std::move(queue.front());
+			queue.pop_front();
+			busy = true;
+
+			lock.unlock();
+			job->Run();
+			lock.lock();
+
+			busy = false;
+			cv.notify_all();
+		}
+	}
+
+#ifdef EP_SAVE_WRITER_ATFORK
+	/**
+	 * A child process only has a copy of the thread which called fork().
+	 * Queued saves are written by the parent, the child starts with an
+	 * empty queue and a worker of its own when it saves.
+	 */
+	void ForkPrepare() {
+		mutex.lock();
+	}
+
+	void ForkParent() {
+		mutex.unlock();
+	}
+
+	void ForkChild() {
+		mutex.unlock();
+
+		new (&cv) std::condition_variable();
+		// Forget the handle of the parent's worker, it cannot be joined here
+		new (&worker) std::thread();
+		queue.clear();
+		busy = false;
+		quit = false;
+	}
+#endif
+#endif
+}
+
+SaveWriter::Job::Job(std::string filename, lcf::rpg::Save save, lcf::EngineVersion engine,
+		std::string encoding, std::string sidecar_filename, bool write_sidecar)
+	: filename(std::move(filename)), sidecar_filename(std::move(sidecar_filename)),
+	encoding(std::move(encoding)), save(std::move(save)), engine(engine),
+	write_sidecar(write_sidecar)
+{
+}
+
+bool SaveWriter::Job::IsDone() const {
+	return done;
+}
+
+bool SaveWriter::Job::IsSuccess() const {
+	return success;
+}
+
+const std::string& SaveWriter::Job::GetFilename() const {
+	return filename;
+}
+
+void SaveWriter::Job::Run() {
+	const auto tmp_filename = filename + ".tmp";
+
+	int64_t save_size = -1;
+	{
+		auto save_stream = FileFinder::OpenOutputStream(tmp_filename);
+		if (save_stream) {
+			lcf::LSD_Reader::Save(save_stream, save, engine, encoding);
+			save_stream.flush();
+			if (save_stream) {
+				save_size = save_stream.tellp();
+			}
+		}
+	}
+
+	SaveMetadata::SaveInfo save_info;
+	if (save_size >= 0 && write_sidecar) {
+		save_info.size = static_cast<uint32_t>(save_size);
+		// For the deep check of SaveMetadata::Loader
+		auto save_stream = FileFinder::OpenInputStream(tmp_filename);
+		if (save_stream) {
+			save_info.crc = Utils::CRC32(save_stream);
+		}
+	}
+
+	// The old sidecar describes the old save, remove it before replacing the
+	// save so that a crash in between cannot leave it behind
+	if (save_size >= 0 && !sidecar_filename.empty()) {
+		FileFinder::Remove(sidecar_filename);
+	}
+
+	success = save_size >= 0 && FileFinder::Rename(tmp_filename, filename);
+
+	if (success && write_sidecar && !sidecar_filename.empty()) {
+		// The rename keeps the modification time of the temporary file
+		save_info.mtime = FileFinder::GetModificationTime(filename);
+		if (save_info.mtime >= 0) {
+			auto sidecar_stream = FileFinder::OpenOutputStream(sidecar_filename);
+			if (sidecar_stream) {
+				SaveMetadata::Write(sidecar_stream, save.title, save_info);
+			}
+		}
+	}
+
+	// Free the snapshot here and not on the main thread
+	save = {};
+
+	done = true;
+}
+
+SaveWriter::JobRef SaveWriter::Submit(std::string filename, lcf::rpg::Save save, lcf::EngineVersion engine,
+		std::string encoding, std::string sidecar_filename, bool write_sidecar) {
+	auto job = std::make_shared<Job>(std::move(filename), std::move(save), engine,
+			std::move(encoding), std::move(sidecar_filename), write_sidecar);
+
+#ifdef HAVE_THREADS
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!worker.joinable()) {
+#ifdef EP_SAVE_WRITER_ATFORK
+			static bool atfork_registered = false;
+			if (!atfork_registered) {
+				pthread_atfork(ForkPrepare, ForkParent, ForkChild);
+				atfork_registered = true;
+			}
+#endif
+			quit = false;
+			try {
+				worker = std::thread(WorkerLoop);
+			} catch (const std::system_error&) {
+				// Written synchronously below
+			}
+		}
+		if (worker.joinable()) {
+			queue.push_back(job);
+			cv.notify_all();
+			return job;
+		}
+	}
+#endif
+
+	job->Run();
+
+	return job;
+}
+
+void SaveWriter::Flush() {
+#ifdef HAVE_THREADS
+	std::unique_lock<std::mutex> lock(mutex);
+	cv.wait(lock, []() { return queue.empty() && !busy; });
+#endif
+}
+
+void SaveWriter::Quit() {
+#ifdef HAVE_THREADS
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+		cv.notify_all();
+	}
+	if (worker.joinable()) {
+		worker.join();
+	}
+#endif
+}
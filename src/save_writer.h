@@ -0,0 +1,98 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_SAVE_WRITER_H
+#define EP_SAVE_WRITER_H
+
+// Headers
+#include <atomic>
+#include <memory>
+#include <string>
+#include <lcf/rpg/save.h>
+#include <lcf/saveopt.h>
+
+/**
+ * Writes savegames on a worker thread.
+ *
+ * The game state is collected into a lcf::rpg::Save on the main thread and
+ * moved into a job. LSD encoding and file I/O happen on the worker. The save
+ * is written to a temporary file that replaces the old save by a rename, so
+ * a crash during saving never leaves a truncated save behind.
+ *
+ * Jobs are processed in submission order. Without thread support they are
+ * written immediately by Submit.
+ */
+namespace SaveWriter {
+
+class Job {
+public:
+	Job(std::string filename, lcf::rpg::Save save, lcf::EngineVersion engine,
+			std::string encoding, std::string sidecar_filename, bool write_sidecar);
+
+	Job(const Job&) = delete;
+	Job& operator=(const Job&) = delete;
+
+	/** @return whether the job was processed */
+	bool IsDone() const;
+
+	/** @return whether the save was written, only valid when done */
+	bool IsSuccess() const;
+
+	/** @return path of the save */
+	const std::string& GetFilename() const;
+
+	/** Encodes and writes the save, runs on the worker thread. */
+	void Run();
+
+private:
+	std::string filename;
+	std::string sidecar_filename;
+	std::string encoding;
+	lcf::rpg::Save save;
+	lcf::EngineVersion engine;
+	bool write_sidecar = false;
+
+	std::atomic<bool> done{false};
+	bool success = false;
+};
+
+using JobRef = std::shared_ptr<Job>;
+
+/**
+ * Queues a save for writing.
+ *
+ * @param filename path of the save
+ * @param save game state, moved into the job
+ * @param engine engine format of the save
+ * @param encoding text encoding of the save
+ * @param sidecar_filename path of the metadata sidecar, an existing sidecar is
+ * always deleted because it is outdated afterwards. Empty when there is none.
+ * @param write_sidecar whether a new sidecar is written
+ * @return job for polling the result
+ */
+JobRef Submit(std::string filename, lcf::rpg::Save save, lcf::EngineVersion engine,
+		std::string encoding, std::string sidecar_filename, bool write_sidecar);
+
+/** Blocks until all queued saves are written. */
+void Flush();
+
+/** Writes the remaining saves and stops the worker thread. */
+void Quit();
+
+} // namespace SaveWriter
+
+#endif
@@ -187,7 +187,7 @@ void Scene_Battle::UpdateScreen() {
 }
 
 void Scene_Battle::UpdateBattlers() {
-	std::vector<Game_Battler*> battlers;
+	FrameVector<Game_Battler*> battlers;
 	Main_Data::game_enemyparty->GetBattlers(battlers);
 	Main_Data::game_party->GetBattlers(battlers);
 	for (auto* b : battlers) {
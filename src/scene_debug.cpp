@@ -29,6 +29,7 @@
 #include "game_map.h"
 #include "game_system.h"
 #include "game_battle.h"
+#include "interpreter_profiler.h"
 #include "scene_debug.h"
 #include "scene_load.h"
 #include "scene_save.h"
@@ -113,6 +114,8 @@ Window_VarList::Mode Scene_Debug::GetWindowMode() const {
 			return Window_VarList::eCommonEvent;
 		case eCallMapEvent:
 			return Window_VarList::eMapEvent;
+		case eProfiler:
+			return Window_VarList::eProfile;
 		default:
 			return Window_VarList::eNone;
 	}
@@ -288,6 +291,7 @@ void Scene_Debug::Update() {
 				if (
 						(is_battle && (next_mode == eSave || next_mode == eBattle || next_mode == eMap || next_mode == eCallMapEvent))
 						|| (!is_battle && (next_mode == eCallBattleEvent))
+						|| (next_mode == eProfiler && !InterpreterProfiler::IsEnabled())
 				   )
 				{
 					Main_Data::game_system->SePlay(Main_Data::game_system->GetSystemSE(Main_Data::game_system->SFX_Buzzer));
@@ -427,6 +431,14 @@ void Scene_Debug::Update() {
 					}
 				}
 				break;
+			case eProfiler:
+				// The statistics are read only
+				if (sz == 2) {
+					PushUiVarList();
+				} else if (sz == 1) {
+					PushUiRangeList();
+				}
+				break;
 		}
 		Game_Map::SetNeedRefresh(true);
 	} else if (range_window->GetActive() && Input::IsRepeated(Input::RIGHT)) {
@@ -498,6 +510,7 @@ void Scene_Debug::UpdateRangeListWindow() {
 			} else {
 				addItem("Call MapEvent", !is_battle);
 				addItem("Call BtlEvent", is_battle);
+				addItem("Profiler", InterpreterProfiler::IsEnabled());
 			}
 			break;
 		case eSwitch:
@@ -546,6 +559,9 @@ void Scene_Debug::UpdateRangeListWindow() {
 				fillRange("Me");
 			}
 			break;
+		case eProfiler:
+			fillRange("Pf");
+			break;
 		case eGold:
 			addItem(lcf::Data::terms.gold);
 			for (int i = 1; i < 10; i++){
@@ -629,6 +645,9 @@ int Scene_Debug::GetLastPage() {
 		case eCallMapEvent:
 			num_elements = Game_Map::GetHighestEventId();
 			break;
+		case eProfiler:
+			num_elements = InterpreterProfiler::GetNumEntries();
+			break;
 		default:
 			break;
 	}
@@ -66,6 +66,7 @@ public:
 		eCallCommonEvent,
 		eCallMapEvent,
 		eCallBattleEvent,
+		eProfiler,
 		eLastMainMenuOption,
 	};
 
@@ -17,7 +17,6 @@
 
 // Headers
 #include <algorithm>
-#include <sstream>
 #include <vector>
 #include "baseui.h"
 #include "cache.h"
@@ -25,12 +24,11 @@
 #include "game_system.h"
 #include "game_party.h"
 #include "input.h"
-#include <lcf/lsd/reader.h>
 #include "player.h"
+#include "save_writer.h"
 #include "scene_file.h"
 #include "bitmap.h"
 #include <lcf/reader_util.h>
-#include "output.h"
 
 constexpr int arrow_animation_frames = 20;
 
@@ -67,43 +65,49 @@ void Scene_File::CreateHelpWindow() {
 	help_window->SetZ(Priority_Window + 1);
 }
 
-void Scene_File::PopulatePartyFaces(Window_SaveFile& win, int /* id */, lcf::rpg::Save& savegame) {
-	win.SetParty(savegame.title);
+void Scene_File::PopulatePartyFaces(Window_SaveFile& win, int /* id */, const lcf::rpg::SaveTitle& title) {
+	win.SetParty(title);
 	win.SetHasSave(true);
 }
 
-void Scene_File::UpdateLatestTimestamp(int id, lcf::rpg::Save& savegame) {
-	if (savegame.title.timestamp > latest_time) {
-		latest_time = savegame.title.timestamp;
+void Scene_File::UpdateLatestTimestamp(int id, const lcf::rpg::SaveTitle& title) {
+	if (title.timestamp > latest_time) {
+		latest_time = title.timestamp;
 		latest_slot = id;
 	}
 }
 
-void Scene_File::PopulateSaveWindow(Window_SaveFile& win, int id) {
-	// Try to access file
-	std::stringstream ss;
-	ss << "Save" << (id <= 8 ? "0" : "") << (id + 1) << ".lsd";
+void Scene_File::PopulateSaveWindow(Window_SaveFile& win, int /* id */) {
+	// Filled by UpdateSaveSlots once the slot loader read the file
+	win.SetLoading(true);
+}
+
+void Scene_File::UpdateSaveSlots() {
+	if (!slot_loader) {
+		return;
+	}
 
-	std::string file = tree->FindFile(ss.str());
+	for (auto& slot: slot_loader->Poll()) {
+		auto& win = *file_windows[slot.index];
+		win.SetLoading(false);
 
-	if (!file.empty()) {
-		// File found
-		auto save_stream = FileFinder::OpenInputStream(file);
-		if (!save_stream) {
-			Output::Debug("Save {} read error", file);
+		if (slot.state == SaveMetadata::Loader::State::Valid) {
+			PopulatePartyFaces(win, slot.index, slot.title);
+			UpdateLatestTimestamp(slot.index, slot.title);
+		} else if (slot.state == SaveMetadata::Loader::State::Corrupted) {
 			win.SetCorrupted(true);
-			return;
 		}
+		win.Refresh();
+	}
 
-		std::unique_ptr<lcf::rpg::Save> savegame = lcf::LSD_Reader::Load(save_stream, Player::encoding);
+	if (slot_loader->IsDone()) {
+		slot_loader.reset();
+	}
 
-		if (savegame) {
-			PopulatePartyFaces(win, id, *savegame);
-			UpdateLatestTimestamp(id, *savegame);
-		} else {
-			Output::Debug("Save {} corrupted", file);
-			win.SetCorrupted(true);
-		}
+	if (!cursor_moved && index != latest_slot) {
+		index = latest_slot;
+		top_index = std::max(0, index - 2);
+		Refresh();
 	}
 }
 
@@ -111,8 +115,12 @@ void Scene_File::Start() {
 	CreateHelpWindow();
 	border_top = Scene_File::MakeBorderSprite(32);
 
+	// Saves still written by the worker must be visible
+	SaveWriter::Flush();
+
 	// Refresh File Finder Save Folder
 	tree = FileFinder::CreateSaveDirectoryTree();
+	slot_loader.reset(new SaveMetadata::Loader(*tree, 15, Player::player_config.save_metadata.Get()));
 
 	for (int i = 0; i < 15; i++) {
 		std::shared_ptr<Window_SaveFile>
@@ -130,6 +138,8 @@ void Scene_File::Start() {
 	up_arrow = Scene_File::MakeArrowSprite(false);
 	down_arrow = Scene_File::MakeArrowSprite(true);
 
+	UpdateSaveSlots();
+
 	index = latest_slot;
 	top_index = std::max(0, index - 2);
 
@@ -150,6 +160,7 @@ void Scene_File::Refresh() {
 }
 
 void Scene_File::Update() {
+	UpdateSaveSlots();
 	UpdateArrows();
 
 	if (IsWindowMoving()) {
@@ -215,8 +226,10 @@ void Scene_File::Update() {
 
 	//top_index = std::min(top_index, std::max(top_index, index - 3 + 1));
 
-	if (top_index != old_top_index || index != old_index)
+	if (top_index != old_top_index || index != old_index) {
+		cursor_moved = true;
 		Refresh();
+	}
 
 	for (auto& fw: file_windows) {
 		fw->Update();
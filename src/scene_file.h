@@ -21,7 +21,8 @@
 // Headers
 #include <vector>
 #include "filefinder.h"
-#include <lcf/rpg/save.h>
+#include <lcf/rpg/savetitle.h>
+#include "save_metadata.h"
 #include "scene.h"
 #include "window_help.h"
 #include "window_savefile.h"
@@ -53,8 +54,11 @@ public:
 protected:
 	virtual void CreateHelpWindow();
 	virtual void PopulateSaveWindow(Window_SaveFile& win, int id);
-	virtual void PopulatePartyFaces(Window_SaveFile& win, int id, lcf::rpg::Save& savegame);
-	virtual void UpdateLatestTimestamp(int id, lcf::rpg::Save& savegame);
+	virtual void PopulatePartyFaces(Window_SaveFile& win, int id, const lcf::rpg::SaveTitle& title);
+	virtual void UpdateLatestTimestamp(int id, const lcf::rpg::SaveTitle& title);
+
+	/** Fills the windows of the slots the background loader finished */
+	void UpdateSaveSlots();
 	static std::unique_ptr<Sprite> MakeBorderSprite(int y);
 	static std::unique_ptr<Sprite> MakeArrowSprite(bool down);
 
@@ -73,9 +77,12 @@ protected:
 	std::string message;
 
 	std::unique_ptr<DirectoryTree> tree;
+	std::unique_ptr<SaveMetadata::Loader> slot_loader;
 
 	double latest_time = 0;
 	int latest_slot = 0;
+	/** The cursor follows latest_slot until the user moves it */
+	bool cursor_moved = false;
 
 	int arrow_frame = 0;
 };
@@ -38,6 +38,7 @@
 #include "scene_load.h"
 #include "output.h"
 #include "dynrpg.h"
+#include "quick_save.h"
 
 static bool GetRunForegroundEvents(TeleportTarget::Type tt) {
 	switch (tt) {
@@ -292,6 +293,21 @@ void Scene_Map::UpdateSceneCalling() {
 			else if (Input::IsTriggered(Input::DEBUG_SAVE)) {
 				call = std::make_shared<Scene_Save>();
 			}
+			else if (Input::IsTriggered(Input::DEBUG_QUICK_SAVE)) {
+				QuickSave::Store();
+			}
+			else if (Input::IsTriggered(Input::DEBUG_QUICK_LOAD)) {
+				if (QuickSave::Load()) {
+					// Events and pictures were replaced, and with them their sprites
+					spriteset.reset(new Spriteset_Map());
+					Main_Data::game_screen->InitGraphics();
+					Main_Data::game_pictures->InitGraphics();
+
+					auto current_music = Main_Data::game_system->GetCurrentBGM();
+					Main_Data::game_system->BgmStop();
+					Main_Data::game_system->BgmPlay(current_music);
+				}
+			}
 		}
 	}
 
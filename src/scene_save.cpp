@@ -39,6 +39,8 @@
 #include <lcf/lsd/reader.h>
 #include "output.h"
 #include "player.h"
+#include "save_metadata.h"
+#include "save_writer.h"
 #include "scene_save.h"
 #include "version.h"
 
@@ -57,13 +59,38 @@ void Scene_Save::Start() {
 }
 
 void Scene_Save::Action(int index) {
-	Save(*tree, index + 1);
+	// The loader may still read the slot that is overwritten now
+	slot_loader.reset();
 
-	Scene::Pop();
+	save_job = Save(*tree, index + 1);
+	if (!save_job) {
+		Scene::Pop();
+	}
+}
+
+void Scene_Save::Update() {
+	if (save_job) {
+		// Stay in the menu until the worker wrote the save
+		if (!save_job->IsDone()) {
+			return;
+		}
+
+		if (save_job->IsSuccess()) {
+			SyncFilesystem();
+		} else {
+			Output::Warning("Failed saving to {}", save_job->GetFilename());
+		}
+		save_job.reset();
+
+		Scene::Pop();
+		return;
+	}
+
+	Scene_File::Update();
 }
 
 std::string Scene_Save::GetSaveFilename(const DirectoryTreeView& tree, int slot_id) {
-	const auto save_file = fmt::format("Save{:02d}.lsd", slot_id);
+	const auto save_file = SaveMetadata::GetSaveName(slot_id);
 
 	Output::Debug("Saving to {}", save_file);
 
@@ -75,23 +102,39 @@ std::string Scene_Save::GetSaveFilename(const DirectoryTreeView& tree, int slot_
 	return filename;
 }
 
-void Scene_Save::Save(const DirectoryTreeView& tree, int slot_id, bool prepare_save) {
+SaveWriter::JobRef Scene_Save::Save(const DirectoryTreeView& tree, int slot_id, bool prepare_save) {
 	const auto filename = GetSaveFilename(tree, slot_id);
-	auto save_stream = FileFinder::OpenOutputStream(filename);
-	if (!save_stream) {
-		Output::Warning("Failed saving to {}", filename);
-		return;
+
+	// An existing sidecar is replaced or deleted even when the option is off
+	const bool write_sidecar = Player::player_config.save_metadata.Get();
+	const auto sidecar_file = SaveMetadata::GetSidecarName(slot_id);
+	std::string sidecar_filename = tree.FindFile(sidecar_file);
+	if (sidecar_filename.empty() && write_sidecar) {
+		sidecar_filename = tree.MakePath(sidecar_file);
 	}
 
-	Save(save_stream, slot_id, prepare_save);
+	auto save = CreateSaveGame(slot_id, prepare_save);
+	DynRpg::Save(slot_id);
+
+	return SaveWriter::Submit(filename, std::move(save), GetEngineVersion(),
+			Player::encoding, std::move(sidecar_filename), write_sidecar);
 }
 
-void Scene_Save::Save(std::ostream& os, int slot_id, bool prepare_save) {
+lcf::rpg::SaveTitle Scene_Save::Save(std::ostream& os, int slot_id, bool prepare_save) {
+	auto save = CreateSaveGame(slot_id, prepare_save);
+	DynRpg::Save(slot_id);
+
+	lcf::LSD_Reader::Save(os, save, GetEngineVersion(), Player::encoding);
+
+	SyncFilesystem();
+
+	return save.title;
+}
 
+lcf::rpg::Save Scene_Save::CreateSaveGame(int slot_id, bool prepare_save) {
 	lcf::rpg::Save save;
 	auto& title = save.title;
 	// TODO: Maybe find a better place to setup the save file?
-
 	int size = (int)Main_Data::game_party->GetActors().size();
 	Game_Actor* actor;
 
@@ -146,11 +189,15 @@ void Scene_Save::Save(std::ostream& os, int slot_id, bool prepare_save) {
 			sme.map_id = 0;
 		}
 	}
-	auto lcf_engine = Player::IsRPG2k3() ? lcf::EngineVersion::e2k3 : lcf::EngineVersion::e2k;
-	lcf::LSD_Reader::Save(os, save, lcf_engine, Player::encoding);
 
-	DynRpg::Save(slot_id);
+	return save;
+}
 
+lcf::EngineVersion Scene_Save::GetEngineVersion() {
+	return Player::IsRPG2k3() ? lcf::EngineVersion::e2k3 : lcf::EngineVersion::e2k;
+}
+
+void Scene_Save::SyncFilesystem() {
 #ifdef EMSCRIPTEN
 	// Save changed file system
 	EM_ASM({
@@ -158,7 +205,6 @@ void Scene_Save::Save(std::ostream& os, int slot_id, bool prepare_save) {
 		});
 	});
 #endif
-
 }
 
 bool Scene_Save::IsSlotValid(int) {
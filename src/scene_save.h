@@ -22,6 +22,7 @@
 #include <vector>
 #include "scene.h"
 #include "scene_file.h"
+#include "save_writer.h"
 
 /**
  * Scene_Item class.
@@ -35,13 +36,51 @@ public:
 	Scene_Save();
 
 	void Start() override;
+	void Update() override;
 
 	void Action(int index) override;
 	bool IsSlotValid(int index) override;
 
 	static std::string GetSaveFilename(const DirectoryTreeView& tree, int slot_id);
-	static void Save(const DirectoryTreeView& tree, int slot_id, bool prepare_save = true);
-	static void Save(std::ostream& os, int slot_id, bool prepare_save = true);
+
+	/**
+	 * Collects the game state and queues it for writing on the save worker.
+	 *
+	 * @param tree save directory
+	 * @param slot_id save slot (1 based)
+	 * @param prepare_save whether the save count and timestamp are updated
+	 * @return job for polling the result
+	 */
+	static SaveWriter::JobRef Save(const DirectoryTreeView& tree, int slot_id, bool prepare_save = true);
+
+	/**
+	 * Writes the current game state as a save.
+	 *
+	 * @param os stream to write to
+	 * @param slot_id save slot (1 based)
+	 * @param prepare_save whether the save count and timestamp are updated
+	 * @return title of the written save
+	 */
+	static lcf::rpg::SaveTitle Save(std::ostream& os, int slot_id, bool prepare_save = true);
+
+	/**
+	 * Collects the current game state into a save.
+	 * Plugin state is not part of the save and not written.
+	 *
+	 * @param slot_id save slot (1 based)
+	 * @param prepare_save whether the save count and timestamp are updated
+	 * @return the save
+	 */
+	static lcf::rpg::Save CreateSaveGame(int slot_id, bool prepare_save = true);
+
+	/** @return engine format of saves of the current game */
+	static lcf::EngineVersion GetEngineVersion();
+
+private:
+	static void SyncFilesystem();
+
+	/** Save being written, the scene is left when it finished */
+	SaveWriter::JobRef save_job;
 };
 
 #endif
@@ -23,13 +23,32 @@
 #include "main_data.h"
 #include "screen.h"
 #include "drawable_mgr.h"
+#include "player.h"
 
 Screen::Screen() : Drawable(Priority_Screen)
 {
 	DrawableMgr::Register(this);
 }
 
+bool Screen::IsTonePassEnabled() {
+	return Player::video_config.screen_tone_pass.Get();
+}
+
+Tone Screen::GetSpriteTone() {
+	if (IsTonePassEnabled()) {
+		return Tone();
+	}
+	return Main_Data::game_screen->GetTone();
+}
+
 void Screen::Draw(Bitmap& dst) {
+	if (IsTonePassEnabled()) {
+		auto tone = Main_Data::game_screen->GetTone();
+		if (tone != Tone()) {
+			dst.ToneBlit(0, 0, dst, dst.GetRect(), tone, Opacity::Opaque());
+		}
+	}
+
 	auto flash_color = Main_Data::game_screen->GetFlashColor();
 	if (flash_color.alpha > 0) {
 		if (!flash) {
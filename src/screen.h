@@ -23,6 +23,7 @@
 #include "bitmap.h"
 #include "drawable.h"
 #include "system.h"
+#include "tone.h"
 
 /**
  * A special drawable for handling screen effects.
@@ -38,6 +39,22 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	/**
+	 * When the screen tone pass is enabled the screen tone is applied once
+	 * to everything drawn below this drawable instead of to every sprite.
+	 *
+	 * @return whether the screen tone pass is enabled
+	 */
+	static bool IsTonePassEnabled();
+
+	/**
+	 * Returns the tone sprites drawn below the screen must apply themselves.
+	 * This is the screen tone or the neutral tone when the tone pass is enabled.
+	 *
+	 * @return tone for sprites below the screen
+	 */
+	static Tone GetSpriteTone();
+
 private:
 	BitmapRef flash;
 };
@@ -19,6 +19,7 @@
 #include "battle_animation.h"
 #include "game_enemy.h"
 #include "sprite_actor.h"
+#include "screen.h"
 #include "game_battler.h"
 #include "game_actor.h"
 #include "game_screen.h"
@@ -271,7 +272,7 @@ void Sprite_Actor::Draw(Bitmap& dst) {
 		return;
 	}
 
-	SetTone(Main_Data::game_screen->GetTone());
+	SetTone(Screen::GetSpriteTone());
 	SetX(battler->GetDisplayX());
 	SetY(battler->GetDisplayY());
 	SetFlashEffect(battler->GetFlashColor());
@@ -20,6 +20,7 @@
 #include "game_enemy.h"
 #include "game_screen.h"
 #include "sprite_enemy.h"
+#include "screen.h"
 #include "bitmap.h"
 #include "cache.h"
 #include "main_data.h"
@@ -115,7 +116,7 @@ void Sprite_Enemy::Draw(Bitmap& dst) {
 	SetZoomX(zoom);
 	SetZoomY(zoom);
 
-	SetTone(Main_Data::game_screen->GetTone());
+	SetTone(Screen::GetSpriteTone());
 	SetX(enemy->GetDisplayX());
 	SetY(enemy->GetDisplayY());
 	SetFlashEffect(enemy->GetFlashColor());
@@ -60,7 +60,7 @@ Spriteset_Battle::Spriteset_Battle(const std::string bg_name, int terrain_id)
 }
 
 void Spriteset_Battle::Update() {
-	Tone new_tone = Main_Data::game_screen->GetTone();
+	Tone new_tone = Screen::GetSpriteTone();
 
 	// Handle background change
 	const auto& current_bg = Game_Battle::GetBackground();
@@ -64,7 +64,7 @@ Spriteset_Map::Spriteset_Map() {
 
 // Update
 void Spriteset_Map::Update() {
-	Tone new_tone = Main_Data::game_screen->GetTone();
+	Tone new_tone = Screen::GetSpriteTone();
 
 	tilemap->SetOx(Game_Map::GetDisplayX() / (SCREEN_TILE_SIZE / TILE_SIZE));
 	tilemap->SetOy(Game_Map::GetDisplayY() / (SCREEN_TILE_SIZE / TILE_SIZE));
@@ -75,9 +75,9 @@ void Spriteset_Map::Update() {
 		character_sprites[i]->SetTone(new_tone);
 	}
 
-	std::string name = Game_Map::Parallax::GetName();
-	if (name != panorama_name) {
-		panorama_name = name;
+	StringView name = Game_Map::Parallax::GetName();
+	if (name != ToStringView(panorama_name)) {
+		panorama_name = ToString(name);
 		if (name.empty()) {
 			panorama->SetBitmap(BitmapRef());
 		} else {
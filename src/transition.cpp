@@ -21,6 +21,7 @@
 #include <vector>
 #include <array>
 #include <cmath>
+#include <cstring>
 
 #include "transition.h"
 #include "async_handler.h"
@@ -33,8 +34,101 @@
 #include "drawable.h"
 #include "drawable_mgr.h"
 #include "output.h"
+#include "pixel_ops.h"
 #include "rand.h"
 
+namespace {
+/** @return whether the fast blits below can access the pixels of all bitmaps as 32 bit words */
+bool CanBlitWords(const Bitmap& dst, const Bitmap& src1, const Bitmap& src2) {
+	return dst.HasPixelFormatLayout() && src1.HasPixelFormatLayout() && src2.HasPixelFormatLayout();
+}
+
+/**
+ * Blends two opaque 32 bit screens of the same format.
+ * Two channels are processed at once in every 32 bit word, the loop has
+ * no branches and is vectorized by the compiler.
+ */
+void CrossfadeBlit(Bitmap& dst, const Bitmap& src1, const Bitmap& src2, int opacity) {
+	const int w = std::min({ dst.width(), src1.width(), src2.width() });
+	const int h = std::min({ dst.height(), src1.height(), src2.height() });
+
+	// 0..255 -> 0..256 so that full opacity yields src2 exactly
+	const uint32_t a = opacity + (opacity >> 7);
+	const uint32_t ia = 256 - a;
+
+	for (int y = 0; y < h; ++y) {
+		auto* d = PixelOps::Row(dst, y);
+		auto* s1 = PixelOps::Row(src1, y);
+		auto* s2 = PixelOps::Row(src2, y);
+
+		for (int x = 0; x < w; ++x) {
+			const uint32_t p1 = s1[x];
+			const uint32_t p2 = s2[x];
+			const uint32_t rb = (((p1 & 0x00FF00FF) * ia + (p2 & 0x00FF00FF) * a) >> 8) & 0x00FF00FF;
+			const uint32_t ag = (((p1 >> 8) & 0x00FF00FF) * ia + ((p2 >> 8) & 0x00FF00FF) * a) & 0xFF00FF00;
+			d[x] = rb | ag;
+		}
+	}
+}
+
+/**
+ * Fills the mosaic lookup table of one axis. Every pixel is mapped to the
+ * pixel sampled for its block. Blocks are centered on the screen and the
+ * first block samples its last pixel, which is always visible.
+ */
+void MakeMosaicTable(std::vector<int>& table, int length, int size) {
+	const int offset = ((size - length % size) % size) / 2;
+
+	table.resize(length);
+	for (int i = 0; i < length; ++i) {
+		int block = (i + offset) / size;
+		table[i] = block == 0 ? size - 1 : block * size;
+	}
+}
+
+/** MosaicBlit for bitmaps of any pixel format, every block is one stretched pixel */
+void MosaicStretchBlit(Bitmap& dst, const Bitmap& src, const std::vector<int>& src_x, const std::vector<int>& src_y) {
+	const int w = std::min<int>(dst.width(), src_x.size());
+	const int h = std::min<int>(dst.height(), src_y.size());
+
+	for (int y = 0; y < h;) {
+		int y_end = y + 1;
+		while (y_end < h && src_y[y_end] == src_y[y]) {
+			++y_end;
+		}
+		for (int x = 0; x < w;) {
+			int x_end = x + 1;
+			while (x_end < w && src_x[x_end] == src_x[x]) {
+				++x_end;
+			}
+			dst.StretchBlit(Rect(x, y, x_end - x, y_end - y), src, Rect(src_x[x], src_y[y], 1, 1), Opacity::Opaque());
+			x = x_end;
+		}
+		y = y_end;
+	}
+}
+
+void MosaicBlit(Bitmap& dst, const Bitmap& src, const std::vector<int>& src_x, const std::vector<int>& src_y) {
+	const int w = std::min<int>(dst.width(), src_x.size());
+	const int h = std::min<int>(dst.height(), src_y.size());
+
+	for (int y = 0; y < h; ++y) {
+		auto* d = PixelOps::Row(dst, y);
+
+		if (y > 0 && src_y[y] == src_y[y - 1]) {
+			// Same block row, reuse the previous line
+			std::memcpy(d, PixelOps::Row(dst, y - 1), w * sizeof(uint32_t));
+			continue;
+		}
+
+		auto* s = PixelOps::Row(src, src_y[y]);
+		for (int x = 0; x < w; ++x) {
+			d[x] = s[src_x[x]];
+		}
+	}
+}
+} // anonymous namespace
+
 int Transition::GetDefaultFrames(Transition::Type type)
 {
 	switch (type) {
@@ -96,6 +190,7 @@ void Transition::Init(Type type, Scene *linked_scene, int duration, bool next_er
 
 	screen1.reset();
 	screen2.reset();
+	composed_percentage = -1;
 
 	// Show Screen, the current frame is captured immediately
 	if (!next_erase) {
@@ -120,7 +215,7 @@ void Transition::Init(Type type, Scene *linked_scene, int duration, bool next_er
 void Transition::SetAttributesTransitions() {
 	int w, h, beg_i, mid_i, end_i, length;
 
-	zoom_position = std::vector<int>(2);
+	zoom_position = {};
 	// FIXME: Break this dependency on DisplayUI
 	random_blocks = std::vector<uint32_t>(DisplayUi->GetWidth() * DisplayUi->GetHeight() / (size_random_blocks * size_random_blocks));
 	for (uint32_t i = 0; i < random_blocks.size(); i++) {
@@ -171,17 +266,120 @@ void Transition::SetAttributesTransitions() {
 	}
 }
 
+bool Transition::UpdateComposed(int percentage) {
+	switch (transition_type) {
+	case TransitionFadeIn:
+	case TransitionFadeOut:
+	case TransitionBlindOpen:
+	case TransitionBlindClose:
+	case TransitionVerticalStripesIn:
+	case TransitionVerticalStripesOut:
+	case TransitionHorizontalStripesIn:
+	case TransitionHorizontalStripesOut:
+	case TransitionMosaicIn:
+	case TransitionMosaicOut:
+		break;
+	default:
+		return false;
+	}
+
+	int w = screen1->GetWidth();
+	int h = screen1->GetHeight();
+
+	if (composed_percentage < 0) {
+		if (!composed || composed->GetWidth() != w || composed->GetHeight() != h) {
+			composed = Bitmap::Create(w, h, false);
+		}
+		composed->Blit(0, 0, *screen1, screen1->GetRect(), Opacity::Opaque());
+		mosaic_size = 0;
+	} else if (percentage == composed_percentage) {
+		return true;
+	}
+
+	// The blind and stripe effects only ever replace screen1 with screen2.
+	// Only the strips which were added since the last update are drawn.
+	const int prev = std::max(composed_percentage, 0);
+	auto& dst = *composed;
+
+	switch (transition_type) {
+	case TransitionFadeIn:
+	case TransitionFadeOut:
+		if (CanBlitWords(dst, *screen1, *screen2)) {
+			CrossfadeBlit(dst, *screen1, *screen2, 255 * percentage / 100);
+		} else {
+			dst.Blit(0, 0, *screen1, screen1->GetRect(), Opacity::Opaque());
+			dst.Blit(0, 0, *screen2, screen2->GetRect(), 255 * percentage / 100);
+		}
+		break;
+	case TransitionBlindOpen:
+		for (int i = 0; i < h / 8; i++) {
+			int y = i * 8 + 8 - 8 * percentage / 100;
+			dst.Blit(0, y, *screen2, Rect(0, y, w, 8 * percentage / 100 - 8 * prev / 100), Opacity::Opaque());
+		}
+		break;
+	case TransitionBlindClose:
+		for (int i = 0; i < h / 8; i++) {
+			int y = i * 8 + 8 * prev / 100;
+			dst.Blit(0, y, *screen2, Rect(0, y, w, 8 * percentage / 100 - 8 * prev / 100), Opacity::Opaque());
+		}
+		break;
+	case TransitionVerticalStripesIn:
+	case TransitionVerticalStripesOut:
+		for (int i = h / 6 * prev / 100; i < h / 6 * percentage / 100; i++) {
+			dst.Blit(0, i * 6, *screen2, Rect(0, i * 6, w, 3), Opacity::Opaque());
+			dst.Blit(0, h - 3 - i * 6, *screen2, Rect(0, h - 3 - i * 6, w, 3), Opacity::Opaque());
+		}
+		break;
+	case TransitionHorizontalStripesIn:
+	case TransitionHorizontalStripesOut:
+		for (int i = w / 8 * prev / 100; i < w / 8 * percentage / 100; i++) {
+			dst.Blit(i * 8, 0, *screen2, Rect(i * 8, 0, 4, h), Opacity::Opaque());
+			dst.Blit(w - 4 - i * 8, 0, *screen2, Rect(w - 4 - i * 8, 0, 4, h), Opacity::Opaque());
+		}
+		break;
+	case TransitionMosaicIn:
+	case TransitionMosaicOut:
+		{
+			// If TransitionMosaicIn, invert percentage and screen:
+			auto p = (transition_type == TransitionMosaicIn) ? 100 - percentage : percentage;
+			auto& screen = (transition_type == TransitionMosaicIn) ? *screen2 : *screen1;
+
+			int m_size = (p + 1) * 4 / 10;
+			if (m_size > 1) {
+				// The tables only change when the block size changes
+				if (m_size != mosaic_size) {
+					MakeMosaicTable(mosaic_src_x, w, m_size);
+					MakeMosaicTable(mosaic_src_y, h, m_size);
+					if (CanBlitWords(dst, screen, screen)) {
+						MosaicBlit(dst, screen, mosaic_src_x, mosaic_src_y);
+					} else {
+						MosaicStretchBlit(dst, screen, mosaic_src_x, mosaic_src_y);
+					}
+				}
+			} else {
+				dst.Blit(0, 0, screen, screen.GetRect(), Opacity::Opaque());
+			}
+			mosaic_size = m_size;
+		}
+		break;
+	default:
+		break;
+	}
+
+	composed_percentage = percentage;
+	return true;
+}
+
 void Transition::Draw(Bitmap& dst) {
 	if (!IsActive())
 		return;
 
-	std::vector<int> z_pos(2), z_size(2), z_length(2);
+	std::array<int, 2> z_pos, z_size, z_length;
 	int z_min, z_max, z_percent, z_fixed_pos, z_fixed_size;
-	uint8_t m_r, m_g, m_b, m_a;
-	uint32_t *m_pointer, blocks_to_print;
-	int m_size;
+	uint32_t blocks_to_print;
 
-	BitmapRef screen_pointer1, screen_pointer2;
+	Bitmap* screen_pointer1;
+	Bitmap* screen_pointer2;
 	int w = dst.GetWidth();
 	int h = dst.GetHeight();
 
@@ -193,12 +391,12 @@ void Transition::Draw(Bitmap& dst) {
 
 	int percentage = (current_frame) * 100 / (total_frames);
 
+	if (UpdateComposed(percentage)) {
+		dst.Blit(0, 0, *composed, composed->GetRect(), Opacity::Opaque());
+		return;
+	}
+
 	switch (transition_type) {
-	case TransitionFadeIn:
-	case TransitionFadeOut:
-		dst.Blit(0, 0, *screen1, screen1->GetRect(), 255);
-		dst.Blit(0, 0, *screen2, screen2->GetRect(), 255 * percentage / 100);
-		break;
 	case TransitionRandomBlocks:
 	case TransitionRandomBlocksDown:
 	case TransitionRandomBlocksUp:
@@ -214,40 +412,6 @@ void Transition::Draw(Bitmap& dst) {
 		dst.Blit(0, 0, *random_block_transition, random_block_transition->GetRect(), Opacity::Opaque());
 		current_blocks_print = blocks_to_print;
 		break;
-	case TransitionBlindOpen:
-		for (int i = 0; i < h / 8; i++) {
-			dst.Blit(0, i * 8, *screen1, Rect(0, i * 8, w, 8 - 8 * percentage / 100), 255);
-			dst.Blit(0, i * 8 + 8 - 8 * percentage / 100, *screen2, Rect(0, i * 8 + 8 - 8 * percentage / 100, w, 8 * percentage / 100), 255);
-		}
-		break;
-	case TransitionBlindClose:
-		for (int i = 0; i < h / 8; i++) {
-			dst.Blit(0, i * 8 + 8 * percentage / 100, *screen1, Rect(0, i * 8 + 8 * percentage / 100, w, 8 - 8 * percentage / 100), 255);
-			dst.Blit(0, i * 8, *screen2, Rect(0, i * 8, w, 8 * percentage / 100), 255);
-		}
-		break;
-	case TransitionVerticalStripesIn:
-	case TransitionVerticalStripesOut:
-		for (int i = 0; i < h / 6 + 1 - h / 6 * percentage / 100; i++) {
-			dst.Blit(0, i * 6 + 3, *screen1, Rect(0, i * 6 + 3, w, 3), 255);
-			dst.Blit(0, h - i * 6, *screen1, Rect(0, h - i * 6, w, 3), 255);
-		}
-		for (int i = 0; i < h / 6 * percentage / 100; i++) {
-			dst.Blit(0, i * 6, *screen2, Rect(0, i * 6, w, 3), 255);
-			dst.Blit(0, h - 3 - i * 6, *screen2, Rect(0, h - 3 - i * 6, w, 3), 255);
-		}
-		break;
-	case TransitionHorizontalStripesIn:
-	case TransitionHorizontalStripesOut:
-		for (int i = 0; i < w / 8 + 1 - w / 8 * percentage / 100; i++) {
-			dst.Blit(i * 8 + 4, 0, *screen1, Rect(i * 8 + 4, 0, 4, h), 255);
-			dst.Blit(w - i * 8, 0, *screen1, Rect(w - i * 8, 0, 4, h), 255);
-		}
-		for (int i = 0; i < w / 8 * percentage / 100; i++) {
-			dst.Blit(i * 8, 0, *screen2, Rect(i * 8, 0, 4, h), 255);
-			dst.Blit(w - 4 - i * 8, 0, *screen2, Rect(w - 4 - i * 8, 0, 4, h), 255);
-		}
-		break;
 	case TransitionBorderToCenterIn:
 	case TransitionBorderToCenterOut:
 		dst.Blit(0, 0, *screen2, screen2->GetRect(), 255);
@@ -282,8 +446,8 @@ void Transition::Draw(Bitmap& dst) {
 	case TransitionVerticalDivision:
 		// If TransitionVerticalCombine, invert percentage and screen:
 		if (transition_type == TransitionVerticalCombine) { percentage = 100 - percentage; }
-		screen_pointer1 = transition_type == TransitionVerticalCombine ? screen2 : screen1;
-		screen_pointer2 = transition_type == TransitionVerticalCombine ? screen1 : screen2;
+		screen_pointer1 = (transition_type == TransitionVerticalCombine ? screen2 : screen1).get();
+		screen_pointer2 = (transition_type == TransitionVerticalCombine ? screen1 : screen2).get();
 
 		dst.Blit(0, -(h / 2) * percentage / 100, *screen_pointer1, Rect(0, 0, w, h / 2), 255);
 		dst.Blit(0, h / 2 + (h / 2) * percentage / 100, *screen_pointer1, Rect(0, h / 2, w, h / 2), 255);
@@ -293,8 +457,8 @@ void Transition::Draw(Bitmap& dst) {
 	case TransitionHorizontalDivision:
 		// If TransitionHorizontalCombine, invert percentage and screen:
 		if (transition_type == TransitionHorizontalCombine) { percentage = 100 - percentage; }
-		screen_pointer1 = transition_type == TransitionHorizontalCombine ? screen2 : screen1;
-		screen_pointer2 = transition_type == TransitionHorizontalCombine ? screen1 : screen2;
+		screen_pointer1 = (transition_type == TransitionHorizontalCombine ? screen2 : screen1).get();
+		screen_pointer2 = (transition_type == TransitionHorizontalCombine ? screen1 : screen2).get();
 
 		dst.Blit(-(w / 2) * percentage / 100, 0, *screen_pointer1, Rect(0, 0, w / 2, h), 255);
 		dst.Blit(w / 2 + (w / 2) * percentage / 100, 0, *screen_pointer1, Rect(w / 2, 0, w / 2, h), 255);
@@ -304,8 +468,8 @@ void Transition::Draw(Bitmap& dst) {
 	case TransitionCrossDivision:
 		// If TransitionCrossCombine, invert percentage and screen:
 		if (transition_type == TransitionCrossCombine) { percentage = 100 - percentage; }
-		screen_pointer1 = transition_type == TransitionCrossCombine ? screen2 : screen1;
-		screen_pointer2 = transition_type == TransitionCrossCombine ? screen1 : screen2;
+		screen_pointer1 = (transition_type == TransitionCrossCombine ? screen2 : screen1).get();
+		screen_pointer2 = (transition_type == TransitionCrossCombine ? screen1 : screen2).get();
 
 		dst.Blit(-(w / 2) * percentage / 100, -(h / 2) * percentage / 100, *screen_pointer1, Rect(0, 0, w / 2, h / 2), 255);
 		dst.Blit(w / 2 + (w / 2) * percentage / 100, -(h / 2) * percentage / 100, *screen_pointer1, Rect(w / 2, 0, w / 2, h / 2), 255);
@@ -319,7 +483,7 @@ void Transition::Draw(Bitmap& dst) {
 	case TransitionZoomOut:
 		// If TransitionZoomOut, invert percentage and screen:
 		if (transition_type == TransitionZoomOut) { percentage = 100 - percentage; }
-		screen_pointer1 = transition_type == TransitionZoomOut ? screen2 : screen1;
+		screen_pointer1 = (transition_type == TransitionZoomOut ? screen2 : screen1).get();
 
 		// X Coordinate: [0]   Y Coordinate: [1]
 		z_length[0] = w;
@@ -345,24 +509,6 @@ void Transition::Draw(Bitmap& dst) {
 
 		dst.StretchBlit(Rect(0, 0, w, h), *screen_pointer1, Rect(z_pos[0], z_pos[1], z_size[0], z_size[1]), 255);
 		break;
-	case TransitionMosaicIn:
-	case TransitionMosaicOut:
-		// If TransitionMosaicIn, invert percentage and screen:
-		if (transition_type == TransitionMosaicIn) { percentage = 100 - percentage; }
-		screen_pointer1 = transition_type == TransitionMosaicIn ? screen2 : screen1;
-
-		m_size = (percentage + 1) * 4 / 10;
-		if (m_size > 1)
-			for (int i = 0; i < w; i += m_size)
-				for (int j = 0; j < h; j += m_size) {
-					m_pointer = static_cast<uint32_t *>(screen_pointer1->pixels()) + j * w + i;
-					m_pointer += ((i == 0 ? 1 : 0) + (j == 0 ? w : 0)) * (m_size - 1);
-					dst.pixel_format.uint32_to_rgba(*m_pointer, m_r, m_g, m_b, m_a);
-					dst.FillRect(Rect(i - ((m_size - w % m_size) % m_size) / 2, j - ((m_size - h % m_size) % m_size) / 2, m_size, m_size), Color(m_r, m_g, m_b, m_a));
-				}
-		else
-			dst.Blit(0, 0, *screen_pointer1, screen_pointer1->GetRect(), 255);
-		break;
 	case TransitionWaveIn:
 	case TransitionWaveOut:
 		{
@@ -382,6 +528,9 @@ void Transition::Draw(Bitmap& dst) {
 		break;
 	case TransitionNone:
 		break;
+	default:
+		// Drawn by UpdateComposed
+		break;
 	}
 }
 
@@ -19,6 +19,7 @@
 #define EP_TRANSITION_H
 
 // Headers
+#include <array>
 #include <vector>
 #include <string>
 #include "drawable.h"
@@ -125,6 +126,11 @@ private:
 	BitmapRef screen2;
 	BitmapRef random_block_transition;
 
+	/** Persistent result of effects which only change when the percentage changes */
+	BitmapRef composed;
+	/** Percentage composed was drawn for or -1 when it must be initialized */
+	int composed_percentage = -1;
+
 	Type transition_type = TransitionNone;
 	Scene *scene = nullptr;
 	int current_frame = 0;
@@ -145,11 +151,24 @@ private:
 	int flash_duration = 0;
 	int flash_iterations = 0;
 
-	std::vector<int> zoom_position;
+	std::array<int, 2> zoom_position = {};
 	std::vector<uint32_t> random_blocks;
 	uint32_t current_blocks_print;
 
+	/** Source column and row of every screen pixel for the current mosaic block size */
+	std::vector<int> mosaic_src_x;
+	std::vector<int> mosaic_src_y;
+	int mosaic_size = 0;
+
 	void SetAttributesTransitions();
+
+	/**
+	 * Updates the composed screen for the incremental effects.
+	 *
+	 * @param percentage progress of the transition
+	 * @return false when the transition type is not composed incrementally
+	 */
+	bool UpdateComposed(int percentage);
 };
 
 inline Transition& Transition::instance() {
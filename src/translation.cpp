@@ -18,9 +18,18 @@
 #include "translation.h"
 
 // Headers
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
+#include <iterator>
+#include <map>
 #include <memory>
+#include "system.h"
+#ifdef HAVE_THREADS
+#  include <system_error>
+#  include <thread>
+#endif
+#include <fmt/format.h>
 #include <lcf/data.h>
 #include <lcf/rpg/terms.h>
 #include <lcf/rpg/map.h>
@@ -52,6 +61,122 @@
 #define TRCUST_REMOVEMSG        "<easyrpg:delete_page>"
 #define TRCUST_ADDMSG           "<easyrpg:new_page>"
 
+namespace {
+	/** Identifies a compiled dictionary written by Dictionary::ToCache */
+	constexpr char cache_magic[8] = { 'E', 'P', 'T', 'R', 'D', 'I', 'C', 'T' };
+	constexpr uint32_t cache_version = 2;
+
+	template <typename T>
+	void WriteInt(std::ostream& out, T value) {
+		char buf[sizeof(T)];
+		for (size_t i = 0; i < sizeof(T); ++i) {
+			buf[i] = static_cast<char>(static_cast<uint64_t>(value) >> (i * 8));
+		}
+		out.write(buf, sizeof(T));
+	}
+
+	template <typename T>
+	bool ReadInt(std::istream& in, T& value) {
+		unsigned char buf[sizeof(T)];
+		if (!in.read(reinterpret_cast<char*>(buf), sizeof(T))) {
+			return false;
+		}
+		uint64_t v = 0;
+		for (size_t i = 0; i < sizeof(T); ++i) {
+			v |= static_cast<uint64_t>(buf[i]) << (i * 8);
+		}
+		value = static_cast<T>(v);
+		return true;
+	}
+
+	void WriteString(std::ostream& out, const std::string& str) {
+		WriteInt<uint32_t>(out, str.size());
+		out.write(str.data(), str.size());
+	}
+
+	bool ReadString(std::istream& in, std::string& str) {
+		uint32_t size;
+		// Guards against huge allocations from corrupted files
+		if (!ReadInt(in, size) || size > (1u << 24)) {
+			return false;
+		}
+		str.resize(size);
+		return size == 0 || static_cast<bool>(in.read(&str[0], size));
+	}
+
+	/** Properties of a .po file the compiled cache depends on */
+	struct PoFileInfo {
+		std::string path;
+		int64_t mtime = -1;
+		int64_t size = -1;
+	};
+
+	PoFileInfo GetPoFileInfo(std::string path) {
+		PoFileInfo info;
+		info.mtime = FileFinder::GetModificationTime(path);
+		info.size = FileFinder::GetFileSize(path);
+		info.path = std::move(path);
+		return info;
+	}
+
+	/** @return Path of the compiled cache of a .po file, or "" when it cannot be cached */
+	std::string GetCachePath(const std::string& lang_id, const std::string& po_name, const PoFileInfo& info) {
+		if (!Player::player_config.translation_cache.Get() || info.mtime < 0 || Main_Data::GetSavePath().empty()) {
+			return "";
+		}
+		return FileFinder::MakePath(Main_Data::GetSavePath(), fmt::format("{}.{}.cache", lang_id, po_name));
+	}
+
+	/** Loads a compiled cache, fails when it is missing or the .po file changed */
+	bool ReadCache(const std::string& cache_path, const PoFileInfo& info, Dictionary& out) {
+		if (cache_path.empty()) {
+			return false;
+		}
+
+		auto is = FileFinder::OpenInputStream(cache_path, std::ios_base::in | std::ios_base::binary);
+		if (!is) {
+			return false;
+		}
+
+		char magic[sizeof(cache_magic)];
+		uint32_t version;
+		int64_t mtime;
+		int64_t size;
+		if (!is.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), cache_magic)
+				|| !ReadInt(is, version) || version != cache_version
+				|| !ReadInt(is, mtime) || mtime != info.mtime
+				|| !ReadInt(is, size) || size != info.size) {
+			return false;
+		}
+
+		Dictionary dict;
+		if (!Dictionary::FromCache(dict, is)) {
+			Output::Debug("Translation: Ignoring corrupted cache {}", cache_path);
+			return false;
+		}
+		out = std::move(dict);
+		return true;
+	}
+
+	void WriteCache(const std::string& cache_path, const PoFileInfo& info, const Dictionary& dict) {
+		if (cache_path.empty()) {
+			return;
+		}
+
+		auto os = FileFinder::OpenOutputStream(cache_path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		if (!os) {
+			Output::Debug("Translation: Cannot write cache {}", cache_path);
+			return;
+		}
+
+		os.write(cache_magic, sizeof(cache_magic));
+		WriteInt(os, cache_version);
+		WriteInt(os, info.mtime);
+		WriteInt(os, info.size);
+		dict.ToCache(os);
+	}
+}
+
 
 DirectoryTreeView Tr::GetTranslationTree() {
 	return Player::translation.GetRootTree();
@@ -173,56 +298,110 @@ bool Translation::ParseLanguageFiles(const std::string& lang_id)
 		return true;
 	}
 
-	// Scan for files in the directory and parse them.
+	// Scan for files in the directory. Map files are only parsed when they are used.
+	struct DatabaseFile {
+		std::string name;
+		PoFileInfo info;
+		std::unique_ptr<Dictionary>* dict = nullptr;
+		std::string data;
+		std::string error;
+		bool parse = false;
+	};
+	std::vector<DatabaseFile> db_files;
+
 	for (const auto& tr_name : *language_tree.ListDirectory()) {
 		if (tr_name.second.type != DirectoryTree::FileType::Regular) {
 			continue;
 		}
 
+		std::unique_ptr<Dictionary>* dict = nullptr;
 		if (tr_name.first == TRFILE_RPG_RT_LDB) {
-			sys = std::make_unique<Dictionary>();
-			auto is = FileFinder::OpenInputStream(language_tree.FindFile(tr_name.first));
-			if (is) {
-				ParsePoFile(std::move(is), *sys);
-			}
+			dict = &sys;
 		} else if (tr_name.first == TRFILE_RPG_RT_BATTLE) {
-			battle = std::make_unique<Dictionary>();
-			auto is = FileFinder::OpenInputStream(language_tree.FindFile(tr_name.first));
-			if (is) {
-				ParsePoFile(std::move(is), *battle);
-			}
+			dict = &battle;
 		} else if (tr_name.first == TRFILE_RPG_RT_COMMON) {
-			common = std::make_unique<Dictionary>();
-			auto is = FileFinder::OpenInputStream(language_tree.FindFile(tr_name.first));
-			if (is) {
-				ParsePoFile(std::move(is), *common);
-			}
+			dict = &common;
 		} else if (tr_name.first == TRFILE_RPG_RT_LMT) {
-			mapnames = std::make_unique<Dictionary>();
-			auto is = FileFinder::OpenInputStream(language_tree.FindFile(tr_name.first));
-			if (is) {
-				ParsePoFile(std::move(is), *mapnames);
-			}
+			dict = &mapnames;
+		}
+
+		if (dict) {
+			*dict = std::make_unique<Dictionary>();
+			DatabaseFile file;
+			file.name = tr_name.first;
+			file.info = GetPoFileInfo(language_tree.FindFile(tr_name.first));
+			file.dict = dict;
+			db_files.push_back(std::move(file));
 		} else {
-			std::unique_ptr<Dictionary> dict;
-			dict = std::make_unique<Dictionary>();
-			auto is = FileFinder::OpenInputStream(language_tree.FindFile(tr_name.first));
-			if (is) {
-				ParsePoFile(std::move(is), *dict);
-				maps[tr_name.first] = std::move(dict);
-			}
+			map_files[tr_name.first] = language_tree.FindFile(tr_name.first);
+		}
+	}
+
+	// File access happens here because the filesystem is not thread safe, only parsing is parallel.
+	for (auto& file : db_files) {
+		if (ReadCache(GetCachePath(lang_id, file.name, file.info), file.info, **file.dict)) {
+			continue;
+		}
+		auto is = FileFinder::OpenInputStream(file.info.path);
+		if (is) {
+			file.data.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+			file.parse = true;
+		}
+	}
+
+	auto parse = [](DatabaseFile& file) {
+		std::istringstream is(std::move(file.data));
+		if (!Dictionary::FromPo(**file.dict, is, &file.error)) {
+			**file.dict = Dictionary();
+		}
+	};
+
+#ifdef HAVE_THREADS
+	std::vector<std::thread> workers;
+	for (auto& file : db_files) {
+		if (!file.parse) {
+			continue;
+		}
+		try {
+			workers.emplace_back(parse, std::ref(file));
+		} catch (const std::system_error&) {
+			// No thread available, parse on this thread
+			parse(file);
+		}
+	}
+	for (auto& worker : workers) {
+		worker.join();
+	}
+#else
+	for (auto& file : db_files) {
+		if (file.parse) {
+			parse(file);
+		}
+	}
+#endif
+
+	for (auto& file : db_files) {
+		if (!file.parse) {
+			continue;
 		}
+		if (!file.error.empty()) {
+			// Same behaviour as parsing on this thread
+			Output::Error("{}", file.error);
+		}
+		WriteCache(GetCachePath(lang_id, file.name, file.info), file.info, **file.dict);
 	}
 
 	// Log
-	Output::Debug("Translation loaded {} sys, {} common, {} battle, and {} map .po files", (sys==nullptr?0:1), (battle==nullptr?0:1), (common==nullptr?0:1), maps.size());
+	Output::Debug("Translation loaded {} sys, {} common, {} battle, and found {} map .po files", (sys==nullptr?0:1), (battle==nullptr?0:1), (common==nullptr?0:1), map_files.size());
 	return true;
 }
 
-
 void Translation::RewriteDatabase()
 {
-	lcf::rpg::ForEachString(lcf::Data::data, [this](lcf::DBString& value, auto& ctxt) {
+	// Reused for every string to avoid an allocation per lookup
+	std::string key;
+
+	lcf::rpg::ForEachString(lcf::Data::data, [this, &key](lcf::DBString& value, auto& ctxt) {
 		// When we re-write the database, we only care about translations that are exactly one level deep.
 		if (ctxt.parent==nullptr || ctxt.parent->parent!=nullptr) {
 			return;
@@ -230,13 +409,17 @@ void Translation::RewriteDatabase()
 
 		// Look up the indexed form first; e.g., "actors.1.name", starting from 1 instead of 0
 		if (ctxt.index >= 0) {
-			if (sys->TranslateString<lcf::DBString>(fmt::format("{}.{}.{}", ctxt.parent->name, ctxt.parent->index+1, ctxt.name), value)) {
+			key.clear();
+			fmt::format_to(std::back_inserter(key), "{}.{}.{}", ctxt.parent->name, ctxt.parent->index+1, ctxt.name);
+			if (sys->TranslateString<lcf::DBString>(key, value)) {
 				return;
 			}
 		}
 
 		// Look up the non-indexed form second; e.g., "actors.name"
-		if (sys->TranslateString<lcf::DBString>(fmt::format("{}.{}", ctxt.parent->name, ctxt.name), value)) {
+		key.clear();
+		fmt::format_to(std::back_inserter(key), "{}.{}", ctxt.parent->name, ctxt.name);
+		if (sys->TranslateString<lcf::DBString>(key, value)) {
 			return;
 		}
 
@@ -285,352 +468,246 @@ void Translation::RewriteCommonEventMessages()
 
 
 namespace {
-	/**
-	 * Helper class for iterating over and rewriting event commands.
-	 * Starts at index 0.
-	 */
-	class CommandIterator {
-	public:
-		CommandIterator(std::vector<lcf::rpg::EventCommand>& commands) : commands(commands) {}
+	using Cmd = lcf::rpg::EventCommand::Code;
 
-		/** Returns true if the index is past the end of the command list */
-		bool Done() const {
-			return index >= commands.size();
-		}
+	bool IsCommand(const lcf::rpg::EventCommand& com, Cmd code) {
+		return static_cast<Cmd>(com.code) == code;
+	}
 
-		/** Advance the index through the command list by 1 */
-		void Advance() {
-			index += 1;
-		}
+	void AppendString(std::string& out, const lcf::DBString& str) {
+		StringView sv(str);
+		out.append(sv.data(), sv.size());
+	}
 
-		/** Retrieve the code of the EventCommand at the index */
-		lcf::rpg::EventCommand::Code CurrentCmdCode() const {
-			return static_cast<lcf::rpg::EventCommand::Code>(commands[index].code);
-		}
+	lcf::rpg::EventCommand MakeShowMessage(const std::string& line, int indent, bool base_msg_box) {
+		lcf::rpg::EventCommand com;
+		com.code = static_cast<int>(base_msg_box ? Cmd::ShowMessage : Cmd::ShowMessage_2);
+		com.indent = indent;
+		com.string = lcf::DBString(line);
+		return com;
+	}
 
-		/** Retrieve the string of the EventCommand at the index */
-		std::string CurrentCmdString() const {
-			return ToString(commands[index].string);
+	/**
+	 * Appends message boxes to a command list.
+	 * The first line of each box is a ShowMessage, the other lines are ShowMessage_2.
+	 */
+	template <typename It>
+	void AppendMessageBoxes(std::vector<lcf::rpg::EventCommand>& out, It first, It last, int indent) {
+		for (; first != last; ++first) {
+			for (size_t i = 0; i < first->size(); ++i) {
+				out.push_back(MakeShowMessage((*first)[i], indent, i == 0));
+			}
 		}
+	}
+}
 
-		/** Retrieve the indent level of the EventCommand at the index */
-		int CurrentCmdIndent() const {
-			return commands[index].indent;
-		}
 
-		/** Retrieve parameter at position 'pos' of the EventCommand at the current index, or the devValue if no such parameter exists. */
-		int CurrentCmdParam(size_t pos, int defVal) const {
-			if (pos < commands[index].parameters.size()) {
-				return commands[index].parameters[pos];
-			}
-			return defVal;
-		}
 
-		/** Returns true if the current Event Command is ShowMessage */
-		bool CurrentIsShowMessage() const {
-			return CurrentCmdCode() == lcf::rpg::EventCommand::Code::ShowMessage;
-		}
+std::vector<std::vector<std::string>> Translation::TranslateMessage(const Dictionary& dict, StringView msg) {
+	std::vector<std::vector<std::string>> res;
 
-		/** Returns true if the current Event Command is ShowMessage_2 */
-		bool CurrentIsShowMessage2() const {
-			return CurrentCmdCode() == lcf::rpg::EventCommand::Code::ShowMessage_2;
-		}
+	// Translation exists?
+	const auto* translation = dict.Find("", msg);
+	if (!translation) {
+		return res;
+	}
 
-		/** Returns true if the current Event Command is ShowChoice */
-		bool CurrentIsShowChoice() const {
-			return CurrentCmdCode() == lcf::rpg::EventCommand::Code::ShowChoice;
-		}
+	// Break the lines into message boxes based on the ADDMSG string
+	res.push_back(std::vector<std::string>());
+	size_t pos = 0;
+	while (true) {
+		const size_t end = translation->find('\n', pos);
+		StringView line(translation->data() + pos, (end == std::string::npos ? translation->size() : end) - pos);
 
-		/** Returns true if the current Event Command is ShowChoiceOption */
-		bool CurrentIsShowChoiceOption() const {
-			return CurrentCmdCode() == lcf::rpg::EventCommand::Code::ShowChoiceOption;
+		if (line == TRCUST_ADDMSG) {
+			res.push_back(std::vector<std::string>());
+		} else {
+			res.back().push_back(ToString(line));
 		}
 
-		/** Returns true if the current Event Command is ShowChoiceEnd */
-		bool CurrentIsShowChoiceEnd() const {
-			return CurrentCmdCode() == lcf::rpg::EventCommand::Code::ShowChoiceEnd;
+		// Special case: stop once you've found a REMMSG (to avoid the case where both add/rem are present)
+		if (line == TRCUST_REMOVEMSG || end == std::string::npos) {
+			break;
 		}
+		pos = end + 1;
+	}
 
-		/**
-		 * Add each line of a [ShowMessage,ShowMessage_2,...] chain to "msg_str" (followed by a newline)
-		 * and save to "indexes" the index of each ShowMessage(2) command that was used to populate this
-		 * (for rewriting later).
-		 * Advances the index until after the last ShowMessage(2) command
-		 */
-		void BuildMessageString(std::stringstream& msg_str, std::vector<size_t>& indexes) {
-			// No change if we're not on the right command.
-			if (Done() || !CurrentIsShowMessage()) {
-				return;
-			}
-
-			// Add the first line
-			msg_str << CurrentCmdString() <<"\n";
-			indexes.push_back(index);
-			Advance();
-
-			// Build lines 2 through 4
-			while (!Done() && CurrentIsShowMessage2()) {
-				msg_str << CurrentCmdString() <<"\n";
-				indexes.push_back(index);
-				Advance();
-			}
+	// Ensure we never get an empty vector (force using the REMMSG command)
+	for (std::vector<std::string>& msgbox : res) {
+		if (msgbox.empty()) {
+			msgbox.push_back("");
 		}
+	}
 
-		/**
-		 * Add each line of a [ShowChoice,ShowChoiceOption,...,ShowChoiceEnd] chain to "msg_str" (followed by a newline)
-		 * and save to "indexes" the index of each ShowChoiceOption command that was used to populate this
-		 * (for rewriting later).
-		 * Advances the index until after the (first) ShowChoice command (but it will likely still be on a ShowChoiceOption/End)
-		 */
-		void BuildChoiceString(std::stringstream& msg_str, std::vector<size_t>& indexes) {
-			// No change if we're not on the right command.
-			if (Done() || !CurrentIsShowChoice()) {
-				return;
-			}
-
-			// Advance to ChoiceOptions
-			Advance();
-			if(Done()) {
-				return;
-			}
-
-			// Choices must be on the same indent level.
-			// We have to save/restore the index, though, in the rare case that we skip something that can be translated.
-			int indent = CurrentCmdIndent();
-			size_t savedIndex = index;
-			while (!Done()) {
-				if (indent == CurrentCmdIndent()) {
-					// Handle a new index
-					if (CurrentIsShowChoiceOption() && CurrentCmdParam(0,0) < 4) {
-						msg_str << CurrentCmdString() <<"\n";
-						indexes.push_back(index);
-					}
+	return res;
+}
 
-					// Done?
-					if (CurrentIsShowChoiceEnd()) {
-						break;
-					}
-				}
-				Advance();
-			}
-			index = savedIndex;
-		}
 
-		/** Change the string value of the EventCommand at position "idx" to "newStr" */
-		void ReWriteString(size_t idx, const std::string& newStr) {
-			if (idx < commands.size()) {
-				commands[idx].string = lcf::DBString(newStr);
-			}
-		}
+void Translation::RewriteEventCommandMessage(const Dictionary& dict, std::vector<lcf::rpg::EventCommand>& commands) {
+	// The commands are moved into a new list. Translated message boxes can shrink, grow, vanish
+	// or be split into multiple boxes, so rewriting in place would shift the list for every change.
+	std::vector<lcf::rpg::EventCommand> out;
+	out.reserve(commands.size());
 
-		/**
-		 * Puts a "ShowMessage" or "ShowMessage_2" command into the command stack before position "idx".
-		 * Sets the string value to "line". Note that ShowMessage_2 is chosen if baseMsgBox is false.
-		 * This also updates the index if relevant, but it does not update external index caches.
-		 */
-		void PutShowMessageBeforeIndex(const std::string& line, size_t idx, bool baseMsgBox) {
-			// We need a reference index for the indent.
-			size_t refIndent = 0;
-			if (idx < commands.size()) {
-				refIndent = commands[idx].indent;
-			} else if (idx == commands.size() && commands.size()>0) {
-				refIndent = commands[idx-1].indent;
-			}
+	// Message boxes added by a translated choice, they go before the first ShowChoiceOption
+	std::map<size_t, std::vector<std::vector<std::string>>> choice_boxes;
 
-			if (idx <= commands.size()) {
-				lcf::rpg::EventCommand newCmd;
-				newCmd.code = static_cast<int>(baseMsgBox ? lcf::rpg::EventCommand::Code::ShowMessage : lcf::rpg::EventCommand::Code::ShowMessage_2);
-				newCmd.indent = refIndent;
-				newCmd.string = lcf::DBString(line);
-				commands.insert(commands.begin()+idx, newCmd);
+	std::string key;
+	std::vector<size_t> options;
 
-				// Update our index
-				if (index >= idx) {
-					index += 1;
-				}
-			}
+	const size_t num_commands = commands.size();
+	size_t idx = 0;
+	while (idx < num_commands) {
+		if (!choice_boxes.empty() && choice_boxes.begin()->first == idx) {
+			const auto& boxes = choice_boxes.begin()->second;
+			AppendMessageBoxes(out, boxes.begin(), boxes.end(), commands[idx].indent);
+			choice_boxes.erase(choice_boxes.begin());
 		}
 
-		/**
-		 * Remove the EventCommand at position "idx" from the command stack.
-		 * Also updates our index, if relevant.
-		 */
-		void RemoveByIndex(size_t idx) {
-			if (idx < commands.size()) {
-				commands.erase(commands.begin() + idx);
+		if (IsCommand(commands[idx], Cmd::ShowMessage)) {
+			// A message box is a ShowMessage followed by up to three ShowMessage_2 lines
+			const size_t begin = idx;
+			size_t end = begin + 1;
+			while (end < num_commands && IsCommand(commands[end], Cmd::ShowMessage_2)) {
+				++end;
+			}
 
-				// Update our index
-				if (index > idx) {
-					index -= 1;
+			key.clear();
+			for (size_t i = begin; i < end; ++i) {
+				if (i > begin) {
+					key += '\n';
 				}
+				AppendString(key, commands[i].string);
 			}
-		}
 
-		/**
-		 * Add multiple message boxes to the command stack before "idx".
-		 * The "msgs" each represent lines in new, independent message boxes (so they will have both ShowMessage and ShowMessage_2)
-		 * Also updates our index, if relevant.
-		 */
-		void InsertMultiMessageBefore(std::vector<std::vector<std::string>>& msgs, size_t idx) {
-			for (std::vector<std::string>& lines : msgs) {
-				while (!lines.empty()) {
-					PutShowMessageBeforeIndex(lines.back(), idx, lines.size()==1);
-					lines.pop_back();
+			auto msgs = TranslateMessage(dict, key);
+			if (msgs.empty()) {
+				for (; idx < end; ++idx) {
+					out.push_back(std::move(commands[idx]));
 				}
+				continue;
 			}
-		}
-
-	private:
-		std::vector<lcf::rpg::EventCommand>& commands;
-		size_t index = 0;
-	};
-}
-
-
 
-std::vector<std::vector<std::string>> Translation::TranslateMessageStream(const Dictionary& dict, const std::stringstream& msg, char trimChar) {
-	// Prepare source string
-	std::string msgStr = msg.str();
-	if (msgStr.size()>0 && msgStr.back() == trimChar) {
-		msgStr.pop_back();
-	}
+			// The last message box replaces the original box, all others are put before it.
+			std::vector<std::string>& lines = msgs.back();
 
-	// Translation exists?
-	std::vector<std::vector<std::string>> res;
-	if (dict.TranslateString<std::string>("", msgStr)) {
-		// First, get all lines.
-		std::vector<std::string> lines = Utils::Tokenize(msgStr, [](char32_t c) { return c=='\n'; });
-
-		// Now, break into message boxes based on the ADDMSG string
-		res.push_back(std::vector<std::string>());
-		for (const std::string& line : lines) {
-			if (line == TRCUST_ADDMSG) {
-				res.push_back(std::vector<std::string>());
+			// There is a special case here: if we are asked to remove a message box, we should do nothing further
+			// This command is *only* respected as the first line of a message box.
+			if (lines[0] == TRCUST_REMOVEMSG) {
+				const int indent = end < num_commands ? commands[end].indent : (out.empty() ? 0 : out.back().indent);
+				AppendMessageBoxes(out, msgs.begin(), msgs.end() - 1, indent);
 			} else {
-				res.back().push_back(line);
-			}
-
-			// Special case: stop once you've found a REMMSG (to avoid the case where both add/rem are present)
-			if (line == TRCUST_REMOVEMSG) {
-				break;
-			}
-		}
-
-		// Ensure we never get an empty vector (force using the REMMSG command)
-		for (std::vector<std::string>& msgbox : res) {
-			if (msgbox.empty()) {
-				msgbox.push_back("");
-			}
-		}
-	}
-
-	return res;
-}
+				// Trim lines down to allowed remaining (with choices).
+				const size_t maxLines = 4;
+				if (lines.size() > maxLines) {
+					lines.resize(maxLines);
+				}
 
+				AppendMessageBoxes(out, msgs.begin(), msgs.end() - 1, commands[begin].indent);
 
-void Translation::RewriteEventCommandMessage(const Dictionary& dict, std::vector<lcf::rpg::EventCommand>& commandsOrig) {
-	// A note on this function: it is (I feel) necessarily complicated, given what it's actually doing.
-	// I've tried to abstract most of this complexity away behind an "iterator" interface, so that we do not
-	// have to track the current index directly in this function.
-	CommandIterator commands(commandsOrig);
-	while (!commands.Done()) {
-		// We only need to deal with either Message or Choice commands
-		if (commands.CurrentIsShowMessage()) {
-			// Build up the lines of Message texts
-			std::stringstream msg_str;
-			std::vector<size_t> msg_indexes;
-			commands.BuildMessageString(msg_str, msg_indexes);
-
-			// Go through messages first, including possible choices
-			if (msg_indexes.size()>0) {
-				// Get our lines, possibly including "combined"
-				std::vector<std::vector<std::string>> msgs = TranslateMessageStream(dict, msg_str, '\n');
-				if (msgs.size()>0) {
-					// The complex replacement logic is based on the last message box, then all remaining things are simply left back in.
-					std::vector<std::string>& lines = msgs.back();
-
-					// There is a special case here: if we are asked to remove a message box, we should do nothing further
-					// This command is *only* respected as the first line of a message box.
-					if (lines[0]==TRCUST_REMOVEMSG) {
-						// Clear all message boxes in reverse order.
-						while (!msg_indexes.empty()) {
-							commands.RemoveByIndex(msg_indexes.back());
-							msg_indexes.pop_back();
-						}
+				// Reuse the original commands, additional lines take the indent of the following command
+				const int extra_indent = commands[end < num_commands ? end : end - 1].indent;
+				for (size_t num = 0; num < lines.size(); ++num) {
+					if (begin + num < end) {
+						auto& com = commands[begin + num];
+						com.string = lcf::DBString(lines[num]);
+						out.push_back(std::move(com));
 					} else {
-						// Trim lines down to allowed remaining (with choices).
-						const size_t maxLines = 4;
-						while (lines.size() > maxLines) {
-							lines.pop_back();
-						}
-
-						// First, pop extra entries from the back of msg_cmd; this preserves the remaining entries' indexes
-						while (msg_indexes.size() > lines.size()) {
-							commands.RemoveByIndex(msg_indexes.back());
-							msg_indexes.pop_back();
-						}
-
-						// Next, push extra entries from the back of lines to msg_cmd
-						while (lines.size() > msg_indexes.size()) {
-							commands.PutShowMessageBeforeIndex("", msg_indexes.back()+1, false);
-							msg_indexes.push_back(msg_indexes.back()+1);
-						}
-
-						// Now simply go through each entry and update it.
-						for (size_t num=0; num<msg_indexes.size(); num++) {
-							commands.ReWriteString(msg_indexes[num], lines[num]);
+						out.push_back(MakeShowMessage(lines[num], extra_indent, false));
+					}
+				}
+			}
+			idx = end;
+		} else if (IsCommand(commands[idx], Cmd::ShowChoice)) {
+			// Choices must be on the same indent level as the command following the ShowChoice.
+			options.clear();
+			key.clear();
+			if (idx + 1 < num_commands) {
+				const int indent = commands[idx + 1].indent;
+				for (size_t i = idx + 1; i < num_commands; ++i) {
+					const auto& com = commands[i];
+					if (com.indent != indent) {
+						continue;
+					}
+					if (IsCommand(com, Cmd::ShowChoiceOption) && (com.parameters.empty() ? 0 : com.parameters[0]) < 4) {
+						if (!options.empty()) {
+							key += '\n';
 						}
+						AppendString(key, com.string);
+						options.push_back(i);
+					}
+					if (IsCommand(com, Cmd::ShowChoiceEnd)) {
+						break;
 					}
-					msgs.pop_back();
-
-					// Now add remianing messages, if any
-					commands.InsertMultiMessageBefore(msgs, msg_indexes[0]);
 				}
 			}
 
-			// Note that commands.Advance() has already happened within the above code.
-		} else if (commands.CurrentIsShowChoice()) {
-			// Build up the lines of Choice elements
-			std::stringstream choice_str;
-			std::vector<size_t> choice_indexes; // Number of entries == number of choices
-			commands.BuildChoiceString(choice_str, choice_indexes);
-
-			// Go through choices.
-			if (choice_indexes.size()>0) {
-				// Translate, break back into lines.
-				std::vector<std::vector<std::string>> msgs = TranslateMessageStream(dict, choice_str, '\n');
-				if (msgs.size()>0) {
-					// Logic here is also based on the last message box.
-					std::vector<std::string>& lines = msgs.back();
-
+			if (!options.empty()) {
+				auto msgs = TranslateMessage(dict, key);
+				if (!msgs.empty()) {
 					// We only pick the first X entries from the translation, since we can't change the Choice count.
-					for (size_t num=0; num<choice_indexes.size()&&num<lines.size(); num++) {
-						commands.ReWriteString(choice_indexes[num], lines[num]);
+					// The options are still ahead of us, so they are rewritten in place.
+					const std::vector<std::string>& lines = msgs.back();
+					for (size_t num = 0; num < options.size() && num < lines.size(); ++num) {
+						commands[options[num]].string = lcf::DBString(lines[num]);
 					}
-
 					msgs.pop_back();
 
-					// Now add remianing messages, if any
-					commands.InsertMultiMessageBefore(msgs, choice_indexes[0]);
+					if (!msgs.empty()) {
+						choice_boxes[options[0]] = std::move(msgs);
+					}
 				}
 			}
 
-			// Note that commands.Advance() has already happened within the above code.
+			out.push_back(std::move(commands[idx]));
+			++idx;
 		} else {
-			commands.Advance();
+			out.push_back(std::move(commands[idx]));
+			++idx;
 		}
 	}
+
+	commands.swap(out);
+}
+
+const Dictionary* Translation::GetMapDictionary(const std::string& map_name) {
+	auto mapIt = maps.find(map_name);
+	if (mapIt != maps.end()) {
+		return mapIt->second.get();
+	}
+
+	auto fileIt = map_files.find(map_name);
+	if (fileIt == map_files.end()) {
+		return nullptr;
+	}
+	const auto info = GetPoFileInfo(std::move(fileIt->second));
+	map_files.erase(fileIt);
+
+	auto dict = std::make_unique<Dictionary>();
+	const auto cache_path = GetCachePath(current_language, map_name, info);
+	if (!ReadCache(cache_path, info, *dict)) {
+		auto is = FileFinder::OpenInputStream(info.path);
+		if (!is) {
+			return nullptr;
+		}
+		ParsePoFile(std::move(is), *dict);
+		WriteCache(cache_path, info, *dict);
+	}
+
+	auto* res = dict.get();
+	maps[map_name] = std::move(dict);
+	return res;
 }
 
 void Translation::RewriteMapMessages(const std::string& map_name, lcf::rpg::Map& map) {
 	// Retrieve lookup for this map.
-	auto mapIt = maps.find(map_name);
-	if (mapIt==maps.end()) { return; }
+	const auto* dict = GetMapDictionary(map_name);
+	if (!dict) { return; }
 
 	// Rewrite all event commands on all pages.
 	for (lcf::rpg::Event& ev : map.events) {
 		for (lcf::rpg::EventPage& pg : ev.pages) {
-			RewriteEventCommandMessage(*mapIt->second, pg.event_commands);
+			RewriteEventCommandMessage(*dict, pg.event_commands);
 		}
 	}
 }
@@ -652,6 +729,7 @@ void Translation::ClearTranslationLookups()
 	battle.reset();
 	mapnames.reset();
 	maps.clear();
+	map_files.clear();
 }
 
 
@@ -664,13 +742,93 @@ void Translation::ClearTranslationLookups()
 void Dictionary::addEntry(const Entry& entry)
 {
 	// Space-saving measure: If the translation string is empty, there's no need to save it (since we will just show the original).
-	if (!entry.translation.empty()) {
-		entries[entry.context][entry.original] = entry.translation;
+	if (entry.translation.empty()) {
+		return;
+	}
+
+	const uint64_t hash = Hash(entry.context, entry.original);
+	const int idx = FindIndex(hash, entry.context, entry.original);
+	if (idx >= 0) {
+		// Later entries replace earlier ones
+		entries[idx].translation = entry.translation;
+		return;
+	}
+
+	// Keep the table at most half full, so that probe sequences stay short
+	if ((entries.size() + 1) * 2 > slots.size()) {
+		Rehash(std::max<size_t>(64, slots.size() * 2));
+	}
+
+	entries.push_back(entry);
+	hashes.push_back(hash);
+
+	const size_t mask = slots.size() - 1;
+	size_t slot = hash & mask;
+	while (slots[slot] != 0) {
+		slot = (slot + 1) & mask;
+	}
+	slots[slot] = static_cast<uint32_t>(entries.size());
+}
+
+void Dictionary::Rehash(size_t num_slots)
+{
+	slots.assign(num_slots, 0);
+
+	const size_t mask = num_slots - 1;
+	for (size_t i = 0; i < hashes.size(); ++i) {
+		size_t slot = hashes[i] & mask;
+		while (slots[slot] != 0) {
+			slot = (slot + 1) & mask;
+		}
+		slots[slot] = static_cast<uint32_t>(i + 1);
 	}
 }
 
+int Dictionary::FindIndex(uint64_t hash, StringView context, StringView original) const
+{
+	if (slots.empty()) {
+		return -1;
+	}
+
+	const size_t mask = slots.size() - 1;
+	for (size_t slot = hash & mask; slots[slot] != 0; slot = (slot + 1) & mask) {
+		const size_t idx = slots[slot] - 1;
+		if (hashes[idx] == hash && StringView(entries[idx].original) == original && StringView(entries[idx].context) == context) {
+			return static_cast<int>(idx);
+		}
+	}
+	return -1;
+}
+
+const std::string* Dictionary::Find(StringView context, StringView original) const
+{
+	const int idx = FindIndex(Hash(context, original), context, original);
+	return idx >= 0 ? &entries[idx].translation : nullptr;
+}
+
+uint64_t Dictionary::Hash(StringView context, StringView original)
+{
+	constexpr uint64_t prime = 1099511628211ULL;
+	uint64_t hash = 14695981039346656037ULL;
+
+	for (char c : context) {
+		hash = (hash ^ static_cast<unsigned char>(c)) * prime;
+	}
+	// 0xFF never appears in UTF-8 and separates the context from the string
+	hash = (hash ^ 0xFF) * prime;
+	for (char c : original) {
+		hash = (hash ^ static_cast<unsigned char>(c)) * prime;
+	}
+	return hash;
+}
+
+size_t Dictionary::GetNumEntries() const
+{
+	return entries.size();
+}
+
 // Returns success
-bool Dictionary::FromPo(Dictionary& res, std::istream& in)
+bool Dictionary::FromPo(Dictionary& res, std::istream& in, std::string* error_msg)
 {
 	std::string line;
 	bool found_header = false;
@@ -678,7 +836,18 @@ bool Dictionary::FromPo(Dictionary& res, std::istream& in)
 
 	Entry e;
 
-	auto extract_string = [&line](int offset, bool& error) {
+	auto parse_error = [&error_msg](std::string msg, bool& error) {
+		if (error_msg) {
+			if (error_msg->empty()) {
+				*error_msg = std::move(msg);
+			}
+		} else {
+			Output::Error("{}", msg);
+		}
+		error = true;
+	};
+
+	auto extract_string = [&line, &parse_error](int offset, bool& error) {
 		std::stringstream out;
 		bool slash = false;
 		bool first_quote = false;
@@ -706,8 +875,7 @@ bool Dictionary::FromPo(Dictionary& res, std::istream& in)
 						out << '"';
 						break;
 					default:
-						Output::Error("Parse error {} ({})", line, c);
-						error = true;
+						parse_error(fmt::format("Parse error {} ({})", line, c), error);
 						break;
 				}
 			} else {
@@ -720,8 +888,7 @@ bool Dictionary::FromPo(Dictionary& res, std::istream& in)
 			}
 		}
 
-		Output::Error("Parse error: Unterminated line: {}", line);
-		error = true;
+		parse_error(fmt::format("Parse error: Unterminated line: {}", line), error);
 		return out.str();
 	};
 
@@ -782,6 +949,30 @@ bool Dictionary::FromPo(Dictionary& res, std::istream& in)
 	return !error;
 }
 
+bool Dictionary::FromCache(Dictionary& res, std::istream& in)
+{
+	uint32_t num_entries;
+	if (!ReadInt(in, num_entries)) {
+		return false;
+	}
 
+	Entry e;
+	for (uint32_t i = 0; i < num_entries; ++i) {
+		if (!ReadString(in, e.context) || !ReadString(in, e.original) || !ReadString(in, e.translation)) {
+			return false;
+		}
+		res.addEntry(e);
+	}
+	return true;
+}
 
-
+bool Dictionary::ToCache(std::ostream& out) const
+{
+	WriteInt<uint32_t>(out, entries.size());
+	for (const auto& entry : entries) {
+		WriteString(out, entry.context);
+		WriteString(out, entry.original);
+		WriteString(out, entry.translation);
+	}
+	return static_cast<bool>(out);
+}
@@ -19,12 +19,15 @@
 #define EP_TRANSLATION_H
 
 // Headers
+#include <cstdint>
 #include <string>
 #include <sstream>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "filefinder.h"
+#include "string_view.h"
 
 namespace lcf {
 	namespace rpg {
@@ -85,9 +88,27 @@ public:
 	 *
 	 * @param res The dictionary to store the translated entries in.
 	 * @param in The stream to load the translated entries from.
+	 * @param error When not null parse errors are stored here instead of raising an error.
 	 * @param return True if the file was loaded without error; false otherwise.
 	 */
-	static bool FromPo(Dictionary& res, std::istream& in);
+	static bool FromPo(Dictionary& res, std::istream& in, std::string* error = nullptr);
+
+	/**
+	 * Loads a dictionary written by ToCache.
+	 *
+	 * @param res The dictionary to store the entries in.
+	 * @param in The stream to load the entries from.
+	 * @return True if the dictionary was loaded; false if the data is invalid.
+	 */
+	static bool FromCache(Dictionary& res, std::istream& in);
+
+	/**
+	 * Writes the dictionary in a compiled form that is faster to load than a .po file.
+	 *
+	 * @param out The stream to write to.
+	 * @return True on success; false otherwise.
+	 */
+	bool ToCache(std::ostream& out) const;
 
 	/**
 	 * Replace an original string with the translated string.
@@ -99,7 +120,28 @@ public:
 	 * @return True if the original string was replaced; false otherwise.
 	 */
 	template <class StringType>
-	bool TranslateString(const std::string& context, StringType& original) const;
+	bool TranslateString(StringView context, StringType& original) const;
+
+	/**
+	 * Look up the translation of a string.
+	 *
+	 * @param context The 'context' of this string, "" for no context.
+	 * @param original The string to lookup.
+	 * @return The translation, or nullptr if there is none.
+	 */
+	const std::string* Find(StringView context, StringView original) const;
+
+	/**
+	 * Hashes a lookup key (FNV-1a).
+	 *
+	 * @param context The 'context' of the string.
+	 * @param original The original string.
+	 * @return The hash.
+	 */
+	static uint64_t Hash(StringView context, StringView original);
+
+	/** @return Number of translated entries */
+	size_t GetNumEntries() const;
 
 private:
 	/**
@@ -109,24 +151,28 @@ private:
 	 */
 	void addEntry(const Entry& entry);
 
-	// Lookup by context, where context can be empty ("") for no context.
-	std::unordered_map<std::string, std::unordered_map<std::string, std::string>> entries;
+	/** @return The index of an entry, or -1 if not found */
+	int FindIndex(uint64_t hash, StringView context, StringView original) const;
+
+	/** Rebuilds the hash index with at least the given number of slots */
+	void Rehash(size_t num_slots);
+
+	std::vector<Entry> entries;
+	// Hash of every entry, same order as entries
+	std::vector<uint64_t> hashes;
+	// Open addressing hash table, stores an index into entries plus 1 or 0 for an empty slot
+	std::vector<uint32_t> slots;
 };
 
 
 // Template implementation
 template <class StringType>
-bool Dictionary::TranslateString(const std::string& context, StringType& original) const
+bool Dictionary::TranslateString(StringView context, StringType& original) const
 {
-	std::stringstream key;
-	key <<original;
-	auto it = entries.find(context);
-	if (it != entries.end()) {
-		auto it2 = it->second.find(key.str());
-		if (it2 != it->second.end()) {
-			original = StringType(it2->second);
-			return true;
-		}
+	const auto* translation = Find(context, StringView(original));
+	if (translation) {
+		original = StringType(*translation);
+		return true;
 	}
 	return false;
 }
@@ -217,13 +263,22 @@ private:
 	void ParsePoFile(Filesystem_Stream::InputStream is, Dictionary& out);
 
 	/**
-	 * Parse all .po files for the given language.
+	 * Parse the database .po files for the given language and locate the map .po files.
+	 * The database files are parsed in parallel, map files are parsed when first used.
 	 *
 	 * @param lang_id The ID of the language to parse, or "" for Default (no parsing is done)
 	 * @return True if the language directory was found; false otherwise
 	 */
 	bool ParseLanguageFiles(const std::string& lang_id);
 
+	/**
+	 * Retrieve the dictionary of a map and parse it on first use.
+	 *
+	 * @param map_name The name of the map .po file; e.g., "map0104.po"
+	 * @return The dictionary, or nullptr if the map has no translation.
+	 */
+	const Dictionary* GetMapDictionary(const std::string& map_name);
+
 	/**
 	 * Rewrite RPG_RT.ldb with the current translation entries
 	 */
@@ -245,20 +300,19 @@ private:
 	void RewriteCommonEventMessages();
 
 	/**
-	 * Convert a stream of msgbox or choices to a list of output message boxes
+	 * Convert the lines of a msgbox or choices to a list of output message boxes
 	 *
 	 * @param dict The dictionary to use for translation
-	 * @param msg The message string to use for lookup. String with newlines.
-	 * @param trimChar Trim this character if the lookup string ends with this.
+	 * @param msg The message string to use for lookup. Lines separated by newlines.
 	 * @return A vector of Message Boxes, where each Message Box is represented as a vector of lines (strings), or an empty vector if there is no translation.
 	 *         It is guaranteed that each MessageBox vector will have at least one entry (containing "") if it would otherwise be empty; this can happen
 	 *         if the message box insertion commands are used. Note that the last MessageBox vector may contain translated "Choice" entries (it is based on the input).
 	 */
-	std::vector<std::vector<std::string>> TranslateMessageStream(const Dictionary& dict, const std::stringstream& msg, char trimChar);
+	std::vector<std::vector<std::string>> TranslateMessage(const Dictionary& dict, StringView msg);
 
 	/**
 	 * Rewrite a list of event commands (from any map, battle, or common event) given a dictionary.
-	 * Takes into account deleting and adding message boxes.
+	 * Takes into account deleting and adding message boxes. The list is rebuilt in a single pass.
 	 *
 	 * @param dict The dictionary to use for translation.
 	 * @param commands The commands to search through and update.
@@ -273,6 +327,7 @@ private:
 	std::unique_ptr<Dictionary> battle;    // RPG_RT.ldb.battle.po
 	std::unique_ptr<Dictionary> mapnames;  // RPG_RT.lmt.po (map names, used only in the "Teleport" event command)
 	std::unordered_map<std::string, std::unique_ptr<Dictionary>> maps;  // map<id>.po, indexed by map name
+	std::unordered_map<std::string, std::string> map_files;  // Path of map<id>.po files not parsed yet, indexed by map name
 
 	// Our list of available Languages (translations, localizations), determined by scanning the files on disk.
 	std::vector<Language> languages;
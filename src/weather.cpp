@@ -17,6 +17,8 @@
 
 // Headers
 #define _USE_MATH_DEFINES
+#include <algorithm>
+#include <array>
 #include <string>
 #include <vector>
 #include "bitmap.h"
@@ -27,7 +29,9 @@
 #include "drawable_mgr.h"
 #include "player.h"
 #include "output.h"
+#include "pixel_ops.h"
 #include "rand.h"
+#include "screen.h"
 
 Weather::Weather() :
 	Drawable(Priority_Weather, Drawable::Flags::Shared)
@@ -42,7 +46,7 @@ void Weather::Update() {
 }
 
 void Weather::Draw(Bitmap& dst) {
-	SetTone(Main_Data::game_screen->GetTone());
+	SetTone(Screen::GetSpriteTone());
 
 	switch (Main_Data::game_screen->GetWeatherType()) {
 		case Game_Screen::Weather_None:
@@ -119,6 +123,80 @@ static constexpr int fog_opacity[2][4] = {
 };
 
 
+namespace {
+	using PixelOps::MulPixel;
+	using PixelOps::BlendPixel;
+	using PixelOps::Row;
+
+	inline int Wrap(int v, int m) {
+		v %= m;
+		return v < 0 ? v + m : v;
+	}
+
+	struct ParticlePixel {
+		int x;
+		int y;
+		uint32_t color;
+	};
+
+	struct SandPixel {
+		int x;
+		int y;
+		int order;
+		uint32_t color;
+	};
+
+	constexpr int max_sand_pixels = num_sand_particles[num_strength - 1] * sand_particle_rect.height;
+
+	/**
+	 * Collects the screen pixels of the visible sand particles, with the
+	 * opacity premultiplied, sorted by row and then by drawing order.
+	 *
+	 * @param pixels receives the pixels
+	 * @param bitmap sand particle bitmap with tone applied
+	 * @param dw screen width
+	 * @param dh screen height
+	 * @return number of pixels
+	 */
+	int CollectSandPixels(std::array<SandPixel, max_sand_pixels>& pixels, const Bitmap& bitmap, int dw, int dh) {
+		const auto strength = Main_Data::game_screen->GetWeatherStrength();
+		const auto& particles = Main_Data::game_screen->GetParticles();
+
+		const int num_particles = num_sand_particles[Utils::Clamp(strength, 0, num_strength - 1)];
+
+		assert(num_particles <= static_cast<int>(particles.size()));
+
+		int num_pixels = 0;
+		for (int i = 0; i < num_particles; ++i) {
+			auto& p = particles[i];
+			const int color = (i % num_sand_colors);
+			if (p.alpha <= 0 || p.x < 0 || p.x >= dw) {
+				continue;
+			}
+
+			// Each particle is a 1x2 pixel column
+			const uint32_t alpha = std::min<int>(p.alpha, 255);
+			for (int y = 0; y < sand_particle_rect.height; ++y) {
+				const int dy = p.y + y;
+				if (dy < 0 || dy >= dh) {
+					continue;
+				}
+				uint32_t px = Row(bitmap, color * sand_particle_rect.height + y)[0];
+				if (alpha != 255) {
+					px = MulPixel(px, alpha);
+				}
+				pixels[num_pixels] = { p.x, dy, num_pixels, px };
+				++num_pixels;
+			}
+		}
+
+		std::sort(pixels.begin(), pixels.begin() + num_pixels, [](const SandPixel& a, const SandPixel& b) {
+			return a.y < b.y || (a.y == b.y && a.order < b.order);
+		});
+		return num_pixels;
+	}
+} // anonymous namespace
+
 int Weather::GetMaxNumParticles(int weather_type) {
 	switch (weather_type) {
 		case Game_Screen::Weather_None:
@@ -205,10 +283,75 @@ void Weather::DrawParticles(Bitmap& dst, const Bitmap& particle, const Rect rect
 	const auto ainc = abase + strength;
 
 	auto surface_rect = weather_surface->GetRect();
-	weather_surface->Clear();
 
 	assert(num_particles <= static_cast<int>(particles.size()));
 
+	const auto shake_x = Main_Data::game_screen->GetShakeOffsetX();
+	const auto shake_y = Main_Data::game_screen->GetShakeOffsetY();
+	auto pan_rect = Main_Data::game_screen->GetScreenEffectsRect();
+
+	if (dst.HasPixelFormatLayout() && bitmap->HasPixelFormatLayout()) {
+		// Draw every particle pixel straight to all screen positions where the
+		// tiled weather surface would have shown it. Saves clearing and tiling
+		// the full surface every frame.
+		std::array<ParticlePixel, rain_bitmap_rect.width * rain_bitmap_rect.height> sprite;
+		int sprite_size = 0;
+		assert(rect.width * rect.height <= static_cast<int>(sprite.size()));
+		for (int y = 0; y < rect.height; ++y) {
+			const auto* src = Row(*bitmap, rect.y + y) + rect.x;
+			for (int x = 0; x < rect.width; ++x) {
+				if (src[x] != 0) {
+					sprite[sprite_size++] = { x, y, src[x] };
+				}
+			}
+		}
+
+		const int as = Bitmap::pixel_format.a.shift;
+		const int sw = surface_rect.width;
+		const int sh = surface_rect.height;
+		const int dw = dst.width();
+		const int dh = dst.height();
+		// Surface position of screen pixel (x, y) is ((x + ox) % sw, (y + oy) % sh)
+		const int ox = -pan_rect.x + shake_x;
+		const int oy = -pan_rect.y + shake_y;
+
+		for (int i = 0; i < num_particles; ++i) {
+			auto& p = particles[i];
+			if (p.t > tmax) {
+				continue;
+			}
+
+			const uint32_t alpha = std::min(ainc * p.t, 255);
+			if (alpha == 0) {
+				continue;
+			}
+
+			for (int j = 0; j < sprite_size; ++j) {
+				const auto& px = sprite[j];
+
+				// Particles crossing the right or bottom edge wrap around like EdgeMirrorBlit
+				int sx = p.x + px.x;
+				int sy = p.y + px.y;
+				if (sx >= sw) sx -= sw;
+				if (sy >= sh) sy -= sh;
+				if (sx < 0 || sx >= sw || sy < 0 || sy >= sh) {
+					continue;
+				}
+
+				const uint32_t color = alpha == 255 ? px.color : MulPixel(px.color, alpha);
+				for (int y = Wrap(sy - oy, sh); y < dh; y += sh) {
+					auto* row = Row(dst, y);
+					for (int x = Wrap(sx - ox, sw); x < dw; x += sw) {
+						BlendPixel(row[x], color, as);
+					}
+				}
+			}
+		}
+		return;
+	}
+
+	weather_surface->Clear();
+
 	for (int i = 0; i < num_particles; ++i) {
 		auto& p = particles[i];
 		if (p.t > tmax) {
@@ -220,9 +363,6 @@ void Weather::DrawParticles(Bitmap& dst, const Bitmap& particle, const Rect rect
 		weather_surface->EdgeMirrorBlit(p.x, p.y, *bitmap, rect, true, true, alpha);
 	}
 
-	const auto shake_x = Main_Data::game_screen->GetShakeOffsetX();
-	const auto shake_y = Main_Data::game_screen->GetShakeOffsetY();
-	auto pan_rect = Main_Data::game_screen->GetScreenEffectsRect();
 	dst.TiledBlit(-pan_rect.x + shake_x, -pan_rect.y + shake_y, surface_rect, *weather_surface, dst.GetRect(), Opacity::Opaque());
 }
 
@@ -242,8 +382,7 @@ void Weather::DrawSandstorm(Bitmap& dst) {
 		CreateSandParticle();
 	}
 
-	DrawFogOverlay(dst, *sand_bitmap);
-	DrawSandParticles(dst, *sand_particle_bitmap);
+	DrawFogOverlay(dst, *sand_bitmap, sand_particle_bitmap.get());
 }
 
 void Weather::CreateSandParticle() {
@@ -319,10 +458,23 @@ void Weather::CreateFogOverlay() {
 	}
 }
 
-void Weather::DrawFogOverlay(Bitmap& dst, const Bitmap& overlay) {
+void Weather::DrawFogOverlay(Bitmap& dst, const Bitmap& overlay, const Bitmap* sand_particle) {
 	const auto dr = dst.GetRect();
 	constexpr auto sr = overlay_bitmap_rect;
 
+	bool direct = dst.HasPixelFormatLayout();
+
+	// Collect the sand before the overlay, both use the tone bitmap
+	std::array<SandPixel, max_sand_pixels> sand;
+	int num_sand = 0;
+	if (sand_particle && direct) {
+		auto* sand_src = ApplyToneEffect(*sand_particle, sand_particle->GetRect());
+		direct = sand_src->HasPixelFormatLayout();
+		if (direct) {
+			num_sand = CollectSandPixels(sand, *sand_src, dr.width, dr.height);
+		}
+	}
+
 	auto* src = ApplyToneEffect(overlay, sr);
 
 	auto strength = Utils::Clamp(Main_Data::game_screen->GetWeatherStrength(), 0, num_opacities - 1);
@@ -348,8 +500,53 @@ void Weather::DrawFogOverlay(Bitmap& dst, const Bitmap& overlay) {
 	// Back layer never moves vertically
 	const int by = shake_y;
 
+	if (direct && src->HasPixelFormatLayout()) {
+		// Both layers and the sand particles in one pass over the screen,
+		// with the opacity premultiplied into a copy of the tile
+		constexpr int tw = sr.width;
+		constexpr int th = sr.height;
+		std::array<uint32_t, tw * th> back;
+		std::array<uint32_t, tw * th> front;
+		for (int y = 0; y < th; ++y) {
+			const auto* row = Row(*src, y);
+			for (int x = 0; x < tw; ++x) {
+				back[y * tw + x] = MulPixel(row[x], back_opacity);
+				front[y * tw + x] = MulPixel(row[x], front_opacity);
+			}
+		}
+
+		const int as = Bitmap::pixel_format.a.shift;
+		const bool draw_back = back_opacity > 0;
+		const bool draw_front = front_opacity > 0;
+
+		int next_sand = 0;
+		for (int y = 0; y < dr.height; ++y) {
+			auto* row = Row(dst, dr.y + y);
+			const auto* back_row = &back[Wrap(y + by, th) * tw];
+			const auto* front_row = &front[Wrap(y + fy, th) * tw];
+			const int back_x = Wrap(bx, tw);
+			const int front_x = Wrap(fx, tw);
+			for (int x = 0; x < dr.width; ++x) {
+				if (draw_back) {
+					BlendPixel(row[dr.x + x], back_row[(x + back_x) % tw], as);
+				}
+				if (draw_front) {
+					BlendPixel(row[dr.x + x], front_row[(x + front_x) % tw], as);
+				}
+			}
+			// Particles are drawn over the finished overlay row
+			for (; next_sand < num_sand && sand[next_sand].y == y; ++next_sand) {
+				BlendPixel(row[dr.x + sand[next_sand].x], sand[next_sand].color, as);
+			}
+		}
+		return;
+	}
+
 	dst.TiledBlit(bx, by, sr, *src, dr, back_opacity);
 	dst.TiledBlit(fx, fy, sr, *src, dr, front_opacity);
+	if (sand_particle) {
+		DrawSandParticles(dst, *sand_particle);
+	}
 }
 
 void Weather::SetTone(Tone tone) {
@@ -53,7 +53,14 @@ private:
 	void CreateFogOverlay();
 
 	void DrawParticles(Bitmap& dst, const Bitmap& particle, Rect rect, int abase, int tmax);
-	void DrawFogOverlay(Bitmap& dst, const Bitmap& overlay);
+	/**
+	 * Draws the two fog layers of an overlay.
+	 *
+	 * @param dst destination bitmap
+	 * @param overlay fog or sand overlay tile
+	 * @param sand_particle when not null, the sand particles are drawn on top
+	 */
+	void DrawFogOverlay(Bitmap& dst, const Bitmap& overlay, const Bitmap* sand_particle = nullptr);
 	void DrawSandParticles(Bitmap& dst, const Bitmap& particle);
 	const Bitmap* ApplyToneEffect(const Bitmap& bitmap, Rect rect);
 
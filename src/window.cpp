@@ -24,6 +24,7 @@
 #include "util_macro.h"
 #include "window.h"
 #include "bitmap.h"
+#include "cache.h"
 #include "drawable_mgr.h"
 
 constexpr int pause_animation_frames = 20;
@@ -159,72 +160,18 @@ void Window::Draw(Bitmap& dst) {
 void Window::RefreshBackground() {
 	background_needs_refresh = false;
 
-	BitmapRef bitmap = Bitmap::Create(width, height, false);
-
-	if (stretch) {
-		bitmap->StretchBlit(*windowskin, Rect(0, 0, 32, 32), 255);
-	} else {
-		bitmap->TiledBlit(Rect(0, 0, 32, 32), *windowskin, bitmap->GetRect(), 255);
-	}
-
-	background = bitmap;
+	background = Cache::WindowSkinPart(windowskin, stretch ? Cache::WindowPart::BackgroundStretch : Cache::WindowPart::BackgroundTiled, width, height);
 }
 
 void Window::RefreshFrame() {
 	frame_needs_refresh = false;
 
-	BitmapRef up_bitmap = Bitmap::Create(width, 8);
-	BitmapRef down_bitmap = Bitmap::Create(width, 8);
-
-	up_bitmap->Clear();
-	down_bitmap->Clear();
-
-	Rect src_rect, dst_rect;
-
-	// Border Up
-	src_rect = { 32 + 8, 0, 16, 8 };
-	dst_rect = { 8, 0, max(width - 16, 1), 8 };
-	up_bitmap->TiledBlit(8, 0, src_rect, *windowskin, dst_rect, 255);
-
-	// Border Down
-	src_rect = { 32 + 8, 32 - 8, 16, 8 };
-	dst_rect = { 8, 0, max(width - 16, 1), 8 };
-	down_bitmap->TiledBlit(8, 0, src_rect, *windowskin, dst_rect, 255);
-
-	// Upper left corner
-	up_bitmap->Blit(0, 0, *windowskin, Rect(32, 0, 8, 8), 255);
-
-	// Upper right corner
-	up_bitmap->Blit(width - 8, 0, *windowskin, Rect(64 - 8, 0, 8, 8), 255);
-
-	// Lower left corner
-	down_bitmap->Blit(0, 0, *windowskin, Rect(32, 32 - 8, 8, 8), 255);
-
-	// Lower right corner
-	down_bitmap->Blit(width - 8, 0, *windowskin, Rect(64 - 8, 32 - 8, 8, 8), 255);
-
-	frame_up = up_bitmap;
-	frame_down = down_bitmap;
+	frame_up = Cache::WindowSkinPart(windowskin, Cache::WindowPart::FrameUp, width, height);
+	frame_down = Cache::WindowSkinPart(windowskin, Cache::WindowPart::FrameDown, width, height);
 
 	if (height > 16) {
-		BitmapRef left_bitmap = Bitmap::Create(8, height - 16);
-		BitmapRef right_bitmap = Bitmap::Create(8, height - 16);
-
-		left_bitmap->Clear();
-		right_bitmap->Clear();
-
-		// Border Left
-		src_rect = { 32, 8, 8, 16 };
-		dst_rect = { 0, 0, 8, height - 16 };
-		left_bitmap->TiledBlit(0, 8, src_rect, *windowskin, dst_rect, 255);
-
-		// Border Right
-		src_rect = { 64 - 8, 8, 8, 16 };
-		dst_rect = { 0, 0, 8, height - 16 };
-		right_bitmap->TiledBlit(0, 8, src_rect, *windowskin, dst_rect, 255);
-
-		frame_left = left_bitmap;
-		frame_right = right_bitmap;
+		frame_left = Cache::WindowSkinPart(windowskin, Cache::WindowPart::FrameLeft, width, height);
+		frame_right = Cache::WindowSkinPart(windowskin, Cache::WindowPart::FrameRight, width, height);
 	} else {
 		frame_left = BitmapRef();
 		frame_right = BitmapRef();
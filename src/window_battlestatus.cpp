@@ -313,7 +313,7 @@ bool Window_BattleStatus::IsChoiceValid(const Game_Battler& battler) const {
 }
 
 void Window_BattleStatus::RefreshActiveFromValid() {
-	std::vector<Game_Battler*> battlers;
+	FrameVector<Game_Battler*> battlers;
 	if (enemy) {
 		Main_Data::game_enemyparty->GetBattlers(battlers);
 	} else {
@@ -36,6 +36,7 @@
 #include "bitmap.h"
 #include "font.h"
 #include "cache.h"
+#include "message_layout.h"
 #include "text.h"
 
 // FIXME: Off by 1 bug in window base class
@@ -126,6 +127,8 @@ Window_Message::~Window_Message() {
 
 void Window_Message::StartMessageProcessing(PendingMessage pm) {
 	text.clear();
+	runs.clear();
+	run_index = 0;
 	pending_message = std::move(pm);
 
 	if (!IsVisible()) {
@@ -302,6 +305,9 @@ void Window_Message::InsertNewPage() {
 		}
 	}
 
+	// Control codes and glyph widths are resolved once per page, typing only replays the runs
+	text_index = MessageLayout::LayoutPage(text_index, text.data() + text.size(), Player::escape_char, *Font::Default(), runs);
+	run_index = 0;
 }
 
 void Window_Message::InsertNewLine() {
@@ -337,6 +343,8 @@ void Window_Message::FinishMessageProcessing() {
 	DebugLog("{}: FINISH MSG");
 	text.clear();
 	text_index = text.data();
+	runs.clear();
+	run_index = 0;
 
 	SetPause(false);
 	kill_page = false;
@@ -445,8 +453,6 @@ void Window_Message::UpdateMessage() {
 	auto font = Font::Default();
 
 	while (true) {
-		const auto* end = text.data() + text.size();
-
 		if (wait_count > 0) {
 			DebugLog("{}: MSG WAIT LOOP {}", wait_count);
 			--wait_count;
@@ -457,162 +463,132 @@ void Window_Message::UpdateMessage() {
 			break;
 		}
 
-		if (text_index == end) {
+		if (run_index >= runs.size()) {
 			FinishMessageProcessing();
 			break;
 		}
 
-		auto tret = Utils::TextNext(text_index, end, Player::escape_char);
-		auto text_prev = text_index;
-		text_index = tret.next;
-
-		if (EP_UNLIKELY(!tret)) {
-			continue;
-		}
+		const MessageRun& run = runs[run_index];
+		++run_index;
 
-		const auto ch = tret.ch;
-		if (tret.is_exfont) {
-			if (!DrawGlyph(*font, *system, ch, true)) {
-				text_index = text_prev;
+		switch (run.type) {
+		case MessageRun::Type::Glyph:
+		case MessageRun::Type::ExFont:
+			if (!DrawGlyph(*font, *system, run)) {
+				--run_index;
 			}
-			continue;
-		}
-
-		if (ch == '\f') {
-			if (text_index != end) {
+			break;
+		case MessageRun::Type::PageEnd:
+			if (run.value) {
 				InsertNewPage();
 				SetWait(1);
 			}
-			continue;
-		}
-
-		if (ch == '\n') {
-			int wait_frames = 0;
-			bool end_page = (*text_index == '\f');
-
-			if (!instant_speed) {
-				if (!prev_char_printable) {
-					wait_frames += 1 + end_page;
+			break;
+		case MessageRun::Type::NewLine:
+			{
+				int wait_frames = 0;
+				bool end_page = (run.value != 0);
+
+				if (!instant_speed) {
+					if (!prev_char_printable) {
+						wait_frames += 1 + end_page;
+					}
+				} else if (end_page) {
+					// When the page ends and speed is instant, RPG_RT always waits 2 frames.
+					wait_frames += 2;
 				}
-			} else if (end_page) {
-				// When the page ends and speed is instant, RPG_RT always waits 2 frames.
-				wait_frames += 2;
-			}
-
-			InsertNewLine();
-
-			if (end_page) {
-				OnFinishPage();
-			}
-			SetWait(wait_frames);
 
-			if (instant_speed && !instant_speed_forced) {
-				// instant_speed stops at the end of the line
-				// unless it was triggered by the shift key.
-				instant_speed = false;
-			}
-			continue;
-		}
-
-		if (Utils::IsControlCharacter(ch)) {
-			// control characters not handled
-			continue;
-		}
+				InsertNewLine();
 
-		if (tret.is_escape && ch != Player::escape_char) {
-			// Special message codes
-			switch (ch) {
-			case 'c':
-			case 'C':
-				{
-					// Color
-					auto pres = Game_Message::ParseColor(text_index, end, Player::escape_char, true);
-					auto value = pres.value;
-					text_index = pres.next;
-					DebugLogText("{}: MSG Color \\c[{}]", value);
-					SetWaitForNonPrintable(0);
-					text_color = value > 19 ? 0 : value;
+				if (end_page) {
+					OnFinishPage();
 				}
-				break;
-			case 's':
-			case 'S':
-				{
-					// Speed modifier
-					auto pres = Game_Message::ParseSpeed(text_index, end, Player::escape_char, true);
-					text_index = pres.next;
-					DebugLogText("{}: MSG Speed \\s[{}]", pres.value);
-					SetWaitForNonPrintable(0);
-					speed = Utils::Clamp(pres.value, 1, 20);
+				SetWait(wait_frames);
+
+				if (instant_speed && !instant_speed_forced) {
+					// instant_speed stops at the end of the line
+					// unless it was triggered by the shift key.
+					instant_speed = false;
 				}
-				break;
-			case '_':
-				// Insert half size space
-				contents_x += Font::Default()->GetSize(" ").width / 2;
-				DebugLogText("{}: MSG HalfWait \\_");
-				SetWaitForCharacter(1);
-				break;
-			case '$':
-				// Show Gold Window
-				ShowGoldWindow();
-				DebugLogText("{}: MSG Gold \\$");
-				SetWaitForNonPrintable(speed);
-				break;
-			case '!':
-				// Text pause
-				DebugLogText("{}: MSG Pause \\!");
-				SetWaitForNonPrintable(0);
-				SetPause(true);
-				break;
-			case '^':
-				// Force message close
-				// The close happens at the end of the message, not where
-				// the ^ is encountered
-				DebugLogText("{}: MSG Kill Page \\^");
-				kill_page = true;
-				SetWaitForNonPrintable(speed);
-				break;
-			case '>':
-				// Instant speed start
-				DebugLogText("{}: MSG Instant Speed Start \\>");
-				SetWaitForNonPrintable(0);
-				instant_speed = true;
-				break;
-			case '<':
-				// Instant speed stop - also cancels shift key and forces a delay.
-				instant_speed = false;
-				instant_speed_forced = false;
-				DebugLogText("{}: MSG Instant Speed Stop \\<");
-				SetWaitForNonPrintable(speed);
-				break;
-			case '.':
-				// 1/4 second sleep
-				// Despite documentation saying 1/4 second, RPG_RT waits for 16 frames.
-				// RPG_RT also has a bug(??) where speeds >= 17 slow this down by 1 more frame per speed.
-				SetWaitForNonPrintable(16 + Utils::Clamp(speed - 16, 0, 4));
-				DebugLogText("{}: MSG Quick Sleep \\.");
-				break;
-			case '|':
-				// Second sleep
-				// Despite documentation saying 1 second, RPG_RT waits for 61 frames.
-				SetWaitForNonPrintable(61);
-				DebugLogText("{}: MSG Sleep \\|");
-				break;
-			default:
-				// Unknown characters will not display anything but do wait.
-				SetWaitForNonPrintable(speed);
-				break;
 			}
-			continue;
-		}
-
-		if (!DrawGlyph(*font, *system, ch, false)) {
-			text_index = text_prev;
-			continue;
+			break;
+		// Special message codes
+		case MessageRun::Type::Color:
+			// Color
+			DebugLogText("{}: MSG Color \\c[{}]", run.value);
+			SetWaitForNonPrintable(0);
+			text_color = run.value > 19 ? 0 : run.value;
+			break;
+		case MessageRun::Type::Speed:
+			// Speed modifier
+			DebugLogText("{}: MSG Speed \\s[{}]", run.value);
+			SetWaitForNonPrintable(0);
+			speed = Utils::Clamp(run.value, 1, 20);
+			break;
+		case MessageRun::Type::HalfSpace:
+			// Insert half size space
+			contents_x += run.value;
+			DebugLogText("{}: MSG HalfWait \\_");
+			SetWaitForCharacter(run, 1);
+			break;
+		case MessageRun::Type::Gold:
+			// Show Gold Window
+			ShowGoldWindow();
+			DebugLogText("{}: MSG Gold \\$");
+			SetWaitForNonPrintable(speed);
+			break;
+		case MessageRun::Type::Pause:
+			// Text pause
+			DebugLogText("{}: MSG Pause \\!");
+			SetWaitForNonPrintable(0);
+			SetPause(true);
+			break;
+		case MessageRun::Type::KillPage:
+			// Force message close
+			// The close happens at the end of the message, not where
+			// the ^ is encountered
+			DebugLogText("{}: MSG Kill Page \\^");
+			kill_page = true;
+			SetWaitForNonPrintable(speed);
+			break;
+		case MessageRun::Type::InstantStart:
+			// Instant speed start
+			DebugLogText("{}: MSG Instant Speed Start \\>");
+			SetWaitForNonPrintable(0);
+			instant_speed = true;
+			break;
+		case MessageRun::Type::InstantStop:
+			// Instant speed stop - also cancels shift key and forces a delay.
+			instant_speed = false;
+			instant_speed_forced = false;
+			DebugLogText("{}: MSG Instant Speed Stop \\<");
+			SetWaitForNonPrintable(speed);
+			break;
+		case MessageRun::Type::QuickSleep:
+			// 1/4 second sleep
+			// Despite documentation saying 1/4 second, RPG_RT waits for 16 frames.
+			// RPG_RT also has a bug(??) where speeds >= 17 slow this down by 1 more frame per speed.
+			SetWaitForNonPrintable(16 + Utils::Clamp(speed - 16, 0, 4));
+			DebugLogText("{}: MSG Quick Sleep \\.");
+			break;
+		case MessageRun::Type::Sleep:
+			// Second sleep
+			// Despite documentation saying 1 second, RPG_RT waits for 61 frames.
+			SetWaitForNonPrintable(61);
+			DebugLogText("{}: MSG Sleep \\|");
+			break;
+		case MessageRun::Type::Unknown:
+			// Unknown characters will not display anything but do wait.
+			SetWaitForNonPrintable(speed);
+			break;
 		}
 	}
 }
 
-bool Window_Message::DrawGlyph(Font& font, const Bitmap& system, char32_t glyph, bool is_exfont) {
+bool Window_Message::DrawGlyph(Font& font, const Bitmap& system, const MessageRun& run) {
+	const char32_t glyph = static_cast<char32_t>(run.value);
+	const bool is_exfont = (run.type == MessageRun::Type::ExFont);
+
 	if (is_exfont) {
 		DebugLogText("{}: MSG DrawGlyph Exfont {}", static_cast<uint32_t>(glyph));
 	} else {
@@ -631,10 +607,7 @@ bool Window_Message::DrawGlyph(Font& font, const Bitmap& system, char32_t glyph,
 
 	// Wide characters cause an extra wait if the last printed character did not wait.
 	if (prev_char_printable && !prev_char_waited) {
-		auto& wide_font = is_exfont ? *Font::exfont : font;
-		auto rect = wide_font.GetSize(glyph);
-		auto width = get_width(rect.width);
-		if (width >= 2) {
+		if (run.width >= 2) {
 			prev_char_waited = true;
 			++line_char_counter;
 			SetWait(1);
@@ -647,7 +620,7 @@ bool Window_Message::DrawGlyph(Font& font, const Bitmap& system, char32_t glyph,
 	int glyph_width = rect.width;
 	contents_x += glyph_width;
 	int width = get_width(glyph_width);
-	SetWaitForCharacter(width);
+	SetWaitForCharacter(run, width);
 
 	return true;
 }
@@ -745,12 +718,10 @@ void Window_Message::SetWaitForNonPrintable(int frames) {
 	}
 }
 
-void Window_Message::SetWaitForCharacter(int width) {
+void Window_Message::SetWaitForCharacter(const MessageRun& run, int width) {
 	int frames = 0;
 	if (!instant_speed && width > 0) {
-		bool is_last_for_page = (text.data() + text.size() - text_index) < 2 || (*text_index == '\n' && *(text_index + 1) == '\f');
-
-		if (is_last_for_page) {
+		if (run.last_for_page) {
 			// RPG_RT always waits 2 frames for last character on the page.
 			// FIXME: Exfonts / wide last on page?
 			frames = 2;
@@ -760,11 +731,9 @@ void Window_Message::SetWaitForCharacter(int width) {
 			} else {
 				frames = width / 2;
 				if (width & 1) {
-					bool is_last_for_line = (*text_index == '\n');
-
 					// RPG_RT waits for every even character. Also always waits
 					// for the last character.
-					frames += (line_char_counter & 1) || is_last_for_line;
+					frames += (line_char_counter & 1) || run.last_for_line;
 				}
 			}
 		}
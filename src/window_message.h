@@ -20,6 +20,8 @@
 
 // Headers
 #include <string>
+#include <vector>
+#include "message_layout.h"
 #include "window_gold.h"
 #include "window_numberinput.h"
 #include "window_selectable.h"
@@ -149,10 +151,14 @@ protected:
 	int line_count = 0;
 	/** Maximum number of lines per page */
 	int max_lines_per_page = 4;
-	/** Index of the next char in text that will be output. */
+	/** Start of the next page in text that will be laid out. */
 	const char* text_index = nullptr;
 	/** text message that will be displayed. */
 	std::string text;
+	/** Laid out text of the current page. */
+	std::vector<MessageRun> runs;
+	/** Index of the next run that will be output. */
+	size_t run_index = 0;
 	/** Text color. */
 	int text_color = 0;
 	/** Current speed modifier. */
@@ -186,10 +192,10 @@ protected:
 
 	PendingMessage pending_message;
 
-	bool DrawGlyph(Font& font, const Bitmap& system, char32_t glyph, bool is_exfont);
+	bool DrawGlyph(Font& font, const Bitmap& system, const MessageRun& run);
 	void IncrementLineCharCounter(int width);
 
-	void SetWaitForCharacter(int width);
+	void SetWaitForCharacter(const MessageRun& run, int width);
 	void SetWaitForNonPrintable(int frames);
 	void SetWait(int frames);
 
@@ -82,6 +82,10 @@ void Window_SaveFile::SetCorrupted(bool corrupted) {
 	this->corrupted = corrupted;
 }
 
+void Window_SaveFile::SetLoading(bool loading) {
+	this->loading = loading;
+}
+
 bool Window_SaveFile::IsValid() {
 	return has_save && !corrupted;
 }
@@ -107,6 +111,11 @@ void Window_SaveFile::Refresh() {
 		return;
 	}
 
+	if (loading) {
+		contents->TextDraw(4, 16 + 2, Font::ColorDisabled, "...");
+		return;
+	}
+
 	if (!has_party) {
 		return;
 	}
@@ -82,6 +82,12 @@ public:
 	 */
 	void SetCorrupted(bool corrupted);
 
+	/**
+	 * Sets if the savegame is still being read.
+	 * Displays a placeholder in that case.
+	 */
+	void SetLoading(bool loading);
+
 	void Update() override;
 
 protected:
@@ -95,6 +101,7 @@ protected:
 	int override_index = 0;
 	lcf::rpg::SaveTitle data;
 	bool corrupted = false;
+	bool loading = false;
 	bool has_save = false;
 	bool has_party = false;
 };
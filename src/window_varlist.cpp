@@ -86,6 +86,14 @@ void Window_VarList::DrawItemValue(int index){
 				contents->TextDraw(GetWidth() - 16, 16 * index + 2, Font::ColorDefault, "", Text::AlignRight);
 			}
 			break;
+		case eProfile:
+			{
+				const auto& entry = profile[first_var + index - 1];
+				const auto ms = std::chrono::duration<double, std::milli>(entry.time).count();
+				DrawItem(index, Font::ColorDefault);
+				contents->TextDraw(GetWidth() - 16, 16 * index + 2, Font::ColorDefault, fmt::format("{:.1f}ms", ms), Text::AlignRight);
+			}
+			break;
 		case eNone:
 			break;
 	}
@@ -100,6 +108,9 @@ void Window_VarList::UpdateList(int first_value){
 				[](const lcf::rpg::MapInfo& l, int r) { return l.ID < r; });
 		map_idx = iter - lcf::Data::treemap.maps.begin();
 	}
+	if (mode == eProfile) {
+		profile = InterpreterProfiler::GetEntries();
+	}
 	for (int i = 0; i < 10; i++){
 		if (!DataIsValid(first_var+i)) {
 			continue;
@@ -142,6 +153,26 @@ void Window_VarList::UpdateList(int first_value){
 			case eMapEvent:
 				ss << Game_Map::GetEvent(first_value+i)->GetName();
 				break;
+			case eProfile:
+				{
+					const auto& entry = profile[first_value + i - 1];
+					switch (entry.source) {
+						case InterpreterProfiler::Source::Foreground:
+							ss << "FG" << entry.owner_id;
+							break;
+						case InterpreterProfiler::Source::CommonEvent:
+							ss << "CE" << entry.owner_id;
+							break;
+						case InterpreterProfiler::Source::MapEvent:
+							ss << "EV" << entry.owner_id << "/" << entry.page_id;
+							break;
+					}
+					if (entry.depth > 0) {
+						ss << "+" << entry.depth;
+					}
+					ss << " #" << entry.index << " " << entry.code;
+				}
+				break;
 			default:
 				break;
 		}
@@ -173,6 +204,8 @@ bool Window_VarList::DataIsValid(int range_index) {
 			return range_index > 0 && range_index <= static_cast<int>(lcf::Data::commonevents.size());
 		case eMapEvent:
 			return Game_Map::GetEvent(range_index) != nullptr;
+		case eProfile:
+			return range_index > 0 && range_index <= static_cast<int>(profile.size());
 		default:
 			break;
 	}
@@ -19,7 +19,9 @@
 #define EP_WINDOW_VARLIST_H
 
 // Headers
+#include <vector>
 #include "window_command.h"
+#include "interpreter_profiler.h"
 
 class Window_VarList : public Window_Command
 {
@@ -34,6 +36,7 @@ public:
 		eHeal,
 		eCommonEvent,
 		eMapEvent,
+		eProfile,
 	};
 
 	/**
@@ -80,6 +83,9 @@ private:
 	Mode mode = eNone;
 	int first_var = 0;
 
+	/** Profiler statistics ranked by total time, taken when the list is updated */
+	std::vector<InterpreterProfiler::Entry> profile;
+
 	bool DataIsValid(int range_index);
 
 };
@@ -0,0 +1,58 @@
+#include "battle_simulator.h"
+#include "doctest.h"
+#include "game_battle.h"
+#include "game_switches.h"
+#include "main_data.h"
+#include "rand.h"
+
+TEST_SUITE_BEGIN("BattleSimulator");
+
+TEST_CASE("Context") {
+	Main_Data::game_switches = std::make_unique<Game_Switches>();
+	auto* switches = Main_Data::game_switches.get();
+
+	Rand::SeedRandomNumberGenerator(1);
+	auto rng = Rand::GetRNG();
+
+	Rand::LockRandom(7);
+	{
+		BattleSimulator::Context context;
+		context.Install();
+		REQUIRE(context.IsInstalled());
+
+		// The battle starts with an empty state and its own RNG
+		REQUIRE(Main_Data::game_switches == nullptr);
+		REQUIRE_FALSE(Game_Battle::IsBattleRunning());
+		REQUIRE_FALSE(Rand::GetRandomLocked().first);
+
+		Main_Data::game_switches = std::make_unique<Game_Switches>();
+		Game_Battle::battle_running = true;
+		Rand::GetRNG().seed(2);
+		Rand::GetRNG()();
+		Rand::LockRandom(3);
+
+		context.Uninstall();
+		REQUIRE_FALSE(context.IsInstalled());
+
+		REQUIRE_EQ(Main_Data::game_switches.get(), switches);
+		REQUIRE_FALSE(Game_Battle::IsBattleRunning());
+		REQUIRE(Rand::GetRNG() == rng);
+		REQUIRE_EQ(Rand::GetRandomLocked(), std::make_pair(true, 7));
+
+		// Installing again brings back the state of the battle
+		context.Install();
+		REQUIRE(Main_Data::game_switches != nullptr);
+		REQUIRE_NE(Main_Data::game_switches.get(), switches);
+		REQUIRE(Game_Battle::IsBattleRunning());
+		REQUIRE_EQ(Rand::GetRandomLocked(), std::make_pair(true, 3));
+	}
+
+	// Uninstalled when destroyed
+	REQUIRE_EQ(Main_Data::game_switches.get(), switches);
+	REQUIRE_FALSE(Game_Battle::IsBattleRunning());
+
+	Rand::UnlockRandom();
+	Main_Data::game_switches.reset();
+}
+
+TEST_SUITE_END();
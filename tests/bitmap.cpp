@@ -0,0 +1,63 @@
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include "bitmap.h"
+#include "pixel_format.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("Bitmap");
+
+static uint32_t GetPixel(const Bitmap& bmp, int x, int y) {
+	auto* p = reinterpret_cast<const uint32_t*>(bmp.pixels());
+	return p[y * (bmp.pitch() / 4) + x];
+}
+
+static BitmapRef MakeQuad() {
+	auto src = Bitmap::Create(2, 2, true);
+	src->FillRect(Rect(0, 0, 1, 1), Color(255, 0, 0, 255));
+	src->FillRect(Rect(1, 0, 1, 1), Color(0, 255, 0, 255));
+	src->FillRect(Rect(0, 1, 1, 1), Color(0, 0, 255, 255));
+	src->FillRect(Rect(1, 1, 1, 1), Color(255, 255, 255, 255));
+	return src;
+}
+
+TEST_CASE("ZoomNearest") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+
+	auto src = MakeQuad();
+	auto dst = Bitmap::Create(4, 4, true);
+	dst->ZoomOpacityBlit(0, 0, 0, 0, *src, src->GetRect(), 2.0, 2.0, Opacity::Opaque());
+
+	for (int y = 0; y < 4; ++y) {
+		for (int x = 0; x < 4; ++x) {
+			REQUIRE_EQ(GetPixel(*dst, x, y), GetPixel(*src, x / 2, y / 2));
+		}
+	}
+}
+
+TEST_CASE("RotateHalfTurn") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+
+	auto src = MakeQuad();
+	auto dst = Bitmap::Create(4, 4, true);
+	dst->RotateZoomOpacityBlit(2, 2, 1, 1, *src, src->GetRect(), M_PI, 1.0, 1.0, Opacity::Opaque());
+
+	REQUIRE_EQ(GetPixel(*dst, 2, 2), GetPixel(*src, 0, 0));
+	REQUIRE_EQ(GetPixel(*dst, 1, 2), GetPixel(*src, 1, 0));
+	REQUIRE_EQ(GetPixel(*dst, 2, 1), GetPixel(*src, 0, 1));
+	REQUIRE_EQ(GetPixel(*dst, 1, 1), GetPixel(*src, 1, 1));
+	REQUIRE_EQ(GetPixel(*dst, 0, 0), 0);
+	REQUIRE_EQ(GetPixel(*dst, 3, 3), 0);
+}
+
+TEST_CASE("ZoomSplitOpacity") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+
+	auto src = Bitmap::Create(1, 2, Color(255, 255, 255, 255));
+	auto dst = Bitmap::Create(1, 2, true);
+	dst->ZoomOpacityBlit(0, 0, 0, 0, *src, src->GetRect(), 1.0, 1.0, Opacity(255, 0, 1));
+
+	REQUIRE_EQ(GetPixel(*dst, 0, 0), GetPixel(*src, 0, 0));
+	REQUIRE_EQ(GetPixel(*dst, 0, 1), 0);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,129 @@
+#include "cache.h"
+#include "bitmap.h"
+#include "pixel_format.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("Cache");
+
+TEST_CASE("SpriteEffectHit") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	Cache::Clear();
+
+	auto src = Bitmap::Create(16, 16, true);
+	auto rect = Rect(0, 0, 16, 16);
+
+	auto eff1 = Cache::SpriteEffect(src, rect, true, false, Tone(), Color());
+	auto eff2 = Cache::SpriteEffect(src, rect, true, false, Tone(), Color());
+	REQUIRE(eff1 != nullptr);
+	REQUIRE_EQ(eff1, eff2);
+
+	auto eff3 = Cache::SpriteEffect(src, rect, false, false, Tone(0, 0, 0, 128), Color());
+	REQUIRE_NE(eff1, eff3);
+
+	auto stats = Cache::GetEffectCacheStats();
+	REQUIRE_EQ(stats.hits, 1);
+	REQUIRE_EQ(stats.misses, 2);
+	REQUIRE_EQ(stats.entries, 2);
+	REQUIRE_EQ(stats.bytes, eff1->GetSize() + eff3->GetSize());
+
+	Cache::Clear();
+}
+
+TEST_CASE("SpriteEffectSourceDestroyed") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	Cache::Clear();
+
+	auto rect = Rect(0, 0, 16, 16);
+
+	auto src = Bitmap::Create(16, 16, true);
+	auto eff1 = Cache::SpriteEffect(src, rect, true, false, Tone(), Color());
+	src.reset();
+
+	// A new bitmap can reuse the address of the destroyed one
+	src = Bitmap::Create(16, 16, true);
+	auto eff2 = Cache::SpriteEffect(src, rect, true, false, Tone(), Color());
+	REQUIRE_NE(eff1, eff2);
+
+	auto stats = Cache::GetEffectCacheStats();
+	REQUIRE_EQ(stats.hits, 0);
+	REQUIRE_EQ(stats.misses, 2);
+
+	Cache::Clear();
+}
+
+TEST_CASE("SpriteEffectFlashReusesTone") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	Cache::Clear();
+
+	auto src = Bitmap::Create(16, 16, true);
+	auto rect = Rect(0, 0, 16, 16);
+	auto tone = Tone(0, 0, 0, 128);
+
+	// The toned variant is built once and shared by every flash step
+	auto eff1 = Cache::SpriteEffect(src, rect, false, false, tone, Color(255, 255, 255, 64));
+	auto eff2 = Cache::SpriteEffect(src, rect, false, false, tone, Color(255, 255, 255, 128));
+	REQUIRE_NE(eff1, eff2);
+
+	auto stats = Cache::GetEffectCacheStats();
+	REQUIRE_EQ(stats.hits, 1);
+	REQUIRE_EQ(stats.misses, 3);
+	REQUIRE_EQ(stats.entries, 3);
+
+	Cache::Clear();
+}
+
+TEST_CASE("WindowSkinPartShared") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	Cache::Clear();
+
+	using Part = Cache::WindowPart;
+
+	auto skin = Bitmap::Create(160, 80, true);
+
+	auto bg1 = Cache::WindowSkinPart(skin, Part::BackgroundStretch, 320, 80);
+	auto bg2 = Cache::WindowSkinPart(skin, Part::BackgroundStretch, 320, 80);
+	REQUIRE(bg1 != nullptr);
+	REQUIRE_EQ(bg1, bg2);
+	REQUIRE_EQ(bg1->GetRect(), Rect(0, 0, 320, 80));
+
+	REQUIRE_NE(bg1, Cache::WindowSkinPart(skin, Part::BackgroundTiled, 320, 80));
+	REQUIRE_NE(bg1, Cache::WindowSkinPart(skin, Part::BackgroundStretch, 320, 96));
+
+	// The strips are shared by windows with the same width or height
+	auto up1 = Cache::WindowSkinPart(skin, Part::FrameUp, 320, 80);
+	auto up2 = Cache::WindowSkinPart(skin, Part::FrameUp, 320, 240);
+	REQUIRE_EQ(up1, up2);
+	REQUIRE_EQ(up1->GetRect(), Rect(0, 0, 320, 8));
+
+	auto left1 = Cache::WindowSkinPart(skin, Part::FrameLeft, 88, 80);
+	auto left2 = Cache::WindowSkinPart(skin, Part::FrameLeft, 320, 80);
+	REQUIRE_EQ(left1, left2);
+	REQUIRE_EQ(left1->GetRect(), Rect(0, 0, 8, 64));
+	REQUIRE_NE(left1, Cache::WindowSkinPart(skin, Part::FrameRight, 320, 80));
+
+	auto other_skin = Bitmap::Create(160, 80, true);
+	REQUIRE_NE(bg1, Cache::WindowSkinPart(other_skin, Part::BackgroundStretch, 320, 80));
+
+	REQUIRE_EQ(Cache::GetNumWindowSkinParts(), 7);
+
+	Cache::Clear();
+	REQUIRE_EQ(Cache::GetNumWindowSkinParts(), 0);
+}
+
+TEST_CASE("WindowSkinPartSkinDestroyed") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	Cache::Clear();
+
+	auto skin = Bitmap::Create(160, 80, true);
+	auto bg1 = Cache::WindowSkinPart(skin, Cache::WindowPart::BackgroundStretch, 320, 80);
+	skin.reset();
+
+	// A new bitmap can reuse the address of the destroyed one
+	skin = Bitmap::Create(160, 80, true);
+	auto bg2 = Cache::WindowSkinPart(skin, Cache::WindowPart::BackgroundStretch, 320, 80);
+	REQUIRE_NE(bg1, bg2);
+
+	Cache::Clear();
+}
+
+TEST_SUITE_END();
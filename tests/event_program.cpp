@@ -0,0 +1,190 @@
+#include "event_program.h"
+#include "doctest.h"
+
+using Cmd = lcf::rpg::EventCommand::Code;
+using Op = EventProgram::Op;
+
+static lcf::rpg::EventCommand make(Cmd code, int indent, std::initializer_list<int32_t> params = {}) {
+	lcf::rpg::EventCommand com;
+	com.code = static_cast<int>(code);
+	com.indent = indent;
+	com.parameters = lcf::DBArray<int32_t>(params);
+	return com;
+}
+
+/** Commands together with their program */
+struct Program {
+	explicit Program(std::vector<lcf::rpg::EventCommand> commands)
+		: commands(std::move(commands)), program(static_cast<int>(this->commands.size())) {}
+
+	const EventProgram::Instr& operator[](int index) {
+		return program.Get(commands, index);
+	}
+
+	int size() const {
+		return program.size();
+	}
+
+	std::vector<lcf::rpg::EventCommand> commands;
+	EventProgram program;
+};
+
+TEST_SUITE_BEGIN("EventProgram");
+
+TEST_CASE("Empty") {
+	EventProgram program(0);
+	REQUIRE(program.empty());
+	REQUIRE_EQ(program.size(), 0);
+}
+
+TEST_CASE("Lazy") {
+	Program program({
+		make(Cmd::ControlSwitches, 0, { 0, 5, 5, 0 }),
+		make(Cmd::ControlSwitches, 0, { 0, 6, 6, 0 }),
+	});
+
+	REQUIRE_EQ(program[0].a, 5);
+
+	// Lowered on first use, afterwards the instruction is kept
+	program.commands[0].parameters[1] = 8;
+	program.commands[1].parameters[1] = 9;
+	REQUIRE_EQ(program[0].a, 5);
+	REQUIRE_EQ(program[1].a, 9);
+}
+
+TEST_CASE("Switches") {
+	Program program({
+		make(Cmd::ControlSwitches, 0, { 0, 5, 5, 0 }),
+		make(Cmd::ControlSwitches, 0, { 0, 6, 6, 1 }),
+		make(Cmd::ControlSwitches, 0, { 0, 7, 7, 2 }),
+		make(Cmd::ControlSwitches, 0, { 1, 1, 10, 0 }),
+		make(Cmd::ControlSwitches, 0, { 2, 1, 1, 0 }),
+	});
+
+	REQUIRE_EQ(program.size(), 5);
+	REQUIRE_EQ(program[0].op, Op::SetSwitch);
+	REQUIRE_EQ(program[0].a, 5);
+	REQUIRE_EQ(program[0].b, 1);
+	REQUIRE_EQ(program[1].op, Op::SetSwitch);
+	REQUIRE_EQ(program[1].b, 0);
+	REQUIRE_EQ(program[2].op, Op::FlipSwitch);
+	REQUIRE_EQ(program[2].a, 7);
+	// Ranges and indirect access use the command handler
+	REQUIRE_EQ(program[3].op, Op::Generic);
+	REQUIRE_EQ(program[4].op, Op::Generic);
+}
+
+TEST_CASE("Variables") {
+	Program program({
+		make(Cmd::ControlVars, 0, { 0, 3, 3, 1, 0, 42, 0 }),
+		make(Cmd::ControlVars, 0, { 0, 3, 3, 4, 1, 8, 0 }),
+		make(Cmd::ControlVars, 0, { 0, 3, 3, 0, 3, 1, 6 }),
+		make(Cmd::ControlVars, 0, { 1, 3, 5, 0, 0, 1, 0 }),
+		make(Cmd::ControlVars, 0, { 0, 3, 3, 9, 0, 1, 0 }),
+	});
+
+	REQUIRE_EQ(program[0].op, Op::VarOpConst);
+	REQUIRE_EQ(program[0].a, 3);
+	REQUIRE_EQ(program[0].b, 42);
+	REQUIRE_EQ(program[0].c, 1);
+	REQUIRE_EQ(program[1].op, Op::VarOpVar);
+	REQUIRE_EQ(program[1].b, 8);
+	REQUIRE_EQ(program[1].c, 4);
+	// Random, ranges and invalid operations use the command handler
+	REQUIRE_EQ(program[2].op, Op::Generic);
+	REQUIRE_EQ(program[3].op, Op::Generic);
+	REQUIRE_EQ(program[4].op, Op::Generic);
+}
+
+TEST_CASE("Wait") {
+	Program program({
+		make(Cmd::Wait, 0, { 10 }),
+		make(Cmd::Wait, 0, { 5, 0 }),
+		make(Cmd::Wait, 0, { 0, 1 }),
+	});
+
+	REQUIRE_EQ(program[0].op, Op::Wait);
+	REQUIRE_EQ(program[0].a, 10);
+	REQUIRE_EQ(program[1].op, Op::Wait);
+	REQUIRE_EQ(program[1].a, 5);
+	// Key wait
+	REQUIRE_EQ(program[2].op, Op::Generic);
+}
+
+TEST_CASE("Branches") {
+	Program program({
+		make(Cmd::ConditionalBranch, 0, { 0, 1, 0, 0, 0, 1 }),
+		make(Cmd::ConditionalBranch, 1, { 1, 2, 0, 7, 3, 0 }),
+		make(Cmd::ControlSwitches, 2, { 0, 1, 1, 0 }),
+		make(Cmd::EndBranch, 1),
+		make(Cmd::ElseBranch, 0),
+		make(Cmd::ConditionalBranch, 1, { 3, 100, 0 }),
+		make(Cmd::EndBranch, 1),
+		make(Cmd::EndBranch, 0),
+	});
+
+	REQUIRE_EQ(program[0].op, Op::BranchSwitch);
+	REQUIRE_EQ(program[0].a, 1);
+	REQUIRE_EQ(program[0].b, 1);
+	REQUIRE_EQ(program[0].target, 4);
+
+	REQUIRE_EQ(program[1].op, Op::BranchVarConst);
+	REQUIRE_EQ(program[1].a, 2);
+	REQUIRE_EQ(program[1].b, 7);
+	REQUIRE_EQ(program[1].c, 3);
+	REQUIRE_EQ(program[1].target, 3);
+
+	REQUIRE_EQ(program[3].op, Op::Nop);
+	REQUIRE_EQ(program[4].op, Op::Else);
+	REQUIRE_EQ(program[4].target, 7);
+
+	// Gold condition uses the command handler
+	REQUIRE_EQ(program[5].op, Op::Generic);
+}
+
+TEST_CASE("BranchWithoutEnd") {
+	Program program({
+		make(Cmd::ConditionalBranch, 0, { 1, 2, 1, 3, 0, 0 }),
+		make(Cmd::ControlSwitches, 1, { 0, 1, 1, 0 }),
+	});
+
+	REQUIRE_EQ(program[0].op, Op::BranchVarVar);
+	REQUIRE_EQ(program[0].target, 2);
+}
+
+TEST_CASE("Loops") {
+	Program program({
+		make(Cmd::Loop, 0),
+		make(Cmd::ControlSwitches, 1, { 0, 1, 1, 0 }),
+		make(Cmd::BreakLoop, 1),
+		make(Cmd::EndLoop, 0),
+		make(Cmd::BreakLoop, 0),
+		make(Cmd::EndLoop, 1),
+	});
+
+	REQUIRE_EQ(program[0].op, Op::Nop);
+	REQUIRE_EQ(program[2].op, Op::BreakLoop);
+	REQUIRE_EQ(program[2].target, 4);
+	REQUIRE_EQ(program[3].op, Op::EndLoop);
+	REQUIRE_EQ(program[3].target, 0);
+	// No EndLoop after it, jumps to the end
+	REQUIRE_EQ(program[4].target, 6);
+	// Lower indented command before the loop start
+	REQUIRE_EQ(program[5].target, EventProgram::kStall);
+}
+
+TEST_CASE("Labels") {
+	Program program({
+		make(Cmd::JumpToLabel, 0, { 2 }),
+		make(Cmd::Label, 0, { 1 }),
+		make(Cmd::Label, 0, { 2 }),
+		make(Cmd::JumpToLabel, 0, { 3 }),
+	});
+
+	REQUIRE_EQ(program[0].op, Op::JumpToLabel);
+	REQUIRE_EQ(program[0].target, 2);
+	REQUIRE_EQ(program[1].op, Op::Nop);
+	REQUIRE_EQ(program[3].target, -1);
+}
+
+TEST_SUITE_END();
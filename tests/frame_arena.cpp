@@ -0,0 +1,100 @@
+#include "frame_arena.h"
+#include "doctest.h"
+#include <cstdint>
+
+TEST_SUITE_BEGIN("FrameArena");
+
+static bool isAligned(const void* ptr, std::size_t align) {
+	return reinterpret_cast<std::uintptr_t>(ptr) % align == 0;
+}
+
+TEST_CASE("Allocate") {
+	FrameArena::Reset();
+	REQUIRE_EQ(FrameArena::GetUsedBytes(), 0);
+
+	auto* a = static_cast<char*>(FrameArena::Allocate(3, 1));
+	auto* b = FrameArena::Allocate(8, 8);
+	auto* c = FrameArena::Allocate(64, 64);
+
+	REQUIRE(isAligned(b, 8));
+	REQUIRE(isAligned(c, 64));
+	REQUIRE(a + 3 <= b);
+	REQUIRE(static_cast<char*>(b) + 8 <= c);
+	REQUIRE_GE(FrameArena::GetUsedBytes(), 3 + 8 + 64);
+
+	FrameArena::Reset();
+	REQUIRE_EQ(FrameArena::GetUsedBytes(), 0);
+	REQUIRE_EQ(FrameArena::Allocate(3, 1), a);
+}
+
+TEST_CASE("Deallocate") {
+	FrameArena::Reset();
+
+	auto* a = FrameArena::Allocate(16);
+	auto* b = FrameArena::Allocate(16);
+
+	// Only the latest allocation is given back
+	FrameArena::Deallocate(a, 16);
+	REQUIRE_NE(FrameArena::Allocate(16), a);
+
+	FrameArena::Reset();
+	a = FrameArena::Allocate(16);
+	b = FrameArena::Allocate(16);
+	FrameArena::Deallocate(b, 16);
+	REQUIRE_EQ(FrameArena::Allocate(16), b);
+}
+
+TEST_CASE("Grow") {
+	FrameArena::Allocate(1);
+	FrameArena::Reset();
+	const auto capacity = FrameArena::GetCapacity();
+
+	FrameArena::Allocate(capacity);
+	auto* big = FrameArena::Allocate(capacity * 2 + 1);
+	REQUIRE(big != nullptr);
+	REQUIRE_GE(FrameArena::GetUsedBytes(), capacity * 3 + 1);
+
+	// The blocks are merged, so the same frame fits into the arena again
+	FrameArena::Reset();
+	REQUIRE_GE(FrameArena::GetCapacity(), capacity * 3 + 1);
+	const auto merged = FrameArena::GetCapacity();
+
+	FrameArena::Allocate(capacity);
+	FrameArena::Allocate(capacity * 2 + 1);
+	REQUIRE_EQ(FrameArena::GetCapacity(), merged);
+	FrameArena::Reset();
+}
+
+TEST_CASE("Vector") {
+	FrameArena::Reset();
+
+	FrameVector<int> v;
+	for (int i = 0; i < 1000; ++i) {
+		v.push_back(i);
+	}
+	REQUIRE_EQ(v.size(), 1000);
+	REQUIRE_EQ(v.front(), 0);
+	REQUIRE_EQ(v.back(), 999);
+
+	// Old buffers stay in the arena until the reset
+	REQUIRE_LE(FrameArena::GetUsedBytes(), 2 * v.capacity() * sizeof(int));
+
+	v = {};
+	FrameArena::Reset();
+}
+
+TEST_CASE("HeapCounter") {
+	if (!FrameArena::IsHeapCounterEnabled()) {
+		REQUIRE_EQ(FrameArena::GetHeapAllocations(), 0);
+		return;
+	}
+
+	FrameArena::Reset();
+	// New expressions may be optimized away, calling the function directly may not
+	void* p = ::operator new(16);
+	::operator delete(p);
+	FrameArena::Reset();
+	REQUIRE_GE(FrameArena::GetHeapAllocations(), 1);
+}
+
+TEST_SUITE_END();
@@ -860,4 +860,56 @@ TEST_CASE("ChangeParam") {
 	}
 }
 
+TEST_CASE("StatCache") {
+	const MockActor m;
+	auto actor = MakeActor(1, 1, 99, 100, 10, 11, 12, 13, 14);
+	MakeDBEquip(1, lcf::rpg::Item::Type_weapon, 1, 2, 3, 4);
+
+	auto& state = lcf::Data::states[1];
+	state.affect_attack = true;
+	state.affect_type = lcf::rpg::State::AffectType_half;
+
+	Game_Battler::StatCacheScope scope;
+	REQUIRE_EQ(actor.GetAtk(), 11);
+
+	actor.SetEquipment(1, 1);
+	REQUIRE_EQ(actor.GetAtk(), 12);
+	REQUIRE_EQ(actor.GetAtk(Game_Battler::WeaponNone), 11);
+
+	actor.AddState(2, true);
+	REQUIRE_EQ(actor.GetAtk(), 6);
+
+	actor.ChangeAtkModifier(10);
+	REQUIRE_EQ(actor.GetAtk(), 11);
+
+	actor.RemoveState(2, false);
+	REQUIRE_EQ(actor.GetAtk(), 22);
+
+	actor.SetBaseAtk(50);
+	REQUIRE_EQ(actor.GetAtk(), 60);
+}
+
+TEST_CASE("StatCacheChangeClass") {
+	const MockActor m;
+	auto actor = MakeActor(1, 1, 99, 100, 10, 11, 12, 13, 14);
+
+	auto& cls = lcf::Data::classes[0];
+	cls.parameters.Setup(99);
+	cls.parameters.attack[0] = 30;
+	cls.parameters.agility[0] = 40;
+
+	Game_Battler::StatCacheScope scope;
+	actor.SetBaseAtk(50);
+	REQUIRE_EQ(actor.GetAtk(), 50);
+	REQUIRE_EQ(actor.GetAgi(), 14);
+
+	actor.ChangeClass(1, 1, Game_Actor::eSkillNoChange, Game_Actor::eParamReset, nullptr);
+	REQUIRE_EQ(actor.GetAtk(), 30);
+	REQUIRE_EQ(actor.GetAgi(), 40);
+
+	actor.ChangeClass(0, 1, Game_Actor::eSkillNoChange, Game_Actor::eParamReset, nullptr);
+	REQUIRE_EQ(actor.GetAtk(), 11);
+	REQUIRE_EQ(actor.GetAgi(), 14);
+}
+
 TEST_SUITE_END();
@@ -301,4 +301,28 @@ TEST_CASE("StopCountMoveFail") { testStop(false, false, 16, 16); }
 TEST_CASE("StopCountJump") { testStop(true, true, 4, 4); }
 TEST_CASE("StopCountJumpFail") { testStop(false, true, 16, 16); }
 
+TEST_CASE("MoveEventLookup") {
+	const MockGame mg(MockMap::ePassBlock20x15);
+
+	auto& ch = *MockGame::GetEvent(1);
+	ch.SetX(4);
+	ch.SetY(4);
+	REQUIRE_EQ(Game_Map::CheckEvent(4, 4), 1);
+
+	REQUIRE(ch.Move(Right));
+	REQUIRE_EQ(Game_Map::CheckEvent(4, 4), 0);
+	REQUIRE_EQ(Game_Map::CheckEvent(5, 4), 1);
+	REQUIRE_EQ(Game_Map::GetEventAt(5, 4, true), &ch);
+
+	ch.SetRemainingStep(0);
+	REQUIRE(ch.Jump(7, 6));
+	REQUIRE_EQ(Game_Map::GetEventAt(5, 4, false), nullptr);
+	REQUIRE_EQ(Game_Map::GetEventAt(7, 6, false), &ch);
+
+	std::vector<Game_Event*> events;
+	Game_Map::GetEventsXY(events, 7, 6);
+	REQUIRE_EQ(events.size(), 1);
+	REQUIRE_EQ(events[0], &ch);
+}
+
 TEST_SUITE_END();
@@ -0,0 +1,283 @@
+#include "mock_game.h"
+#include "game_interpreter.h"
+#include "game_commonevent.h"
+#include "event_program.h"
+#include "scene.h"
+#include "doctest.h"
+
+using Cmd = lcf::rpg::EventCommand::Code;
+using List = std::vector<lcf::rpg::EventCommand>;
+
+namespace {
+constexpr int kNumSwitches = 8;
+constexpr int kNumVariables = 8;
+/** Variables recording the order in which the trace points ran */
+constexpr int kTraceVar = 8;
+constexpr int kTraceVar2 = 7;
+
+lcf::rpg::EventCommand make(Cmd code, int indent, std::initializer_list<int32_t> params = {}) {
+	lcf::rpg::EventCommand com;
+	com.code = static_cast<int>(code);
+	com.indent = indent;
+	com.parameters = lcf::DBArray<int32_t>(params);
+	return com;
+}
+
+/** Appends the digit point to a trace variable */
+void trace(List& list, int indent, int point, int var = kTraceVar) {
+	list.push_back(make(Cmd::ControlVars, indent, { 0, var, var, 3, 0, 10, 0 }));
+	list.push_back(make(Cmd::ControlVars, indent, { 0, var, var, 1, 0, point, 0 }));
+}
+
+/** Game state after an interpreter update */
+struct State {
+	std::vector<bool> switches;
+	std::vector<int> variables;
+	bool running = false;
+	int loop_count = 0;
+
+	bool operator==(const State& o) const {
+		return switches == o.switches && variables == o.variables
+			&& running == o.running && loop_count == o.loop_count;
+	}
+};
+
+doctest::String toString(const State& state) {
+	std::string str = "switches:";
+	for (bool sw: state.switches) {
+		str += sw ? " 1" : " 0";
+	}
+	str += " variables:";
+	for (int var: state.variables) {
+		str += " " + std::to_string(var);
+	}
+	str += " running: " + std::to_string(state.running);
+	str += " loops: " + std::to_string(state.loop_count);
+	return str.c_str();
+}
+
+/**
+ * Executes the commands for some frames.
+ *
+ * @param list event commands
+ * @param lower whether the commands are lowered or all run through the command handlers
+ * @param frames number of interpreter updates
+ * @return state after each update
+ */
+std::vector<State> Run(const List& list, bool lower, int frames = 1) {
+	const MockGame mg(MockMap::ePassBlock20x15);
+	Scene::instance = std::make_shared<Scene>();
+
+	Game_Interpreter interp;
+	interp.Push(list, 0, false, {}, std::make_shared<EventProgram>(static_cast<int>(list.size()), lower));
+
+	std::vector<State> states;
+	for (int i = 0; i < frames; ++i) {
+		interp.Update();
+
+		State state;
+		for (int id = 1; id <= kNumSwitches; ++id) {
+			state.switches.push_back(Main_Data::game_switches->Get(id));
+		}
+		for (int id = 1; id <= kNumVariables; ++id) {
+			state.variables.push_back(Main_Data::game_variables->Get(id));
+		}
+		state.running = interp.IsRunning();
+		state.loop_count = interp.GetLoopCount();
+		states.push_back(std::move(state));
+	}
+
+	Scene::instance.reset();
+	return states;
+}
+
+/** Runs the commands lowered and through the command handlers, both must behave the same */
+void Compare(const List& list, int frames = 1) {
+	const auto lowered = Run(list, true, frames);
+	const auto handlers = Run(list, false, frames);
+	REQUIRE_EQ(lowered.size(), handlers.size());
+	for (size_t i = 0; i < lowered.size(); ++i) {
+		CAPTURE(i);
+		REQUIRE_EQ(lowered[i], handlers[i]);
+	}
+}
+}
+
+TEST_SUITE_BEGIN("Game_Interpreter");
+
+TEST_CASE("SwitchesAndVariables") {
+	List list = {
+		make(Cmd::ControlSwitches, 0, { 0, 1, 1, 0 }),
+		make(Cmd::ControlSwitches, 0, { 0, 2, 2, 0 }),
+		make(Cmd::ControlSwitches, 0, { 0, 2, 2, 1 }),
+		make(Cmd::ControlSwitches, 0, { 0, 3, 3, 2 }),
+		make(Cmd::ControlSwitches, 0, { 0, 1, 1, 2 }),
+		make(Cmd::ControlSwitches, 0, { 1, 5, 7, 0 }),
+		make(Cmd::ControlVars, 0, { 0, 1, 1, 0, 0, 42, 0 }),
+		make(Cmd::ControlVars, 0, { 0, 2, 2, 0, 0, -7, 0 }),
+		make(Cmd::ControlVars, 0, { 0, 1, 1, 1, 1, 2, 0 }),
+		make(Cmd::ControlVars, 0, { 0, 3, 3, 0, 1, 1, 0 }),
+		make(Cmd::ControlVars, 0, { 0, 3, 3, 2, 0, 5, 0 }),
+		make(Cmd::ControlVars, 0, { 0, 3, 3, 3, 1, 2, 0 }),
+		make(Cmd::ControlVars, 0, { 0, 3, 3, 4, 0, 4, 0 }),
+		make(Cmd::ControlVars, 0, { 0, 3, 3, 5, 0, 7, 0 }),
+		make(Cmd::ControlVars, 0, { 0, 4, 4, 4, 0, 0, 0 }),
+		make(Cmd::ControlVars, 0, { 0, 5, 5, 0, 0, 99999999, 0 }),
+		make(Cmd::ControlVars, 0, { 0, 5, 5, 3, 0, 999, 0 }),
+		make(Cmd::ControlVars, 0, { 1, 6, 7, 0, 0, 3, 0 }),
+	};
+
+	Compare(list);
+}
+
+TEST_CASE("Branches") {
+	List list = {
+		make(Cmd::ControlSwitches, 0, { 0, 1, 1, 0 }),
+		make(Cmd::ControlVars, 0, { 0, 1, 1, 0, 0, 5, 0 }),
+		make(Cmd::ControlVars, 0, { 0, 2, 2, 0, 0, 9, 0 }),
+	};
+	// Switch ON with else
+	list.push_back(make(Cmd::ConditionalBranch, 0, { 0, 1, 0, 0, 0, 1 }));
+	trace(list, 1, 1);
+	list.push_back(make(Cmd::ElseBranch, 0));
+	trace(list, 1, 2);
+	list.push_back(make(Cmd::EndBranch, 0));
+	// Switch OFF without else
+	list.push_back(make(Cmd::ConditionalBranch, 0, { 0, 2, 0, 0, 0, 0 }));
+	trace(list, 1, 3);
+	list.push_back(make(Cmd::EndBranch, 0));
+	// Nested variable branches against constants and variables
+	list.push_back(make(Cmd::ConditionalBranch, 0, { 1, 1, 0, 5, 0, 1 }));
+	list.push_back(make(Cmd::ConditionalBranch, 1, { 1, 1, 1, 2, 4, 1 }));
+	trace(list, 2, 4);
+	list.push_back(make(Cmd::ElseBranch, 1));
+	trace(list, 2, 5);
+	list.push_back(make(Cmd::EndBranch, 1));
+	list.push_back(make(Cmd::ElseBranch, 0));
+	trace(list, 1, 6);
+	list.push_back(make(Cmd::EndBranch, 0));
+	// Every comparison
+	for (int op = 0; op < 6; ++op) {
+		list.push_back(make(Cmd::ConditionalBranch, 0, { 1, 2, 0, 9, op, 1 }));
+		trace(list, 1, 1, kTraceVar2);
+		list.push_back(make(Cmd::ElseBranch, 0));
+		trace(list, 1, 2, kTraceVar2);
+		list.push_back(make(Cmd::EndBranch, 0));
+	}
+	// Branch without EndBranch at the end of the list
+	list.push_back(make(Cmd::ConditionalBranch, 0, { 0, 3, 0, 0, 0, 0 }));
+	trace(list, 1, 7);
+
+	Compare(list);
+}
+
+TEST_CASE("Loops") {
+	List list = {
+		make(Cmd::Loop, 0),
+		make(Cmd::ControlVars, 1, { 0, 1, 1, 1, 0, 1, 0 }),
+		make(Cmd::Loop, 1),
+		make(Cmd::ControlVars, 2, { 0, 2, 2, 1, 0, 1, 0 }),
+		make(Cmd::ConditionalBranch, 2, { 1, 2, 1, 1, 1, 0 }),
+		make(Cmd::BreakLoop, 3),
+		make(Cmd::EndBranch, 2),
+		make(Cmd::EndLoop, 1),
+		make(Cmd::ConditionalBranch, 1, { 1, 1, 0, 5, 0, 0 }),
+		make(Cmd::BreakLoop, 2),
+		make(Cmd::EndBranch, 1),
+		make(Cmd::EndLoop, 0),
+	};
+	trace(list, 0, 1);
+	// BreakLoop outside of a loop jumps to the end of the list
+	list.push_back(make(Cmd::BreakLoop, 0));
+	trace(list, 0, 2);
+
+	Compare(list);
+}
+
+TEST_CASE("LoopStall") {
+	List list = {
+		make(Cmd::ControlVars, 0, { 0, 1, 1, 1, 0, 1, 0 }),
+		make(Cmd::EndLoop, 1),
+	};
+	trace(list, 0, 1);
+
+	Compare(list, 3);
+}
+
+TEST_CASE("Labels") {
+	List list = {
+		make(Cmd::JumpToLabel, 0, { 2 }),
+	};
+	trace(list, 0, 1);
+	list.push_back(make(Cmd::Label, 0, { 1 }));
+	list.push_back(make(Cmd::ControlVars, 0, { 0, 1, 1, 1, 0, 1, 0 }));
+	list.push_back(make(Cmd::ConditionalBranch, 0, { 1, 1, 0, 3, 1, 0 }));
+	list.push_back(make(Cmd::JumpToLabel, 1, { 2 }));
+	list.push_back(make(Cmd::EndBranch, 0));
+	trace(list, 0, 2);
+	list.push_back(make(Cmd::JumpToLabel, 0, { 3 }));
+	list.push_back(make(Cmd::JumpToLabel, 0, { 4 }));
+	list.push_back(make(Cmd::Label, 0, { 2 }));
+	trace(list, 0, 3);
+	list.push_back(make(Cmd::ConditionalBranch, 0, { 1, 1, 0, 3, 4, 0 }));
+	list.push_back(make(Cmd::JumpToLabel, 1, { 1 }));
+	list.push_back(make(Cmd::EndBranch, 0));
+	list.push_back(make(Cmd::Label, 0, { 4 }));
+	trace(list, 0, 4);
+
+	Compare(list);
+}
+
+TEST_CASE("Wait") {
+	List list;
+	trace(list, 0, 1);
+	list.push_back(make(Cmd::Wait, 0, { 1 }));
+	trace(list, 0, 2);
+	list.push_back(make(Cmd::Wait, 0, { 0, 0 }));
+	trace(list, 0, 3);
+	list.push_back(make(Cmd::Wait, 0, { 2, 0 }));
+	trace(list, 0, 4);
+
+	Compare(list, 20);
+}
+
+TEST_CASE("SharedProgram") {
+	lcf::Data::commonevents.push_back({});
+	lcf::Data::commonevents.back().ID = 1;
+	lcf::Data::commonevents.back().event_commands = {
+		make(Cmd::ControlSwitches, 0, { 0, 1, 1, 0 }),
+	};
+
+	const MockGame mg(MockMap::ePassBlock20x15);
+	Scene::instance = std::make_shared<Scene>();
+
+	auto& ce = Game_Map::GetCommonEvents()[0];
+	REQUIRE_EQ(ce.GetProgram(), ce.GetProgram());
+
+	// Every call of the common event runs the program lowered by the first call
+	const List call = { make(Cmd::CallEvent, 0, { 0, 1 }) };
+	Game_Interpreter interp;
+	interp.Push(call, 0);
+	interp.Update();
+	REQUIRE(Main_Data::game_switches->Get(1));
+
+	lcf::Data::commonevents[0].event_commands[0].parameters[1] = 2;
+	lcf::Data::commonevents[0].event_commands[0].parameters[2] = 2;
+	interp.Clear();
+	interp.Push(call, 0);
+	interp.Update();
+	REQUIRE(Main_Data::game_switches->Get(1));
+	REQUIRE_FALSE(Main_Data::game_switches->Get(2));
+
+	// Pages of map events share their program, pages of other events have none
+	auto* ev = MockGame::GetEvent(1);
+	const auto* page = ev->GetPage(1);
+	REQUIRE(ev->GetProgram(page) != nullptr);
+	REQUIRE_EQ(ev->GetProgram(page), ev->GetProgram(page));
+	lcf::rpg::EventPage other_page;
+	REQUIRE(ev->GetProgram(&other_page) == nullptr);
+
+	Scene::instance.reset();
+}
+
+TEST_SUITE_END();
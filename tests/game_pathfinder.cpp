@@ -0,0 +1,157 @@
+#include "game_pathfinder.h"
+#include "doctest.h"
+#include "game_map.h"
+#include "map_data.h"
+#include <lcf/data.h>
+#include <algorithm>
+
+#include "mock_game.h"
+
+TEST_SUITE_BEGIN("Game_Pathfinder");
+
+// Lets the lower layer decide the passability, the right half of the map becomes a wall
+static void blockRightHalf() {
+	lcf::Data::chipsets.back().passable_data_upper[1] = Passable::Above | 0xF;
+	Game_Map::SetChipset(Game_Map::GetChipset());
+	Game_Map::SubstituteUp(0, 1);
+}
+
+static int countSteps(const std::vector<int>& path, int dir) {
+	return static_cast<int>(std::count(path.begin(), path.end(), dir));
+}
+
+TEST_CASE("TileLayers") {
+	const MockGame mg(MockMap::ePassBlock20x15);
+
+	REQUIRE(Game_Map::IsPassableTileLayers(Passable::Left, 5, 5));
+	REQUIRE(Game_Map::IsPassableTileLayers(Passable::Left, 12, 5));
+	REQUIRE_FALSE(Game_Map::IsPassableTileLayers(Passable::Left, 20, 5));
+
+	blockRightHalf();
+
+	REQUIRE(Game_Map::IsPassableTileLayers(Passable::Left, 5, 5));
+	REQUIRE_FALSE(Game_Map::IsPassableTileLayers(Passable::Left, 12, 5));
+	REQUIRE_EQ(Game_Map::IsPassableTileLayers(Passable::Left, 12, 5), Game_Map::IsPassableTile(nullptr, Passable::Left, 12, 5));
+}
+
+TEST_CASE("Straight") {
+	const MockGame mg(MockMap::ePass40x30);
+
+	auto& ch = *MockGame::GetEvent(1);
+	ch.SetX(2);
+	ch.SetY(2);
+
+	std::vector<int> path;
+	REQUIRE(Game_Pathfinder::FindPath(ch, 6, 2, path));
+	REQUIRE_EQ(path, std::vector<int>(4, Right));
+
+	REQUIRE(Game_Pathfinder::FindPath(ch, 2, 2, path));
+	REQUIRE(path.empty());
+
+	REQUIRE_FALSE(Game_Pathfinder::FindPath(ch, 40, 2, path));
+	REQUIRE(path.empty());
+}
+
+TEST_CASE("AroundPlayer") {
+	const MockGame mg(MockMap::ePass40x30);
+
+	auto& ch = *MockGame::GetEvent(1);
+	ch.SetX(2);
+	ch.SetY(2);
+	ch.SetLayer(lcf::rpg::EventPage::Layers_same);
+
+	auto& player = *MockGame::GetPlayer();
+	player.SetX(4);
+	player.SetY(2);
+
+	std::vector<int> path;
+	REQUIRE(Game_Pathfinder::FindPath(ch, 6, 2, path));
+	REQUIRE_EQ(path.size(), 6);
+	REQUIRE_EQ(countSteps(path, Right), 4);
+
+	// The target tile is not blocked by the player, the path ends next to it
+	REQUIRE(Game_Pathfinder::FindPath(ch, 4, 2, path));
+	REQUIRE_EQ(path, std::vector<int>(1, Right));
+
+	// Different layers do not collide
+	ch.SetLayer(lcf::rpg::EventPage::Layers_below);
+	REQUIRE(Game_Pathfinder::FindPath(ch, 6, 2, path));
+	REQUIRE_EQ(path.size(), 4);
+}
+
+TEST_CASE("Unreachable") {
+	const MockGame mg(MockMap::ePassBlock20x15);
+	blockRightHalf();
+
+	auto& ch = *MockGame::GetEvent(1);
+	ch.SetX(5);
+	ch.SetY(5);
+
+	std::vector<int> path;
+	REQUIRE_FALSE(Game_Pathfinder::FindPath(ch, 12, 5, path));
+	REQUIRE_EQ(path, std::vector<int>(4, Right));
+
+	ch.SetThrough(true);
+	REQUIRE(Game_Pathfinder::FindPath(ch, 12, 5, path));
+	REQUIRE_EQ(path, std::vector<int>(7, Right));
+}
+
+TEST_CASE("MoveRoute") {
+	using Code = lcf::rpg::MoveCommand::Code;
+
+	auto route = Game_Pathfinder::MakeMoveRoute({ Up, Right, Down, Left });
+	REQUIRE_FALSE(route.repeat);
+	REQUIRE_FALSE(route.skippable);
+	REQUIRE_EQ(route.move_commands.size(), 4);
+	REQUIRE_EQ(route.move_commands[0].command_id, static_cast<int>(Code::move_up));
+	REQUIRE_EQ(route.move_commands[1].command_id, static_cast<int>(Code::move_right));
+	REQUIRE_EQ(route.move_commands[2].command_id, static_cast<int>(Code::move_down));
+	REQUIRE_EQ(route.move_commands[3].command_id, static_cast<int>(Code::move_left));
+
+	route = Game_Pathfinder::MakeMoveRoute({ Up, Right, Down, Left }, 2);
+	REQUIRE_EQ(route.move_commands.size(), 2);
+}
+
+TEST_CASE("MoveTo") {
+	const MockGame mg(MockMap::ePass40x30);
+
+	auto& ch = *MockGame::GetEvent(1);
+	ch.SetX(2);
+	ch.SetY(2);
+
+	REQUIRE(Game_Pathfinder::MoveTo(ch, 5, 4));
+	REQUIRE(ch.IsMoveRouteOverwritten());
+
+	for (int i = 0; i < 1000 && ch.IsMoveRouteOverwritten(); ++i) {
+		ForceUpdate(ch);
+	}
+
+	REQUIRE_EQ(ch.GetX(), 5);
+	REQUIRE_EQ(ch.GetY(), 4);
+}
+
+TEST_CASE("MoveToPlayer") {
+	const MockGame mg(MockMap::ePass40x30);
+
+	auto& ch = *MockGame::GetEvent(1);
+	ch.SetX(2);
+	ch.SetY(2);
+	ch.SetLayer(lcf::rpg::EventPage::Layers_same);
+
+	auto& player = *MockGame::GetPlayer();
+	player.SetX(5);
+	player.SetY(2);
+
+	REQUIRE(Game_Pathfinder::MoveTo(ch, 5, 2));
+
+	for (int i = 0; i < 1000 && ch.IsMoveRouteOverwritten(); ++i) {
+		ForceUpdate(ch);
+	}
+
+	// The route finishes next to the player instead of waiting for the tile
+	REQUIRE_FALSE(ch.IsMoveRouteOverwritten());
+	REQUIRE_EQ(ch.GetX(), 4);
+	REQUIRE_EQ(ch.GetY(), 2);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,91 @@
+#include "game_pictures.h"
+#include "player.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("Game_Pictures");
+
+namespace {
+class EngineGuard {
+public:
+	explicit EngineGuard(int eng) : _engine(Player::engine) {
+		Player::engine = eng;
+	}
+
+	EngineGuard(const EngineGuard&) = delete;
+	EngineGuard& operator=(const EngineGuard&) = delete;
+
+	~EngineGuard() {
+		Player::engine = _engine;
+	}
+private:
+	int _engine = {};
+};
+
+Game_Pictures::ShowParams MakeShowParams() {
+	Game_Pictures::ShowParams params = {};
+	params.position_x = 160;
+	params.position_y = 120;
+	params.magnify = 100;
+	params.red = 100;
+	params.green = 100;
+	params.blue = 100;
+	params.saturation = 100;
+	return params;
+}
+}
+
+TEST_CASE("SaveWithErasedPictures") {
+	const EngineGuard eg(Player::EngineRpg2k3 | Player::EngineEnglish);
+
+	Game_Pictures pics;
+	pics.Show(1, MakeShowParams());
+	pics.Show(3, MakeShowParams());
+
+	Game_Pictures::MoveParams move = {};
+	static_cast<Game_Pictures::Params&>(move) = MakeShowParams();
+	move.position_x = 0;
+	move.duration = 1;
+	pics.Move(1, move);
+
+	pics.Update(false);
+	pics.Erase(1);
+	for (int i = 0; i < 4; ++i) {
+		pics.Update(false);
+	}
+
+	auto save = pics.GetSaveData();
+	REQUIRE_EQ(save.size(), 1000u);
+
+	// Erased pictures keep their record, count frames and finish moving
+	REQUIRE_EQ(save[0].ID, 1);
+	REQUIRE(save[0].name.empty());
+	REQUIRE_EQ(save[0].frames, 5);
+	REQUIRE_EQ(save[0].time_left, 1);
+	REQUIRE_LT(save[0].current_x, 160.0);
+	REQUIRE_GT(save[0].current_x, 0.0);
+
+	REQUIRE_EQ(save[2].ID, 3);
+	REQUIRE_EQ(save[2].frames, 5);
+	REQUIRE_EQ(save[2].current_x, 160.0);
+
+	// Unused slots are padded with the frame counter
+	REQUIRE_EQ(save[999].ID, 1000);
+	REQUIRE_EQ(save[999].frames, 5);
+
+	// Loading and saving again gives the same data, also after more frames
+	Game_Pictures loaded;
+	loaded.SetSaveData(save);
+	REQUIRE(loaded.GetSaveData() == save);
+
+	for (int i = 0; i < 10; ++i) {
+		pics.Update(false);
+		loaded.Update(false);
+	}
+	save = pics.GetSaveData();
+	REQUIRE(loaded.GetSaveData() == save);
+	REQUIRE_EQ(save[0].frames, 15);
+	REQUIRE_EQ(save[0].time_left, 0);
+	REQUIRE_EQ(save[0].current_x, 0.0);
+}
+
+TEST_SUITE_END();
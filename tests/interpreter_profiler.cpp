@@ -0,0 +1,124 @@
+#include <sstream>
+#include <string>
+#include "interpreter_profiler.h"
+#include "doctest.h"
+
+using namespace std::chrono_literals;
+using Source = InterpreterProfiler::Source;
+using Owner = InterpreterProfiler::Owner;
+
+TEST_SUITE_BEGIN("InterpreterProfiler");
+
+TEST_CASE("Record") {
+	InterpreterProfiler::Reset();
+
+	InterpreterProfiler::Record(3, {}, 0, 1, 10110, 2ms);
+	InterpreterProfiler::Record(3, {}, 0, 1, 10110, 3ms);
+	InterpreterProfiler::Record(3, {}, 1, 1, 10110, 1ms);
+
+	auto entries = InterpreterProfiler::GetEntries();
+	REQUIRE_EQ(InterpreterProfiler::GetNumEntries(), 2);
+	REQUIRE_EQ(entries.size(), 2);
+
+	REQUIRE(entries[0].source == Source::Foreground);
+	REQUIRE_EQ(entries[0].owner_id, 3);
+	REQUIRE_EQ(entries[0].depth, 0);
+	REQUIRE_EQ(entries[0].index, 1);
+	REQUIRE_EQ(entries[0].code, 10110);
+	REQUIRE_EQ(entries[0].count, 2);
+	REQUIRE(entries[0].time == 5ms);
+
+	REQUIRE_EQ(entries[1].depth, 1);
+	REQUIRE_EQ(entries[1].count, 1);
+
+	InterpreterProfiler::Reset();
+	REQUIRE(InterpreterProfiler::GetEntries().empty());
+}
+
+TEST_CASE("Scope") {
+	InterpreterProfiler::Reset();
+
+	{
+		InterpreterProfiler::Scope ce(Source::CommonEvent, 7, 0);
+		InterpreterProfiler::Record(0, {}, 0, 0, 10220, 1ms);
+		{
+			InterpreterProfiler::Scope ev(Source::MapEvent, 12, 2);
+			InterpreterProfiler::Record(0, {}, 0, 0, 10220, 4ms);
+		}
+		InterpreterProfiler::Record(0, {}, 0, 0, 10220, 1ms);
+	}
+	InterpreterProfiler::Record(5, {}, 0, 0, 10220, 3ms);
+
+	auto entries = InterpreterProfiler::GetEntries();
+	REQUIRE_EQ(entries.size(), 3);
+
+	REQUIRE(entries[0].source == Source::MapEvent);
+	REQUIRE_EQ(entries[0].owner_id, 12);
+	REQUIRE_EQ(entries[0].page_id, 2);
+
+	REQUIRE(entries[1].source == Source::Foreground);
+	REQUIRE_EQ(entries[1].owner_id, 5);
+
+	REQUIRE(entries[2].source == Source::CommonEvent);
+	REQUIRE_EQ(entries[2].owner_id, 7);
+	REQUIRE_EQ(entries[2].count, 2);
+
+	InterpreterProfiler::Reset();
+}
+
+TEST_CASE("CalledEvent") {
+	InterpreterProfiler::Reset();
+
+	{
+		InterpreterProfiler::Scope ev(Source::MapEvent, 12, 1);
+		InterpreterProfiler::Record(0, Owner{ Source::MapEvent, 12, 1 }, 0, 0, 12330, 1ms);
+		InterpreterProfiler::Record(0, Owner{ Source::CommonEvent, 3, 0 }, 1, 0, 10110, 2ms);
+		InterpreterProfiler::Record(0, Owner{ Source::CommonEvent, 4, 0 }, 1, 0, 10110, 4ms);
+	}
+	{
+		// The same common event running on its own is merged
+		InterpreterProfiler::Scope ce(Source::CommonEvent, 3, 0);
+		InterpreterProfiler::Record(0, Owner{ Source::CommonEvent, 3, 0 }, 0, 0, 10110, 1ms);
+	}
+
+	auto entries = InterpreterProfiler::GetEntries();
+	REQUIRE_EQ(entries.size(), 3);
+
+	REQUIRE(entries[0].source == Source::CommonEvent);
+	REQUIRE_EQ(entries[0].owner_id, 4);
+	REQUIRE_EQ(entries[0].depth, 1);
+
+	REQUIRE(entries[1].source == Source::CommonEvent);
+	REQUIRE_EQ(entries[1].owner_id, 3);
+	REQUIRE_EQ(entries[1].count, 2);
+	REQUIRE(entries[1].time == 3ms);
+	REQUIRE_EQ(entries[1].depth, 1);
+
+	REQUIRE(entries[2].source == Source::MapEvent);
+	REQUIRE_EQ(entries[2].owner_id, 12);
+	REQUIRE_EQ(entries[2].page_id, 1);
+
+	InterpreterProfiler::Reset();
+}
+
+TEST_CASE("Report") {
+	InterpreterProfiler::Reset();
+
+	InterpreterProfiler::Record(1, {}, 0, 4, 10310, 1ms);
+	InterpreterProfiler::Record(1, {}, 0, 2, 10220, 2ms);
+
+	std::stringstream ss;
+	REQUIRE(InterpreterProfiler::WriteReport(ss));
+
+	std::string line;
+	std::getline(ss, line);
+	REQUIRE_EQ(line, "source\tid\tpage\tdepth\tindex\tcode\tcount\ttotal_us\tavg_us");
+	std::getline(ss, line);
+	REQUIRE_EQ(line, "foreground\t1\t0\t0\t2\t10220\t1\t2000\t2000");
+	std::getline(ss, line);
+	REQUIRE_EQ(line, "foreground\t1\t0\t0\t4\t10310\t1\t1000\t1000");
+
+	InterpreterProfiler::Reset();
+}
+
+TEST_SUITE_END();
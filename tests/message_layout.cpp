@@ -0,0 +1,101 @@
+#include "message_layout.h"
+#include "font.h"
+#include <iostream>
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("MessageLayout");
+
+using Type = MessageRun::Type;
+
+constexpr uint32_t escape = '\\';
+
+static const char* Layout(const std::string& text, const char* iter, std::vector<MessageRun>& runs) {
+	return MessageLayout::LayoutPage(iter, text.data() + text.size(), escape, *Font::Default(), runs);
+}
+
+TEST_CASE("Pages") {
+	const std::string text = "a\\c[3]$A\\_\\!\n\f\\s[5]b\\q\n\f";
+	std::vector<MessageRun> runs;
+
+	auto* next = Layout(text, text.data(), runs);
+	REQUIRE_EQ(next, text.data() + text.find('\f') + 1);
+	REQUIRE_EQ(runs.size(), 7);
+
+	REQUIRE_EQ(runs[0].type, Type::Glyph);
+	REQUIRE_EQ(runs[0].value, 'a');
+	REQUIRE_EQ(runs[0].width, 1);
+	REQUIRE_FALSE(runs[0].last_for_line);
+	REQUIRE_FALSE(runs[0].last_for_page);
+
+	REQUIRE_EQ(runs[1].type, Type::Color);
+	REQUIRE_EQ(runs[1].value, 3);
+
+	REQUIRE_EQ(runs[2].type, Type::ExFont);
+	REQUIRE_EQ(runs[2].value, 0);
+	REQUIRE_EQ(runs[2].width, 2);
+
+	REQUIRE_EQ(runs[3].type, Type::HalfSpace);
+	REQUIRE_EQ(runs[3].value, 3);
+
+	REQUIRE_EQ(runs[4].type, Type::Pause);
+	REQUIRE(runs[4].last_for_line);
+	REQUIRE(runs[4].last_for_page);
+
+	REQUIRE_EQ(runs[5].type, Type::NewLine);
+	REQUIRE_EQ(runs[5].value, 1);
+
+	REQUIRE_EQ(runs[6].type, Type::PageEnd);
+	REQUIRE_EQ(runs[6].value, 1);
+
+	next = Layout(text, next, runs);
+	REQUIRE_EQ(next, text.data() + text.size());
+	REQUIRE_EQ(runs.size(), 5);
+
+	REQUIRE_EQ(runs[0].type, Type::Speed);
+	REQUIRE_EQ(runs[0].value, 5);
+
+	REQUIRE_EQ(runs[1].type, Type::Glyph);
+	REQUIRE_EQ(runs[1].value, 'b');
+	REQUIRE_FALSE(runs[1].last_for_page);
+
+	REQUIRE_EQ(runs[2].type, Type::Unknown);
+	REQUIRE(runs[2].last_for_page);
+
+	REQUIRE_EQ(runs[3].type, Type::NewLine);
+	REQUIRE_EQ(runs[4].type, Type::PageEnd);
+	REQUIRE_EQ(runs[4].value, 0);
+}
+
+TEST_CASE("Lines") {
+	const std::string text = "x\x01y\ny\\\\\n\f";
+	std::vector<MessageRun> runs;
+
+	Layout(text, text.data(), runs);
+	REQUIRE_EQ(runs.size(), 7);
+
+	// Control characters are skipped, but RPG_RT still sees them when looking ahead
+	REQUIRE_EQ(runs[0].value, 'x');
+	REQUIRE_FALSE(runs[0].last_for_line);
+	REQUIRE_EQ(runs[1].value, 'y');
+	REQUIRE(runs[1].last_for_line);
+	REQUIRE_FALSE(runs[1].last_for_page);
+
+	REQUIRE_EQ(runs[2].type, Type::NewLine);
+	REQUIRE_EQ(runs[2].value, 0);
+
+	// An escaped escape character is a glyph
+	REQUIRE_EQ(runs[4].type, Type::Glyph);
+	REQUIRE_EQ(runs[4].value, '\\');
+	REQUIRE(runs[4].last_for_page);
+}
+
+TEST_CASE("FullWidth") {
+	const std::string text = u8"あ\n\f";
+	std::vector<MessageRun> runs;
+
+	Layout(text, text.data(), runs);
+	REQUIRE_EQ(runs.size(), 3);
+	REQUIRE_EQ(runs[0].width, 2);
+}
+
+TEST_SUITE_END();
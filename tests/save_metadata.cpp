@@ -0,0 +1,75 @@
+#include <sstream>
+#include "save_metadata.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("SaveMetadata");
+
+static lcf::rpg::SaveTitle MakeTitle() {
+	lcf::rpg::SaveTitle title;
+	title.timestamp = 44197.5;
+	title.hero_name = "Alex";
+	title.hero_level = 12;
+	title.hero_hp = 345;
+	title.face1_name = "Actor1";
+	title.face1_id = 2;
+	title.face4_name = "Monster";
+	title.face4_id = 7;
+	return title;
+}
+
+TEST_CASE("Names") {
+	REQUIRE_EQ(SaveMetadata::GetSaveName(1), "Save01.lsd");
+	REQUIRE_EQ(SaveMetadata::GetSaveName(15), "Save15.lsd");
+	REQUIRE_EQ(SaveMetadata::GetSidecarName(3), "Save03.lsd.meta");
+}
+
+TEST_CASE("RoundTrip") {
+	SaveMetadata::SaveInfo info;
+	info.size = 12345;
+	info.mtime = 1700000000123;
+	info.crc = 0xDEADBEEF;
+
+	std::stringstream ss;
+	REQUIRE(SaveMetadata::Write(ss, MakeTitle(), info));
+
+	lcf::rpg::SaveTitle title;
+	SaveMetadata::SaveInfo read_info;
+	REQUIRE(SaveMetadata::Read(ss, title, read_info));
+
+	auto expected = MakeTitle();
+	REQUIRE_EQ(read_info.size, 12345);
+	REQUIRE_EQ(read_info.mtime, 1700000000123);
+	REQUIRE_EQ(read_info.crc, 0xDEADBEEF);
+	REQUIRE_EQ(title.timestamp, expected.timestamp);
+	REQUIRE_EQ(title.hero_name, expected.hero_name);
+	REQUIRE_EQ(title.hero_level, expected.hero_level);
+	REQUIRE_EQ(title.hero_hp, expected.hero_hp);
+	REQUIRE_EQ(title.face1_name, expected.face1_name);
+	REQUIRE_EQ(title.face1_id, expected.face1_id);
+	REQUIRE_EQ(title.face2_name, "");
+	REQUIRE_EQ(title.face4_name, expected.face4_name);
+	REQUIRE_EQ(title.face4_id, expected.face4_id);
+}
+
+TEST_CASE("Invalid") {
+	lcf::rpg::SaveTitle title;
+	SaveMetadata::SaveInfo info;
+
+	SUBCASE("garbage") {
+		std::stringstream ss("LcfSaveData");
+		REQUIRE_FALSE(SaveMetadata::Read(ss, title, info));
+	}
+
+	SUBCASE("truncated") {
+		std::stringstream ss;
+		SaveMetadata::Write(ss, MakeTitle(), info);
+		auto data = ss.str();
+		data.pop_back();
+
+		std::stringstream truncated(data);
+		REQUIRE_FALSE(SaveMetadata::Read(truncated, title, info));
+		REQUIRE_EQ(title.hero_name, "");
+	}
+}
+
+TEST_SUITE_END();
@@ -122,6 +122,67 @@ TEST_CASE("FlipRange") {
 	REQUIRE_FALSE(s.Get(n + 1));
 }
 
+TEST_CASE("RangeWordBoundaries") {
+	constexpr int n = 200;
+	auto s = make();
+
+	s.SetRange(60, 130, true);
+	for (int i = 1; i <= n; ++i) {
+		REQUIRE_EQ(s.Get(i), i >= 60 && i <= 130);
+	}
+
+	s.FlipRange(64, 65);
+	REQUIRE_FALSE(s.Get(64));
+	REQUIRE_FALSE(s.Get(65));
+	REQUIRE(s.Get(63));
+	REQUIRE(s.Get(66));
+
+	s.SetRange(1, n, false);
+	for (int i = 1; i <= n; ++i) {
+		REQUIRE_FALSE(s.Get(i));
+	}
+	REQUIRE_FALSE(s.Get(n + 1));
+}
+
+TEST_CASE("CountOn") {
+	constexpr int n = 200;
+	auto s = make();
+
+	REQUIRE_EQ(s.CountOn(1, n), 0);
+
+	s.SetRange(60, 130, true);
+	REQUIRE_EQ(s.CountOn(1, n), 71);
+	REQUIRE_EQ(s.CountOn(-1, n * 2), 71);
+	REQUIRE_EQ(s.CountOn(61, 64), 4);
+	REQUIRE_EQ(s.CountOn(130, 130), 1);
+	REQUIRE_EQ(s.CountOn(131, n), 0);
+	REQUIRE_EQ(s.CountOn(n, 1), 0);
+
+	s.Flip(100);
+	REQUIRE_EQ(s.CountOn(1, n), 70);
+}
+
+TEST_CASE("Data") {
+	auto s = make();
+
+	Game_Switches::Switches_t data = { true, false, false, true, true };
+	data.resize(70);
+	data[68] = true;
+	s.SetData(data);
+
+	REQUIRE(s.Get(1));
+	REQUIRE_FALSE(s.Get(2));
+	REQUIRE(s.Get(69));
+	REQUIRE_FALSE(s.Get(70));
+	REQUIRE_FALSE(s.Get(71));
+	REQUIRE_EQ(s.CountOn(1, 70), 4);
+	REQUIRE(s.GetData() == data);
+
+	s.Set(80, false);
+	data.resize(80);
+	REQUIRE(s.GetData() == data);
+}
+
 TEST_CASE("GetSize") {
 	auto s = make();
 	REQUIRE_EQ(s.GetSize(), max_switches);
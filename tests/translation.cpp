@@ -0,0 +1,103 @@
+#include <sstream>
+#include "translation.h"
+#include "doctest.h"
+
+static const char* po_file = R"(msgid ""
+msgstr ""
+
+msgid "Hello\nWorld"
+msgstr "Hola\n"
+"Mundo"
+
+msgid "Untranslated"
+msgstr ""
+
+msgctxt "actors.1.name"
+msgid "Alex"
+msgstr "Alejandro"
+)";
+
+TEST_SUITE_BEGIN("Translation");
+
+static void CheckDictionary(const Dictionary& dict) {
+	std::string name = "Alex";
+	REQUIRE(dict.TranslateString("actors.1.name", name));
+	REQUIRE_EQ(name, "Alejandro");
+
+	name = "Alex";
+	REQUIRE_FALSE(dict.TranslateString("", name));
+	REQUIRE_EQ(name, "Alex");
+
+	std::string msg = "Hello\nWorld";
+	REQUIRE(dict.TranslateString("", msg));
+	REQUIRE_EQ(msg, "Hola\nMundo");
+
+	std::string untranslated = "Untranslated";
+	REQUIRE_FALSE(dict.TranslateString("", untranslated));
+}
+
+TEST_CASE("FromPo") {
+	std::istringstream is(po_file);
+	Dictionary dict;
+	REQUIRE(Dictionary::FromPo(dict, is));
+	CheckDictionary(dict);
+}
+
+TEST_CASE("FromPoError") {
+	std::istringstream is("msgid \"\"\nmsgstr \"\"\n\nmsgid \"Bad\\q\"\nmsgstr \"x\"\n");
+	Dictionary dict;
+	std::string error;
+	REQUIRE_FALSE(Dictionary::FromPo(dict, is, &error));
+	REQUIRE_FALSE(error.empty());
+}
+
+TEST_CASE("Find") {
+	std::stringstream po;
+	po << "msgid \"\"\nmsgstr \"\"\n\n";
+	for (int i = 0; i < 200; ++i) {
+		po << "msgid \"Line " << i << "\"\nmsgstr \"Linea " << i << "\"\n\n";
+	}
+	po << "msgid \"Line 7\"\nmsgstr \"Otra\"\n\n";
+	po << "msgctxt \"items.1.name\"\nmsgid \"Line 1\"\nmsgstr \"Objeto\"\n";
+
+	Dictionary dict;
+	REQUIRE(Dictionary::FromPo(dict, po));
+	REQUIRE_EQ(dict.GetNumEntries(), 201);
+
+	for (int i = 0; i < 200; ++i) {
+		const auto* tr = dict.Find("", "Line " + std::to_string(i));
+		REQUIRE(tr);
+		if (i != 7) {
+			REQUIRE_EQ(*tr, "Linea " + std::to_string(i));
+		}
+	}
+
+	// Duplicates replace the earlier translation
+	REQUIRE_EQ(*dict.Find("", "Line 7"), "Otra");
+
+	REQUIRE_EQ(*dict.Find("items.1.name", "Line 1"), "Objeto");
+	REQUIRE_FALSE(dict.Find("items.2.name", "Line 1"));
+	REQUIRE_FALSE(dict.Find("", "Line 200"));
+	REQUIRE_NE(Dictionary::Hash("a", "b"), Dictionary::Hash("", "ab"));
+}
+
+TEST_CASE("Cache") {
+	std::istringstream is(po_file);
+	Dictionary dict;
+	REQUIRE(Dictionary::FromPo(dict, is));
+
+	std::stringstream cache;
+	REQUIRE(dict.ToCache(cache));
+
+	Dictionary cached;
+	REQUIRE(Dictionary::FromCache(cached, cache));
+	CheckDictionary(cached);
+
+	std::string data = cache.str();
+	data.resize(data.size() / 2);
+	std::istringstream truncated(data);
+	Dictionary invalid;
+	REQUIRE_FALSE(Dictionary::FromCache(invalid, truncated));
+}
+
+TEST_SUITE_END();